@@ -5,10 +5,12 @@
  */
 
 #include "crypto_helper.h"
+#include "fm_crypto_backend.h"
 
 #include <zephyr/random/rand32.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
 
-#include "ocrypto_sha256.h"
 #include "ocrypto_constant_time.h"
 #include "ocrypto_sc_p224.h"
 #include "ocrypto_sc_p256.h"
@@ -109,68 +111,44 @@ int ansi_x963_kdf(uint8_t * const output,
 	/* Hash length is 32 bytes for each block */
 	const size_t digest_len = 32;
 
-	size_t counter = 1;
+	uint32_t counter = 1;
 	uint8_t counter_buf[4];
 
-	ocrypto_sha256_ctx hash_ctx;
+	/* Z || counter || SharedInfo */
+	const struct fm_crypto_iovec msg_iov[] = {
+		{ .data = key, .nbytes = key_len },
+		{ .data = counter_buf, .nbytes = sizeof(counter_buf) },
+		{ .data = shared_info, .nbytes = (shared_info != NULL) ? shared_info_len : 0 },
+	};
+
 	uint8_t digest[32];
+	int ret;
 
-	size_t remainder = output_len;
 	size_t pos = 0;
 
-	LOG_DBG("ansi_x963_kdf");
-
+	/* The key schedule runs this for every rotation, so it does not log. */
 	do {
-		LOG_DBG("loop %d", counter);
-
-		/* Initialize/reset the hash context */
-		ocrypto_sha256_init(&hash_ctx);
-
-		/* Begin by adding the input */
-		ocrypto_sha256_update(&hash_ctx, key, key_len);
-
-		LOG_HEXDUMP_DBG(key, key_len, "key");
+		size_t copy_len = MIN(output_len - pos, digest_len);
 
 		/* Add the counter value with big-endian representation */
-		counter_buf[3] = (uint8_t)(counter          & 0xff);
-		counter_buf[2] = (uint8_t)((counter >> 8)   & 0xff);
-		counter_buf[1] = (uint8_t)((counter >> 16)  & 0xff);
-		counter_buf[0] = (uint8_t)((counter >> 24)  & 0xff);
-
-		ocrypto_sha256_update(&hash_ctx, counter_buf, 4);
+		sys_put_be32(counter, counter_buf);
 
-		LOG_DBG("counter %d", counter);
-		LOG_HEXDUMP_DBG(counter_buf, 4, "");
-
-		/* Add shared info (if present, and has length) */
-		if (shared_info != NULL && shared_info_len > 0) {
-			ocrypto_sha256_update(&hash_ctx, shared_info, shared_info_len);
-
-			LOG_HEXDUMP_DBG(shared_info, shared_info_len, "shared_info");
+		ret = fm_crypto_backend.sha256_v(digest, msg_iov, ARRAY_SIZE(msg_iov));
+		if (ret) {
+			ocrypto_constant_time_fill_zero(digest, sizeof(digest));
+			return ret;
 		}
 
-		ocrypto_sha256_final(&hash_ctx, digest);
-
 		/* Copy a full "frame" or remainder */
-		if (remainder >= digest_len) {
-			LOG_HEXDUMP_DBG(digest, digest_len, "digest");
-
-			ocrypto_constant_time_copy(output + pos, digest, digest_len);
-			remainder -= 32;
-			pos += 32;
-		} else {
-			LOG_HEXDUMP_DBG(digest, remainder, "digest");
-
-			ocrypto_constant_time_copy(output + pos, digest, remainder);
-			remainder = 0;
-		}
+		ocrypto_constant_time_copy(output + pos, digest, copy_len);
 
-		LOG_DBG("remaining %d", remainder);
+		pos += copy_len;
 
 		/* Update counter for next iteration */
 		counter++;
+	} while (pos < output_len);
 
-	} while (remainder > 0);
+	ocrypto_constant_time_fill_zero(digest, sizeof(digest));
 
 	return 0;
 }
@@ -111,6 +111,40 @@ int fm_crypto_authenticate_with_ksn(const byte serverss[32],
                                     const byte *msg,
                                     byte out[32]);
 
+/*! @function fm_crypto_ksn_hmac_init
+ @abstract Derives the KSN and prepares the HMAC state for repeated
+           authentication with fm_crypto_authenticate_with_ksn_hmac.
+
+ @param ctx      KSN HMAC context.
+ @param serverss 32-byte ServerSharedSecret
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_ksn_hmac_init(fm_crypto_ksn_hmac_t ctx, const byte serverss[32]);
+
+/*! @function fm_crypto_ksn_hmac_free
+ @abstract Frees a given KSN HMAC context.
+
+ @param ctx KSN HMAC context.
+ */
+void fm_crypto_ksn_hmac_free(fm_crypto_ksn_hmac_t ctx);
+
+/*! @function fm_crypto_authenticate_with_ksn_hmac
+ @abstract Authenticates a given message using the KSN HMAC context prepared
+           with fm_crypto_ksn_hmac_init. The context is not modified.
+
+ @param ctx        KSN HMAC context.
+ @param msg_nbytes Byte length of message.
+ @param msg        Message.
+ @param out        32-byte output buffer for MAC.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_authenticate_with_ksn_hmac(const struct fm_crypto_ksn_hmac *ctx,
+					 word32 msg_nbytes,
+					 const byte *msg,
+					 byte out[32]);
+
 /*! @function fm_crypto_encrypt_to_server
  @abstract Encrypt a message to the Apple server.
 
@@ -129,6 +163,98 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 				word32 *out_nbytes,
 				byte *out);
 
+/*! @struct fm_crypto_iovec
+ @abstract Fragment of a message that is encrypted without being copied first.
+
+ @field data   Fragment data.
+ @field nbytes Byte length of the fragment.
+ */
+struct fm_crypto_iovec {
+	const byte *data;
+	word32 nbytes;
+};
+
+/*! @function fm_crypto_encrypt_to_server_v
+ @abstract Encrypt a message given as a list of fragments to the Apple server.
+
+ The result is the same as for fm_crypto_encrypt_to_server called with the
+ concatenation of the fragments. A fragment may be placed in the output buffer
+ at the position of its own ciphertext, that is, at 65 bytes plus its offset
+ in the message, to be encrypted in place.
+
+ @param pub        Apple server encryption key in X9.63 format.
+ @param msg_iov    Message fragments.
+ @param msg_iovcnt Number of message fragments.
+ @param out_nbytes Pointer to length of output buffer.
+                   (MUST be at least 65 + msg_nbytes + 16, where msg_nbytes
+                   is the total byte length of the fragments.)
+ @param out        Output buffer for ciphertext.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_encrypt_to_server_v(const byte pub[65],
+				  const struct fm_crypto_iovec *msg_iov,
+				  word32 msg_iovcnt,
+				  word32 *out_nbytes,
+				  byte *out);
+
+/*! @function fm_crypto_ephemeral_key_generate
+ @abstract Generates a P-256 ephemeral key pair for fm_crypto_encrypt_to_server_with_key.
+
+ @param key Ephemeral key context.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_ephemeral_key_generate(fm_crypto_ephemeral_key_t key);
+
+/*! @function fm_crypto_encrypt_to_server_with_key
+ @abstract Encrypt a message to the Apple server with a pre-generated ephemeral key.
+
+ The ephemeral key is consumed: it is zeroized before the function returns,
+ regardless of the result.
+
+ @param key        Ephemeral key generated with fm_crypto_ephemeral_key_generate.
+ @param pub        Apple server encryption key in X9.63 format.
+ @param msg_nbytes Byte length of message.
+ @param msg        Message to encrypt.
+ @param out_nbytes Pointer to length of output buffer.
+                   (MUST be at least 65 + msg_nbytes + 16.)
+ @param out        Output buffer for ciphertext.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_encrypt_to_server_with_key(fm_crypto_ephemeral_key_t key,
+					 const byte pub[65],
+					 word32 msg_nbytes,
+					 const byte *msg,
+					 word32 *out_nbytes,
+					 byte *out);
+
+/*! @function fm_crypto_encrypt_to_server_v_with_key
+ @abstract Encrypt a message given as a list of fragments to the Apple server
+           with a pre-generated ephemeral key.
+
+ Combines fm_crypto_encrypt_to_server_v and fm_crypto_encrypt_to_server_with_key.
+ The ephemeral key is zeroized before the function returns.
+
+ @param key        Ephemeral key generated with fm_crypto_ephemeral_key_generate.
+ @param pub        Apple server encryption key in X9.63 format.
+ @param msg_iov    Message fragments.
+ @param msg_iovcnt Number of message fragments.
+ @param out_nbytes Pointer to length of output buffer.
+                   (MUST be at least 65 + msg_nbytes + 16, where msg_nbytes
+                   is the total byte length of the fragments.)
+ @param out        Output buffer for ciphertext.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_encrypt_to_server_v_with_key(fm_crypto_ephemeral_key_t key,
+					   const byte pub[65],
+					   const struct fm_crypto_iovec *msg_iov,
+					   word32 msg_iovcnt,
+					   word32 *out_nbytes,
+					   byte *out);
+
 /*! @function fm_crypto_verify_s2
  @abstract Verifies signature S2 received from the server.
 
@@ -146,6 +272,61 @@ int fm_crypto_verify_s2(const byte pub[65],
 			word32 msg_nbytes,
 			const byte *msg);
 
+/*! @function fm_crypto_verify_s2_v
+ @abstract Verifies signature S2 received from the server over a message
+           given as a list of fragments.
+
+ @param pub        Apple server signature verification key in X9.63 format.
+ @param sig_nbytes Byte length of the signature.
+ @param sig        Signature over message.
+ @param msg_iov    Fragments of the message to verify.
+ @param msg_iovcnt Number of message fragments.
+
+ @return 0 if the signature is valid, a negative value otherwise.
+ */
+int fm_crypto_verify_s2_v(const byte pub[65],
+			  word32 sig_nbytes,
+			  const byte *sig,
+			  const struct fm_crypto_iovec *msg_iov,
+			  word32 msg_iovcnt);
+
+/*! @function fm_crypto_verify_s2_with_table
+ @abstract Verifies signature S2 received from the server with a precomputed
+           comb table of the server signature verification key.
+
+ @param pub_table  Comb table of the Apple server signature verification key.
+ @param sig_nbytes Byte length of the signature.
+ @param sig        Signature over message.
+ @param msg_nbytes Byte length of message to verify.
+ @param msg        Message to verify.
+
+ @return 0 if the signature is valid, a negative value otherwise.
+ */
+int fm_crypto_verify_s2_with_table(const fm_crypto_p256_comb_table *pub_table,
+				   word32 sig_nbytes,
+				   const byte *sig,
+				   word32 msg_nbytes,
+				   const byte *msg);
+
+/*! @function fm_crypto_verify_s2_with_table_v
+ @abstract Verifies signature S2 received from the server over a message
+           given as a list of fragments, with a precomputed comb table of the
+           server signature verification key.
+
+ @param pub_table  Comb table of the Apple server signature verification key.
+ @param sig_nbytes Byte length of the signature.
+ @param sig        Signature over message.
+ @param msg_iov    Fragments of the message to verify.
+ @param msg_iovcnt Number of message fragments.
+
+ @return 0 if the signature is valid, a negative value otherwise.
+ */
+int fm_crypto_verify_s2_with_table_v(const fm_crypto_p256_comb_table *pub_table,
+				     word32 sig_nbytes,
+				     const byte *sig,
+				     const struct fm_crypto_iovec *msg_iov,
+				     word32 msg_iovcnt);
+
 /*! @function fm_crypto_decrypt_e3
  @abstract Decrypts server message E3.
 
@@ -164,6 +345,24 @@ int fm_crypto_decrypt_e3(const byte serverss[32],
 			 word32 *out_nbytes,
 			 byte *out);
 
+/*! @function fm_crypto_decrypt_e3_in_place
+ @abstract Decrypts server message E3 within its own buffer.
+
+ On success, the plaintext starts at the beginning of the E3 buffer and
+ replaces the ciphertext. On error, the buffer without the tag is zeroized.
+
+ @param serverss  32-byte ServerSharedSecret
+ @param e3_nbytes Byte length of message E3.
+ @param e3        Message E3, overwritten with the plaintext.
+ @param pt_nbytes Pointer to the byte length of the plaintext, set on return.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_decrypt_e3_in_place(const byte serverss[32],
+				  word32 e3_nbytes,
+				  byte *e3,
+				  word32 *pt_nbytes);
+
 /*! @function fm_crypto_roll_sk
  @abstract Computes SK_i+1 from a given SK_i. SK can be SKN or SKS.
 
@@ -197,4 +396,107 @@ int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
 					    const byte p[57],
 					    byte out[28]);
 
+/*! @function fm_crypto_master_pk_import
+ @abstract Validates and imports the public key P for repeated key derivation.
+
+ @param ctx Master public key context.
+ @param p   57-byte public key P as generated at pairing.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_master_pk_import(fm_crypto_master_pk_t ctx, const byte p[57]);
+
+/*! @function fm_crypto_master_pk_free
+ @abstract Frees a given master public key context.
+
+ @param ctx Master public key context.
+ */
+void fm_crypto_master_pk_free(fm_crypto_master_pk_t ctx);
+
+/*! @function fm_crypto_derive_primary_or_secondary_x_from_master
+ @abstract Derives a primary key P_i or a secondary key PW_j using the
+           public key P imported with fm_crypto_master_pk_import.
+
+ @param sk  32-byte symmetric key SKN_i or SKS_j.
+ @param ctx Master public key context.
+ @param out 28-byte output buffer for x(P_i) or x(PW_j).
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_derive_primary_or_secondary_x_from_master(const byte sk[32],
+							 fm_crypto_master_pk_t ctx,
+							 byte out[28]);
+
+/*! @function fm_crypto_derive_primary_keys_batch
+ @abstract Rolls SKN and derives the primary keys for count consecutive indices.
+
+ Starting from SKN_i, the function computes SKN_i+1 ... SKN_i+count and the
+ matching x(P_i+1) ... x(P_i+count). The rolled keys are returned in sk_out so
+ that the caller does not have to roll them again. The public key P is imported once and the
+ affine conversion of the results shares a single field inversion per chunk of
+ FM_CRYPTO_P224_BATCH_MAX keys.
+
+ @param sk0   32-byte symmetric key SKN_i.
+ @param p     57-byte public key P as generated at pairing.
+ @param count Number of consecutive indices to derive.
+ @param out   count x 28-byte output buffer for x(P_i+1) ... x(P_i+count).
+ @param sk_out count x 32-byte output buffer for SKN_i+1 ... SKN_i+count,
+               or NULL if the rolled keys are not needed.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_derive_primary_keys_batch(const byte sk0[32],
+					const byte p[57],
+					word32 count,
+					byte out[][28],
+					byte sk_out[][32]);
+
+/*! @function fm_crypto_derive_primary_keys_batch_from_master
+ @abstract Same as fm_crypto_derive_primary_keys_batch, using the public key P
+           imported with fm_crypto_master_pk_import.
+
+ @param sk0   32-byte symmetric key SKN_i.
+ @param ctx   Master public key context.
+ @param count Number of consecutive indices to derive.
+ @param out   count x 28-byte output buffer for x(P_i+1) ... x(P_i+count).
+ @param sk_out count x 32-byte output buffer for SKN_i+1 ... SKN_i+count,
+               or NULL if the rolled keys are not needed.
+
+ @return 0 on success, a negative value on error.
+ */
+int fm_crypto_derive_primary_keys_batch_from_master(const byte sk0[32],
+						   fm_crypto_master_pk_t ctx,
+						   word32 count,
+						   byte out[][28],
+						   byte sk_out[][32]);
+
+/*! @function fm_crypto_scratch_size_get
+ @abstract Returns the size of one scratch arena that holds the temporaries
+           of the fm_crypto functions.
+
+ The size is computed at build time as the largest arena usage of all
+ fm_crypto call chains. Each thread that runs the fm_crypto functions claims
+ its own arena for the duration of the call.
+
+ @return Size of a scratch arena in bytes.
+ */
+word32 fm_crypto_scratch_size_get(void);
+
+/*! @function fm_crypto_scratch_hwm_get
+ @abstract Returns the highest usage of a scratch arena observed since boot.
+
+ Together with the thread stack usage, the value shows how much memory the
+ fm_crypto calls need on the calling threads.
+
+ @return High-water mark of the scratch arenas in bytes.
+ */
+word32 fm_crypto_scratch_hwm_get(void);
+
+/*! @function fm_crypto_scratch_hwm_reset
+ @abstract Resets the high-water mark of the scratch arenas to their current usage.
+
+ Used to measure the arena usage of a single fm_crypto call.
+ */
+void fm_crypto_scratch_hwm_reset(void);
+
 #endif /* FM_CRYPTO_H_ */
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fm_crypto_backend.h"
+
+const struct fm_crypto_backend fm_crypto_backend_oberon = {
+	.name = "oberon",
+	.sha256_v = fm_crypto_oberon_sha256_v,
+	.p224_twin_mult = fm_crypto_p224_twin_mult,
+	.p224_twin_mult_batch = fm_crypto_p224_twin_mult_batch,
+	.p256_ecdh = fm_crypto_oberon_p256_ecdh,
+	.p256_ecdsa_verify_hash = fm_crypto_oberon_p256_ecdsa_verify_hash,
+	.aes128gcm_encrypt_v = fm_crypto_oberon_aes128gcm_encrypt_v,
+	.aes128gcm_decrypt = fm_crypto_oberon_aes128gcm_decrypt,
+};
+
+#if defined(CONFIG_FMNA_CRYPTO_PSA)
+const struct fm_crypto_backend fm_crypto_backend_psa = {
+	.name = "psa",
+	.sha256_v = fm_crypto_psa_sha256_v,
+	.p256_ecdh = fm_crypto_psa_p256_ecdh,
+	.p256_ecdsa_verify_hash = fm_crypto_psa_p256_ecdsa_verify_hash,
+	.aes128gcm_encrypt_v = fm_crypto_psa_aes128gcm_encrypt_v,
+	.aes128gcm_decrypt = fm_crypto_psa_aes128gcm_decrypt,
+};
+#endif
+
+#if defined(CONFIG_FMNA_CRYPTO_SHA256_BACKEND_PSA)
+#define SHA256_V fm_crypto_psa_sha256_v
+#else
+#define SHA256_V fm_crypto_oberon_sha256_v
+#endif
+
+#if defined(CONFIG_FMNA_CRYPTO_P256_BACKEND_PSA)
+#define P256_ECDH fm_crypto_psa_p256_ecdh
+#define P256_ECDSA_VERIFY_HASH fm_crypto_psa_p256_ecdsa_verify_hash
+#else
+#define P256_ECDH fm_crypto_oberon_p256_ecdh
+#define P256_ECDSA_VERIFY_HASH fm_crypto_oberon_p256_ecdsa_verify_hash
+#endif
+
+#if defined(CONFIG_FMNA_CRYPTO_AES_GCM_BACKEND_PSA)
+#define AES128GCM_ENCRYPT_V fm_crypto_psa_aes128gcm_encrypt_v
+#define AES128GCM_DECRYPT fm_crypto_psa_aes128gcm_decrypt
+#else
+#define AES128GCM_ENCRYPT_V fm_crypto_oberon_aes128gcm_encrypt_v
+#define AES128GCM_DECRYPT fm_crypto_oberon_aes128gcm_decrypt
+#endif
+
+/* P-224 is only provided by the built-in implementation in fm_crypto_p224.c. */
+FM_CRYPTO_BACKEND_CONST struct fm_crypto_backend fm_crypto_backend = {
+	.name = "selected",
+	.sha256_v = SHA256_V,
+	.p224_twin_mult = fm_crypto_p224_twin_mult,
+	.p224_twin_mult_batch = fm_crypto_p224_twin_mult_batch,
+	.p256_ecdh = P256_ECDH,
+	.p256_ecdsa_verify_hash = P256_ECDSA_VERIFY_HASH,
+	.aes128gcm_encrypt_v = AES128GCM_ENCRYPT_V,
+	.aes128gcm_decrypt = AES128GCM_DECRYPT,
+};
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FM_CRYPTO_BACKEND_H_
+#define FM_CRYPTO_BACKEND_H_
+
+#include "fm_crypto.h"
+
+/**
+ * @brief Table of the cryptographic primitives used by the fm_crypto functions
+ *
+ * Each backend provides the primitives it implements and leaves the others
+ * set to NULL. The table used by fm_crypto is @ref fm_crypto_backend. It is
+ * composed at build time from the backend selected for each primitive.
+ */
+struct fm_crypto_backend {
+	/** Backend name. */
+	const char *name;
+
+	/**
+	 * @brief Compute the SHA-256 digest of a message given as a list of fragments
+	 *
+	 * @param[out]      out         32-byte digest.
+	 * @param[in]       msg_iov     Message fragments.
+	 * @param[in]       msg_iovcnt  Number of message fragments.
+	 *
+	 * @returns 0 on success, otherwise negative value.
+	 */
+	int (*sha256_v)(byte out[32],
+			const struct fm_crypto_iovec *msg_iov,
+			word32 msg_iovcnt);
+
+	/**
+	 * @brief Compute r = u * P + v * G on P-224
+	 *
+	 * See @ref fm_crypto_p224_twin_mult for the encoding of the arguments.
+	 */
+	int (*p224_twin_mult)(uint8_t r[56],
+			      const uint8_t u[28],
+			      const fm_crypto_p224_table *p_table,
+			      const uint8_t v[28]);
+
+	/**
+	 * @brief Compute r[i] = u[i] * P + v[i] * G on P-224 for a batch of scalar pairs
+	 *
+	 * See @ref fm_crypto_p224_twin_mult_batch for the encoding of the arguments.
+	 */
+	int (*p224_twin_mult_batch)(uint8_t r[][56],
+				    const uint8_t u[][28],
+				    const fm_crypto_p224_table *p_table,
+				    const uint8_t v[][28],
+				    size_t count);
+
+	/**
+	 * @brief Compute the P-256 ECDH shared secret
+	 *
+	 * @param[out]      secret      32-byte x coordinate of the shared point.
+	 * @param[in]       sk          32-byte private key (big-endian).
+	 * @param[in]       pk          Peer public key encoded as x || y (big-endian, 64 bytes).
+	 *
+	 * @returns 0 on success, otherwise negative value.
+	 */
+	int (*p256_ecdh)(byte secret[32], const byte sk[32], const byte pk[64]);
+
+	/**
+	 * @brief Verify an ECDSA P-256 signature over a SHA-256 hash
+	 *
+	 * @param[in]       sig         Signature encoded as r || s (big-endian, 64 bytes).
+	 * @param[in]       hash        32-byte SHA-256 hash of the signed message.
+	 * @param[in]       pk          Public key encoded as x || y (big-endian, 64 bytes).
+	 *
+	 * @returns 0 if the signature is valid, otherwise negative value.
+	 */
+	int (*p256_ecdsa_verify_hash)(const byte sig[64], const byte hash[32], const byte pk[64]);
+
+	/**
+	 * @brief Encrypt a message given as a list of fragments with AES-128-GCM
+	 *
+	 * A fragment may start at the address of its ciphertext in out, in which
+	 * case it is encrypted in place.
+	 *
+	 * @param[in]       key         128-bit AES key.
+	 * @param[in]       iv          128-bit IV.
+	 * @param[in]       msg_iov     Message fragments.
+	 * @param[in]       msg_iovcnt  Number of message fragments.
+	 * @param[out]      out         Ciphertext, as long as the message.
+	 * @param[out]      tag         128-bit authentication tag.
+	 *
+	 * @returns 0 on success, otherwise negative value.
+	 */
+	int (*aes128gcm_encrypt_v)(const byte key[16],
+				   const byte iv[16],
+				   const struct fm_crypto_iovec *msg_iov,
+				   word32 msg_iovcnt,
+				   byte *out,
+				   byte tag[16]);
+
+	/**
+	 * @brief Decrypt a ciphertext with AES-128-GCM
+	 *
+	 * The plaintext may start at the address of the ciphertext.
+	 *
+	 * @param[in]       key         128-bit AES key.
+	 * @param[in]       iv          128-bit IV.
+	 * @param[in]       ct_nbytes   Byte length of the ciphertext.
+	 * @param[in]       ct          Ciphertext.
+	 * @param[in]       tag         128-bit authentication tag.
+	 * @param[out]      out         Plaintext, as long as the ciphertext.
+	 *
+	 * @returns 0 if the tag is valid, otherwise negative value.
+	 */
+	int (*aes128gcm_decrypt)(const byte key[16],
+				 const byte iv[16],
+				 word32 ct_nbytes,
+				 const byte *ct,
+				 const byte tag[16],
+				 byte *out);
+};
+
+#if defined(CONFIG_FMNA_CRYPTO_BACKEND_RUNTIME)
+#define FM_CRYPTO_BACKEND_CONST
+#else
+#define FM_CRYPTO_BACKEND_CONST const
+#endif
+
+/** @brief Primitives selected for the fm_crypto functions. The table can only
+ *  be replaced at runtime with CONFIG_FMNA_CRYPTO_BACKEND_RUNTIME.
+ */
+extern FM_CRYPTO_BACKEND_CONST struct fm_crypto_backend fm_crypto_backend;
+
+/** @brief Primitives of the nrf_oberon backend, with the built-in P-224 multiplication. */
+extern const struct fm_crypto_backend fm_crypto_backend_oberon;
+
+int fm_crypto_oberon_sha256_v(byte out[32],
+			      const struct fm_crypto_iovec *msg_iov,
+			      word32 msg_iovcnt);
+int fm_crypto_oberon_p256_ecdh(byte secret[32], const byte sk[32], const byte pk[64]);
+int fm_crypto_oberon_p256_ecdsa_verify_hash(const byte sig[64],
+					    const byte hash[32],
+					    const byte pk[64]);
+int fm_crypto_oberon_aes128gcm_encrypt_v(const byte key[16],
+					 const byte iv[16],
+					 const struct fm_crypto_iovec *msg_iov,
+					 word32 msg_iovcnt,
+					 byte *out,
+					 byte tag[16]);
+int fm_crypto_oberon_aes128gcm_decrypt(const byte key[16],
+				       const byte iv[16],
+				       word32 ct_nbytes,
+				       const byte *ct,
+				       const byte tag[16],
+				       byte *out);
+
+#if defined(CONFIG_FMNA_CRYPTO_PSA)
+/** @brief Primitives of the PSA Crypto backend. P-224 is not provided. */
+extern const struct fm_crypto_backend fm_crypto_backend_psa;
+
+int fm_crypto_psa_sha256_v(byte out[32],
+			   const struct fm_crypto_iovec *msg_iov,
+			   word32 msg_iovcnt);
+int fm_crypto_psa_p256_ecdh(byte secret[32], const byte sk[32], const byte pk[64]);
+int fm_crypto_psa_p256_ecdsa_verify_hash(const byte sig[64],
+					 const byte hash[32],
+					 const byte pk[64]);
+int fm_crypto_psa_aes128gcm_encrypt_v(const byte key[16],
+				      const byte iv[16],
+				      const struct fm_crypto_iovec *msg_iov,
+				      word32 msg_iovcnt,
+				      byte *out,
+				      byte tag[16]);
+int fm_crypto_psa_aes128gcm_decrypt(const byte key[16],
+				    const byte iv[16],
+				    word32 ct_nbytes,
+				    const byte *ct,
+				    const byte tag[16],
+				    byte *out);
+#endif
+
+#endif /* FM_CRYPTO_BACKEND_H_ */
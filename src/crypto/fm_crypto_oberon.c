@@ -5,10 +5,16 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <string.h>
 
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
 #include "fm_crypto.h"
+#include "fm_crypto_backend.h"
 #include "crypto_helper.h"
+#include "fm_crypto_p224.h"
 
 #include <ocrypto_aes_gcm.h>
 #include <ocrypto_constant_time.h>
@@ -40,14 +46,313 @@ const byte KDF_LABEL_SNPROTECTION[] = "SerialNumberProtection";
 #define ASN1_TAG_INTEGER   0x02
 #define ASN1_TAG_SEQUENCE  0x30
 
+/*
+ * Scratch arenas
+ *
+ * Large temporaries are borrowed from static arenas instead of being placed
+ * on the caller stack. An arena works as a stack: nested calls borrow on top
+ * of their callers and release in the reverse order. Borrowed memory is
+ * zero-filled, and it is zeroized again when released.
+ *
+ * The outermost borrow of a thread claims a free arena, which stays with the
+ * thread until everything is released. Threads only wait for each other when
+ * all CONFIG_FMNA_CRYPTO_SCRATCH_ARENAS arenas are claimed. Each arena is
+ * guarded by a mutex, so a low priority background thread that holds an arena
+ * inherits the priority of the thread that waits for it.
+ */
+
+/* Temporaries of fm_crypto_ckg_gen_c3. */
+struct scratch_ckg_gen_c3 {
+	ecc_point s_marked;
+};
+
+/* Temporaries of fm_crypto_ckg_finish. */
+struct scratch_ckg_finish {
+	struct {
+		uint32_t skn[8];
+		uint32_t sks[8];
+	} sk_pair;
+	uint8_t pub_buf[56];
+	uint8_t shared_info_buf[64];
+};
+
+/* Temporaries of _fm_crypto_scmult_twin_reduce. */
+struct scratch_twin_reduce {
+	ocrypto_sc_p224 sc;
+	uint8_t s[28];
+	uint8_t t[28];
+	uint8_t r_raw[56];
+};
+
+/* Temporaries of fm_crypto_derive_primary_or_secondary_x_from_master. */
+struct scratch_derive_x {
+	ecc_point p_res;
+	struct {
+		uint32_t u[9];
+		uint32_t v[9];
+	} at;
+};
+
+/* Temporaries of fm_crypto_derive_primary_keys_batch_from_master. */
+struct scratch_derive_batch {
+	ocrypto_sc_p224 sc;
+	ocrypto_cp_p224 p_res;
+	uint8_t sk[32];
+	uint8_t s[FM_CRYPTO_P224_BATCH_MAX][28];
+	uint8_t t[FM_CRYPTO_P224_BATCH_MAX][28];
+	uint8_t r_raw[FM_CRYPTO_P224_BATCH_MAX][56];
+	struct {
+		uint32_t u[9];
+		uint32_t v[9];
+	} at;
+};
+
+/* Temporaries of the AES-128-GCM helpers. */
+struct scratch_aes_gcm {
+	ocrypto_aes_gcm_ctx ctx;
+	byte block[16];
+};
+
+/* Temporaries of fm_crypto_verify_s2_v and fm_crypto_verify_s2_with_table_v. */
+struct scratch_verify_s2 {
+	ecc_point pub_key;
+	uint8_t sig_raw[64];
+	uint8_t hash[32];
+};
+
+/* Temporaries of fm_crypto_encrypt_to_server_v_with_key. */
+struct scratch_encrypt {
+	ecc_point pub_key;
+	uint8_t common_secret[32];
+	struct {
+		uint32_t k[4];
+		uint32_t iv[4];
+	} k_iv;
+	uint8_t QP[2 * 65];
+};
+
+#define SCRATCH_ALIGN 8
+
+#define SCRATCH_SIZEOF(_type) ROUND_UP(sizeof(_type), SCRATCH_ALIGN)
+
+/* Arena usage of each function that borrows from the arena, including the
+ * nested calls. SHA-256 is also used by the KDF, so it nests in most of them.
+ */
+#define SCRATCH_FRAME_SHA256 SCRATCH_SIZEOF(ocrypto_sha256_ctx)
+#define SCRATCH_FRAME_AES_GCM SCRATCH_SIZEOF(struct scratch_aes_gcm)
+#define SCRATCH_FRAME_HMAC SCRATCH_SIZEOF(ocrypto_hmac_sha256_ctx)
+#define SCRATCH_FRAME_CKG_GEN_C3 SCRATCH_SIZEOF(struct scratch_ckg_gen_c3)
+#define SCRATCH_FRAME_CKG_FINISH				\
+	(SCRATCH_SIZEOF(struct scratch_ckg_finish) +		\
+	 SCRATCH_FRAME_SHA256)
+#define SCRATCH_FRAME_TWIN_REDUCE SCRATCH_SIZEOF(struct scratch_twin_reduce)
+#define SCRATCH_FRAME_DERIVE_X_FROM_MASTER			\
+	(SCRATCH_SIZEOF(struct scratch_derive_x) +		\
+	 MAX(SCRATCH_FRAME_SHA256, SCRATCH_FRAME_TWIN_REDUCE))
+#define SCRATCH_FRAME_DERIVE_BATCH_FROM_MASTER			\
+	(SCRATCH_SIZEOF(struct scratch_derive_batch) +		\
+	 SCRATCH_FRAME_SHA256)
+#define SCRATCH_FRAME_DECRYPT					\
+	MAX(SCRATCH_FRAME_SHA256, SCRATCH_FRAME_AES_GCM)
+#define SCRATCH_FRAME_VERIFY					\
+	(SCRATCH_SIZEOF(struct scratch_verify_s2) +		\
+	 SCRATCH_FRAME_SHA256)
+#define SCRATCH_FRAME_AUTHENTICATE				\
+	(SCRATCH_SIZEOF(struct fm_crypto_ksn_hmac) +		\
+	 MAX(SCRATCH_FRAME_SHA256, SCRATCH_FRAME_HMAC))
+#define SCRATCH_FRAME_ENCRYPT_WITH_KEY				\
+	(SCRATCH_SIZEOF(struct scratch_encrypt) +		\
+	 MAX(SCRATCH_FRAME_SHA256, SCRATCH_FRAME_AES_GCM))
+#define SCRATCH_FRAME_ENCRYPT					\
+	(SCRATCH_SIZEOF(struct fm_crypto_ephemeral_key) +	\
+	 SCRATCH_FRAME_ENCRYPT_WITH_KEY)
+
+/* Largest arena usage of all public call chains. */
+#define SCRATCH_SIZE							\
+	MAX(MAX(MAX(SCRATCH_FRAME_CKG_GEN_C3, SCRATCH_FRAME_CKG_FINISH),	\
+		MAX(SCRATCH_FRAME_DERIVE_X_FROM_MASTER,			\
+		    SCRATCH_FRAME_DERIVE_BATCH_FROM_MASTER)),		\
+	    MAX(MAX(SCRATCH_FRAME_DECRYPT, SCRATCH_FRAME_VERIFY),		\
+		MAX(SCRATCH_FRAME_AUTHENTICATE, SCRATCH_FRAME_ENCRYPT)))
+
+struct scratch_arena {
+	uint8_t buf[SCRATCH_SIZE] __aligned(SCRATCH_ALIGN);
+	size_t used;
+	k_tid_t owner;
+	struct k_mutex mutex;
+};
+
+static struct scratch_arena scratch_arenas[CONFIG_FMNA_CRYPTO_SCRATCH_ARENAS];
+static size_t scratch_hwm;
+static struct k_spinlock scratch_lock;
+
+static int scratch_init(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(scratch_arenas); i++) {
+		k_mutex_init(&scratch_arenas[i].mutex);
+	}
+
+	return 0;
+}
+
+SYS_INIT(scratch_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+/* Arena claimed by the current thread, if any. */
+static struct scratch_arena *scratch_arena_find(k_tid_t owner)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(scratch_arenas); i++) {
+		if (scratch_arenas[i].owner == owner) {
+			return &scratch_arenas[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Claim a free arena or wait for the one held by the lowest priority thread,
+ * which is the one that benefits the most from the priority inheritance.
+ */
+static struct scratch_arena *scratch_arena_claim(void)
+{
+	k_spinlock_key_t key;
+	struct scratch_arena *arena = NULL;
+	int prio_max = INT_MIN;
+
+	for (size_t i = 0; i < ARRAY_SIZE(scratch_arenas); i++) {
+		if (!k_mutex_lock(&scratch_arenas[i].mutex, K_NO_WAIT)) {
+			return &scratch_arenas[i];
+		}
+	}
+
+	key = k_spin_lock(&scratch_lock);
+	for (size_t i = 0; i < ARRAY_SIZE(scratch_arenas); i++) {
+		k_tid_t owner = scratch_arenas[i].owner;
+		int prio = owner ? k_thread_priority_get(owner) : INT_MAX;
+
+		if (prio > prio_max) {
+			prio_max = prio;
+			arena = &scratch_arenas[i];
+		}
+	}
+	k_spin_unlock(&scratch_lock, key);
+
+	k_mutex_lock(&arena->mutex, K_FOREVER);
+
+	return arena;
+}
+
+static void *scratch_alloc(size_t nbytes)
+{
+	void *ptr;
+	k_spinlock_key_t key;
+	struct scratch_arena *arena;
+	k_tid_t thread = k_current_get();
+
+	key = k_spin_lock(&scratch_lock);
+	arena = scratch_arena_find(thread);
+	k_spin_unlock(&scratch_lock, key);
+
+	if (!arena) {
+		/* Outermost borrow of the thread: claim a free arena. */
+		arena = scratch_arena_claim();
+
+		key = k_spin_lock(&scratch_lock);
+		__ASSERT_NO_MSG(!arena->owner && !arena->used);
+		arena->owner = thread;
+		k_spin_unlock(&scratch_lock, key);
+	}
+
+	/* The frame sizes are checked at build time in SCRATCH_ALLOC. */
+	__ASSERT(nbytes <= sizeof(arena->buf) - arena->used,
+		 "Scratch arena overflow: %zu + %zu > %zu", arena->used, nbytes,
+		 sizeof(arena->buf));
+
+	ptr = &arena->buf[arena->used];
+	arena->used += nbytes;
+
+	key = k_spin_lock(&scratch_lock);
+	scratch_hwm = MAX(scratch_hwm, arena->used);
+	k_spin_unlock(&scratch_lock, key);
+
+	return ptr;
+}
+
+static void scratch_free(void *ptr, size_t nbytes)
+{
+	k_spinlock_key_t key;
+	struct scratch_arena *arena;
+
+	key = k_spin_lock(&scratch_lock);
+	arena = scratch_arena_find(k_current_get());
+	k_spin_unlock(&scratch_lock, key);
+
+	__ASSERT(arena && ((uint8_t *) ptr + nbytes == &arena->buf[arena->used]),
+		 "Scratch arena released out of order");
+
+	ocrypto_constant_time_fill_zero(ptr, nbytes);
+	arena->used -= nbytes;
+
+	if (arena->used == 0) {
+		key = k_spin_lock(&scratch_lock);
+		arena->owner = NULL;
+		k_spin_unlock(&scratch_lock, key);
+
+		k_mutex_unlock(&arena->mutex);
+	}
+}
+
+/* Borrow the temporaries of a function whose arena usage, nested calls
+ * included, is _frame. The build fails if the temporaries do not fit in the
+ * frame or if the frame does not fit in the arena.
+ */
+#define SCRATCH_ALLOC(_type, _frame) ({						\
+	BUILD_ASSERT(SCRATCH_SIZEOF(_type) <= (_frame),				\
+		     "Scratch temporaries do not fit in the frame");		\
+	BUILD_ASSERT((_frame) <= SCRATCH_SIZE,					\
+		     "Scratch frame does not fit in the arena");		\
+	(_type *) scratch_alloc(SCRATCH_SIZEOF(_type));				\
+})
+#define SCRATCH_FREE(_ptr) scratch_free((_ptr), SCRATCH_SIZEOF(*(_ptr)))
+
+word32 fm_crypto_scratch_size_get(void)
+{
+	return SCRATCH_SIZE;
+}
+
+word32 fm_crypto_scratch_hwm_get(void)
+{
+	word32 hwm;
+	k_spinlock_key_t key = k_spin_lock(&scratch_lock);
+
+	hwm = scratch_hwm;
+	k_spin_unlock(&scratch_lock, key);
+
+	return hwm;
+}
+
+void fm_crypto_scratch_hwm_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&scratch_lock);
+
+	scratch_hwm = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(scratch_arenas); i++) {
+		scratch_hwm = MAX(scratch_hwm, scratch_arenas[i].used);
+	}
+	k_spin_unlock(&scratch_lock, key);
+}
+
 int fm_crypto_sha256(word32 msg_nbytes, const byte *msg, byte out[32])
 {
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_nbytes,
+	};
+
 	if(msg == NULL && msg_nbytes > 0) {
 		return -1;
 	}
 
-	ocrypto_sha256(out, msg, msg_nbytes);
-	return 0;
+	return fm_crypto_backend.sha256_v(out, &msg_iov, 1);
 }
 
 int fm_crypto_ckg_init(fm_crypto_ckg_context_t ctx)
@@ -102,7 +407,10 @@ void fm_crypto_ckg_free(fm_crypto_ckg_context_t ctx)
 
 int fm_crypto_ckg_gen_c1(fm_crypto_ckg_context_t ctx, byte out[32])
 {
-    ocrypto_sha256_ctx hash_ctx = {0};
+    const struct fm_crypto_iovec msg_iov[] = {
+        { .data = ctx->key.private_key.buffer, .nbytes = 28 },
+        { .data = ctx->r1, .nbytes = 32 },
+    };
 
     /**
      * 1. The accessory generates a P-224 scalar s (see Random scalar generation) and a 32-byte random
@@ -111,7 +419,6 @@ int fm_crypto_ckg_gen_c1(fm_crypto_ckg_context_t ctx, byte out[32])
      */
 
     /* C1 = SHA-256(s || r) */
-    ocrypto_sha256_init(&hash_ctx);
 
     /*
      * OpenSSL: BN_bn2bin() + EC_KEY_get0_private_key()
@@ -119,17 +426,9 @@ int fm_crypto_ckg_gen_c1(fm_crypto_ckg_context_t ctx, byte out[32])
      */
     /*
      * OpenSSL: SHA256()
-     * nrf_oberon: Calculate digest incrementally (s || r)
+     * nrf_oberon: Calculate digest over the fragments (s || r), r equal to r1
      */
-    ocrypto_sha256_update(&hash_ctx, ctx->key.private_key.buffer, 28);
-
-    /* r equal to r1 */
-    ocrypto_sha256_update(&hash_ctx, ctx->r1, 32);
-
-    /* Write digest into out */
-    ocrypto_sha256_final(&hash_ctx, out);
-
-    return FMN_ERROR_CRYPTO_OK;
+    return fm_crypto_backend.sha256_v(out, msg_iov, ARRAY_SIZE(msg_iov));
 }
 
 /*! @function _fm_crypto_points_add
@@ -191,7 +490,8 @@ int fm_crypto_ckg_gen_c3(fm_crypto_ckg_context_t ctx,
 	 */
 
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ecc_point S_marked = {0};
+	struct scratch_ckg_gen_c3 *scr =
+		SCRATCH_ALLOC(struct scratch_ckg_gen_c3, SCRATCH_FRAME_CKG_GEN_C3);
 
 	/*
 	* OpenSSL: EC_KEY_new_by_curve_name(NID_secp224r1)
@@ -215,7 +515,7 @@ int fm_crypto_ckg_gen_c3(fm_crypto_ckg_context_t ctx,
 	* nrf_oberon: Validation done in ocrypto_curve_p224_from56bytes
 	*/
 	/* Import point and check that it is valid */
-	ret = ocrypto_curve_p224_from56bytes(&S_marked.point_p224, c2 + 1);
+	ret = ocrypto_curve_p224_from56bytes(&scr->s_marked.point_p224, c2 + 1);
 	CHECK_RV_GOTO(ret, error);
 
 	/*
@@ -224,7 +524,7 @@ int fm_crypto_ckg_gen_c3(fm_crypto_ckg_context_t ctx,
 	* OpenSSL: EC_POINT_add()
 	*/
 	ret = _fm_crypto_points_add(&ctx->p,
-				&S_marked,
+				&scr->s_marked,
 				&ctx->key.public_key,
 				ECC_TYPE_P224);
 	CHECK_RV_GOTO(ret, error);
@@ -243,10 +543,9 @@ int fm_crypto_ckg_gen_c3(fm_crypto_ckg_context_t ctx,
 	/* Copy r' from C2 into ctx->r2 */
 	ocrypto_constant_time_copy(ctx->r2, c2 + 57, sizeof(ctx->r2));
 
-	return ret;
-
 error:
-	ocrypto_constant_time_fill_zero(&S_marked, sizeof(ecc_point));
+	/* S' is zeroized on release */
+	SCRATCH_FREE(scr);
 	return ret;
 }
 
@@ -256,14 +555,8 @@ int fm_crypto_ckg_finish(fm_crypto_ckg_context_t ctx,
 			 byte sks[32])
 {
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	struct {
-		uint32_t skn[8];
-		uint32_t sks[8];
-	} sk_pair = {0};
-
-	uint8_t pub_buf[56] = {0};
-
-	uint8_t shared_info_buf[64] = {0};
+	struct scratch_ckg_finish *scr =
+		SCRATCH_ALLOC(struct scratch_ckg_finish, SCRATCH_FRAME_CKG_FINISH);
 
 	/*
 	* OpenSSL: BN_bn2bin() + EC_POINT_get_affine_coordinates_GFp()
@@ -271,11 +564,11 @@ int fm_crypto_ckg_finish(fm_crypto_ckg_context_t ctx,
 	*/
 
 	/* The public key is equal, ready to use */
-	ocrypto_constant_time_copy(shared_info_buf, ctx->r1, 32);
-	ocrypto_constant_time_copy(shared_info_buf + 32, ctx->r2, 32);
+	ocrypto_constant_time_copy(scr->shared_info_buf, ctx->r1, 32);
+	ocrypto_constant_time_copy(scr->shared_info_buf + 32, ctx->r2, 32);
 
 	/* Copy out P (x and y) */
-	ocrypto_curve_p224_to56bytes(pub_buf, &ctx->p.point_p224);
+	ocrypto_curve_p224_to56bytes(scr->pub_buf, &ctx->p.point_p224);
 
 	/*
 	* OpenSSL: Custom X9.63 KDF implementation using SHA256()
@@ -286,13 +579,13 @@ int fm_crypto_ckg_finish(fm_crypto_ckg_context_t ctx,
 	 *    where SKN is the first 32 bytes and SKS is the last 32 bytes
 	 */
 	ret = ansi_x963_kdf(
-		(uint8_t*) &sk_pair, 64,    /* SKN || SKS (derived keys) */
-		pub_buf, 28,                /* x(P) (secret/Z) */
-		shared_info_buf, 64);       /* r || r' (sharedinfo) */
+		(uint8_t*) &scr->sk_pair, 64, /* SKN || SKS (derived keys) */
+		scr->pub_buf, 28,             /* x(P) (secret/Z) */
+		scr->shared_info_buf, 64);    /* r || r' (sharedinfo) */
 	CHECK_RV_GOTO(ret, error);
 
-	ocrypto_constant_time_copy(skn, sk_pair.skn, 32);
-	ocrypto_constant_time_copy(sks, sk_pair.sks, 32);
+	ocrypto_constant_time_copy(skn, scr->sk_pair.skn, 32);
+	ocrypto_constant_time_copy(sks, scr->sk_pair.sks, 32);
 
 	/*
 	* Write uncompressed point in ANSI X9.62 format.
@@ -303,13 +596,15 @@ int fm_crypto_ckg_finish(fm_crypto_ckg_context_t ctx,
 	/* Set uncompressed point tag */
 	p[0] = 0x04;
 	/* Copy the public key into p (big endian) */
-	ocrypto_constant_time_copy(p + 1, pub_buf, 56);
+	ocrypto_constant_time_copy(p + 1, scr->pub_buf, 56);
+
+	SCRATCH_FREE(scr);
 
 	return 0;
 
 error:
 	ocrypto_constant_time_fill_zero(p, 57);
-	ocrypto_constant_time_fill_zero(&sk_pair, sizeof(sk_pair));
+	SCRATCH_FREE(scr);
 	return ret;
 }
 
@@ -372,129 +667,59 @@ error:
 	return ret;
 }
 
-/*! @function _fm_crypto_scmult
- @abstract Scalar multiplication on an elliptic curve.
-
- @param r  Resulting EC point r = s * B.
- @param s  Scalar s.
- @param B  Base point B.
- @param dp Curve parameters.
-
- @return 0 on success, a negative value on error.
- */
-static int _fm_crypto_scmult(ecc_point *r,
-			     mp_int *s,
-			     ecc_point *B,
-			     ecc_set_type dp)
-{
-	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-
-	switch (dp) {
-	case ECC_TYPE_P224:
-		ret = ocrypto_curve_p224_scalarmult(
-			&r->point_p224,
-			&B->point_p224,
-			&s->private_key.scalar_p224);
-		break;
-
-	case ECC_TYPE_P224_BASE:
-		ret = ocrypto_curve_p224_scalarmult_base(
-			&r->point_p224,
-			&s->private_key.scalar_p224);
-		break;
-
-	case ECC_TYPE_NONE:
-	default:
-		ret = -1;
-	}
-
-	return ret;
-}
-
-/*! @function _fm_crypto_scmult_reduce
- @abstract Takes a 36-byte value uv, reduces it to a valid scalar s,
-           and computes r = s * B.
-
- @param r  Resulting EC point r = (uv (mod q-1) + 1) * B.
- @param uv 36-byte pre-scalar value.
- @param B  Base point B.
- @param dp Curve parameters.
-
- @return 0 on success, a negative value on error.
- */
-static int _fm_crypto_scmult_reduce(ecc_point *r,
-				    const byte uv[36],
-				    ecc_point *B,
-				    ecc_set_type dp)
-{
-	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ecc_key ecc_key = {0};
-
-	/* Reduce
-	 * s = u (mod q-1) + 1\
-	 */
-	ocrypto_sc_p224_from36bytes(&ecc_key.private_key.scalar_p224, uv);
-
-	/* Scalar multiply */
-	ret = _fm_crypto_scmult(r, (mp_int *)&ecc_key, B, dp);
-	CHECK_RV_GOTO(ret, error);
-
-	return 0;
-
-error:
-	ocrypto_constant_time_fill_zero(r, sizeof(ecc_point));
-	return ret;
-}
-
 /*! @function _fm_crypto_scmult_twin_reduce
  @abstract Takes two 36-byte values u and v, reduces them to valid scalars s
-           and t, a and computes r = s * P + t * G.
+           and t, and computes r = s * P + t * G in a single joint ladder.
 
- @param r  Resulting EC point r = (u (mod q-1) + 1) * P + (v (mod q-1) + 1) * G.
- @param u  36-byte pre-scalar value.
- @param v  36-byte pre-scalar value.
- @param P  EC point P.
+ @param r       Resulting EC point r = (u (mod q-1) + 1) * P + (v (mod q-1) + 1) * G.
+ @param u       36-byte pre-scalar value.
+ @param v       36-byte pre-scalar value.
+ @param p_table Window table of EC point P.
 
  @return 0 on success, a negative value on error.
  */
 static int _fm_crypto_scmult_twin_reduce(ecc_point *r,
 					 const byte u[36],
 					 const byte v[36],
-					 ecc_point *P)
+					 const fm_crypto_p224_table *p_table)
 {
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ecc_point r1 = {0};
-	ecc_point r2 = {0};
+	struct scratch_twin_reduce *scr =
+		SCRATCH_ALLOC(struct scratch_twin_reduce, SCRATCH_FRAME_TWIN_REDUCE);
 
-	/* r1 = (u (mod q-1) + 1) * P */
-	ret = _fm_crypto_scmult_reduce(&r1, u, P, ECC_TYPE_P224);
-	CHECK_RV_GOTO(ret, error);
+	/* Reduce
+	 * s = u (mod q-1) + 1
+	 * t = v (mod q-1) + 1
+	 */
+	ocrypto_sc_p224_from36bytes(&scr->sc, u);
+	ocrypto_sc_p224_to28bytes(scr->s, &scr->sc);
 
-	/* r2 = (v (mod q-1) + 1) * G */
-	ret = _fm_crypto_scmult_reduce(&r2, v, NULL, ECC_TYPE_P224_BASE);
+	ocrypto_sc_p224_from36bytes(&scr->sc, v);
+	ocrypto_sc_p224_to28bytes(scr->t, &scr->sc);
+
+	/*
+	* OpenSSL: EC_POINT_mul()
+	* nrf_oberon: No multi-scalar API, interleaved ladder in fm_crypto_p224
+	*/
+	ret = fm_crypto_backend.p224_twin_mult(scr->r_raw, scr->s, p_table, scr->t);
 	CHECK_RV_GOTO(ret, error);
 
-	/* r = r1 + r2 */
-	ret = _fm_crypto_points_add(r, &r1, &r2, ECC_TYPE_P224);
+	/* Import the result and check that it is valid */
+	ret = ocrypto_curve_p224_from56bytes(&r->point_p224, scr->r_raw);
 	CHECK_RV_GOTO(ret, error);
 
-	return 0;
+	r->buffer[0] = 0x04;
+	ocrypto_constant_time_copy(r->buffer + 1, scr->r_raw, sizeof(scr->r_raw));
 
 error:
+	/* The reduced scalars are zeroized on release */
+	SCRATCH_FREE(scr);
 	return ret;
 }
 
-int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
-					    const byte p[57],
-					    byte out[28])
+int fm_crypto_master_pk_import(fm_crypto_master_pk_t ctx, const byte p[57])
 {
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ecc_point p_res = {0};
-	ecc_point p_int = {0};
-	struct {
-		uint32_t u[9];
-		uint32_t v[9];
-	} at = {0};
 
 	/**
 	 * Copy from spec
@@ -521,10 +746,39 @@ int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
 	* OpenSSL: EC_POINT_is_on_curve()
 	* nrf_oberon: Validation done in ocrypto_curve_p224_from56bytes
 	*/
-	/* Import public key and check that it is valid */
-	ret = ocrypto_curve_p224_from56bytes(&p_int.point_p224, p + 1);
+	/* Import public key and check that it is valid. P stays constant
+	 * for the whole paired lifetime, so the decoded point is kept in
+	 * the context and reused for every key derivation.
+	 */
+	ret = ocrypto_curve_p224_from56bytes(&ctx->p.point_p224, p + 1);
 	CHECK_RV_GOTO(ret, error);
 
+	ctx->p.buffer[0] = 0x04;
+	ocrypto_constant_time_copy(ctx->p.buffer + 1, p + 1, 56);
+
+	/* Precompute the multiples of P used by the joint u * P + v * G ladder. */
+	fm_crypto_p224_table_init(&ctx->p_table, p + 1);
+
+	return 0;
+
+error:
+	ocrypto_constant_time_fill_zero(ctx, sizeof(*ctx));
+	return ret;
+}
+
+void fm_crypto_master_pk_free(fm_crypto_master_pk_t ctx)
+{
+	ocrypto_constant_time_fill_zero(ctx, sizeof(*ctx));
+}
+
+int fm_crypto_derive_primary_or_secondary_x_from_master(const byte sk[32],
+							 fm_crypto_master_pk_t ctx,
+							 byte out[28])
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	struct scratch_derive_x *scr =
+		SCRATCH_ALLOC(struct scratch_derive_x, SCRATCH_FRAME_DERIVE_X_FROM_MASTER);
+
 	/*
 	* OpenSSL: Custom X9.63 KDF implementation using SHA256()
 	*/
@@ -536,7 +790,7 @@ int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
 	 *    len(u i) = len(v i) = 36 bytes.
 	 */
 	ret = ansi_x963_kdf(
-		(uint8_t*) &at, sizeof(at), /* Generated derived key {u,v} */
+		(uint8_t*) &scr->at, sizeof(scr->at), /* Generated derived key {u,v} */
 		sk, 32, /* Secret */
 		KDF_LABEL_DIVERSIFY, /* SharedInfo */
 		STR_ARRAY_SIZE(KDF_LABEL_DIVERSIFY));
@@ -549,10 +803,10 @@ int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
 	 *    b. v i = v i (mod q-1) + 1
 	 * 4. Compute P i = u i ⋅ P + v i ⋅ G.
 	 */
-	ret = _fm_crypto_scmult_twin_reduce(&p_res,
-					(uint8_t*) at.u,
-					(uint8_t*) at.v,
-					&p_int);
+	ret = _fm_crypto_scmult_twin_reduce(&scr->p_res,
+					(uint8_t*) scr->at.u,
+					(uint8_t*) scr->at.v,
+					&ctx->p_table);
 	CHECK_RV_GOTO(ret, error);
 
 	/*
@@ -560,14 +814,161 @@ int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
 	* nrf_oberon: p_res already in raw format, just copy the x
 	*/
 	/* Copy x(P i) out */
-	ocrypto_curve_p224_to28bytes(out, &p_res.point_p224);
+	ocrypto_curve_p224_to28bytes(out, &scr->p_res.point_p224);
+
+	SCRATCH_FREE(scr);
 
 	return 0;
 
 error:
-	ocrypto_constant_time_fill_zero(&at, sizeof(at));
-	ocrypto_constant_time_fill_zero(&p_int, sizeof(p_int));
 	ocrypto_constant_time_fill_zero(out, 28);
+	SCRATCH_FREE(scr);
+	return ret;
+}
+
+/* Master public key context of the one-shot derivations that take P in its encoded
+ * form. Its window table is too large for the scratch arenas, and the FMN keys
+ * module keeps its own imported context, so the one-shot calls share a single one.
+ */
+static struct fm_crypto_master_pk oneshot_master_pk;
+static K_MUTEX_DEFINE(oneshot_master_pk_mutex);
+
+int fm_crypto_derive_primary_or_secondary_x(const byte sk[32],
+					    const byte p[57],
+					    byte out[28])
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+
+	k_mutex_lock(&oneshot_master_pk_mutex, K_FOREVER);
+
+	ret = fm_crypto_master_pk_import(&oneshot_master_pk, p);
+	CHECK_RV_GOTO(ret, error);
+
+	ret = fm_crypto_derive_primary_or_secondary_x_from_master(sk, &oneshot_master_pk, out);
+	CHECK_RV_GOTO(ret, error);
+
+	fm_crypto_master_pk_free(&oneshot_master_pk);
+	k_mutex_unlock(&oneshot_master_pk_mutex);
+
+	return 0;
+
+error:
+	fm_crypto_master_pk_free(&oneshot_master_pk);
+	k_mutex_unlock(&oneshot_master_pk_mutex);
+	ocrypto_constant_time_fill_zero(out, 28);
+	return ret;
+}
+
+int fm_crypto_derive_primary_keys_batch_from_master(const byte sk0[32],
+						   fm_crypto_master_pk_t ctx,
+						   word32 count,
+						   byte out[][28],
+						   byte sk_out[][32])
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	struct scratch_derive_batch *scr =
+		SCRATCH_ALLOC(struct scratch_derive_batch, SCRATCH_FRAME_DERIVE_BATCH_FROM_MASTER);
+	word32 done = 0;
+	word32 n;
+
+	ocrypto_constant_time_copy(scr->sk, sk0, sizeof(scr->sk));
+
+	while (done < count) {
+		n = count - done;
+		if (n > FM_CRYPTO_P224_BATCH_MAX) {
+			n = FM_CRYPTO_P224_BATCH_MAX;
+		}
+
+		for (word32 i = 0; i < n; i++) {
+			/* SKN i-1 -> SKN i */
+			ret = ansi_x963_kdf(
+				scr->sk, sizeof(scr->sk),
+				scr->sk, sizeof(scr->sk),
+				KDF_LABEL_UPDATE,
+				STR_ARRAY_SIZE(KDF_LABEL_UPDATE));
+			CHECK_RV_GOTO(ret, error);
+
+			if (sk_out) {
+				ocrypto_constant_time_copy(sk_out[done + i], scr->sk,
+							   sizeof(scr->sk));
+			}
+
+			/* SKN i -> AT i = (u i, v i) */
+			ret = ansi_x963_kdf(
+				(uint8_t*) &scr->at, sizeof(scr->at),
+				scr->sk, sizeof(scr->sk),
+				KDF_LABEL_DIVERSIFY,
+				STR_ARRAY_SIZE(KDF_LABEL_DIVERSIFY));
+			CHECK_RV_GOTO(ret, error);
+
+			/* u i = u i (mod q-1) + 1, v i = v i (mod q-1) + 1 */
+			ocrypto_sc_p224_from36bytes(&scr->sc, (uint8_t*) scr->at.u);
+			ocrypto_sc_p224_to28bytes(scr->s[i], &scr->sc);
+
+			ocrypto_sc_p224_from36bytes(&scr->sc, (uint8_t*) scr->at.v);
+			ocrypto_sc_p224_to28bytes(scr->t[i], &scr->sc);
+		}
+
+		/* P i = u i * P + v i * G, sharing one inversion for the whole chunk */
+		ret = fm_crypto_backend.p224_twin_mult_batch(scr->r_raw, scr->s, &ctx->p_table,
+							     scr->t, n);
+		CHECK_RV_GOTO(ret, error);
+
+		for (word32 i = 0; i < n; i++) {
+			/* Check that the result is valid */
+			ret = ocrypto_curve_p224_from56bytes(&scr->p_res, scr->r_raw[i]);
+			CHECK_RV_GOTO(ret, error);
+
+			/* Copy x(P i) out */
+			ocrypto_curve_p224_to28bytes(out[done + i], &scr->p_res);
+		}
+
+		done += n;
+	}
+
+	ret = 0;
+	goto cleanup;
+
+error:
+	ocrypto_constant_time_fill_zero(out, count * 28);
+	if (sk_out) {
+		ocrypto_constant_time_fill_zero(sk_out, count * 32);
+	}
+
+cleanup:
+	SCRATCH_FREE(scr);
+	return ret;
+}
+
+int fm_crypto_derive_primary_keys_batch(const byte sk0[32],
+					const byte p[57],
+					word32 count,
+					byte out[][28],
+					byte sk_out[][32])
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+
+	k_mutex_lock(&oneshot_master_pk_mutex, K_FOREVER);
+
+	ret = fm_crypto_master_pk_import(&oneshot_master_pk, p);
+	CHECK_RV_GOTO(ret, error);
+
+	ret = fm_crypto_derive_primary_keys_batch_from_master(sk0, &oneshot_master_pk, count, out,
+							      sk_out);
+	CHECK_RV_GOTO(ret, error);
+
+	fm_crypto_master_pk_free(&oneshot_master_pk);
+	k_mutex_unlock(&oneshot_master_pk_mutex);
+
+	return 0;
+
+error:
+	fm_crypto_master_pk_free(&oneshot_master_pk);
+	k_mutex_unlock(&oneshot_master_pk_mutex);
+	ocrypto_constant_time_fill_zero(out, count * 28);
+	if (sk_out) {
+		ocrypto_constant_time_fill_zero(sk_out, count * 32);
+	}
 	return ret;
 }
 
@@ -603,28 +1004,36 @@ error:
 	return ret;
 }
 
-/*! @function _fm_crypto_aes128gcm_encrypt
- @abstract Encrypts a message using AES-128-GCM.
+/*! @function fm_crypto_oberon_aes128gcm_encrypt_v
+ @abstract Encrypts a message given as a list of fragments using AES-128-GCM.
+
+ The fragments are processed in order, as if they were one contiguous message.
+ A fragment may be located in the output buffer at the exact position of its
+ own ciphertext, in which case it is encrypted in place.
 
- @param key        128-bit AES key.
- @param iv         128-bit IV.
- @param msg_nbytes Byte length of message.
- @param msg        Message.
- @param out        Output buffer for the ciphertext.
- @param tag        Output buffer for the 128-bit authentication tag.
+ @param key       128-bit AES key.
+ @param iv        128-bit IV.
+ @param msg_iov   Message fragments.
+ @param msg_iovcnt Number of message fragments.
+ @param out       Output buffer for the ciphertext.
+ @param tag       Output buffer for the 128-bit authentication tag.
 
  @return 0 on success, a negative value on error.
  */
-static int _fm_crypto_aes128gcm_encrypt(const byte key[16],
-					const byte iv[16],
-					word32 msg_nbytes,
-					const byte *msg,
-					byte *out,
-					byte *tag)
+int fm_crypto_oberon_aes128gcm_encrypt_v(const byte key[16],
+					 const byte iv[16],
+					 const struct fm_crypto_iovec *msg_iov,
+					 word32 msg_iovcnt,
+					 byte *out,
+					 byte tag[16])
 {
-	ocrypto_aes_gcm_ctx ctx = {0};
+	struct scratch_aes_gcm *scr = SCRATCH_ALLOC(struct scratch_aes_gcm, SCRATCH_FRAME_AES_GCM);
+	ocrypto_aes_gcm_ctx *ctx = &scr->ctx;
+	byte *block = scr->block;
+	word32 block_nbytes = 0;
+	byte *ct = out;
 
-	LOG_DBG("_fm_crypto_aes128gcm_encrypt");
+	LOG_DBG("fm_crypto_oberon_aes128gcm_encrypt_v");
 	/*
 	* OpenSSL: EVP_EncryptInit_ex()
 	* nrf_oberon: Not needed
@@ -634,23 +1043,71 @@ static int _fm_crypto_aes128gcm_encrypt(const byte key[16],
 	* OpenSSL: EVP_Encrypt*() + EVP_aes_128_gcm()
 	*/
 
-	LOG_HEXDUMP_DBG(msg, msg_nbytes, "ct");
 	LOG_HEXDUMP_DBG(key, 16, "key");
 	LOG_HEXDUMP_DBG(iv, 16, "iv");
 
-	ocrypto_aes_gcm_init(&ctx, key, 16, iv);
-	ocrypto_aes_gcm_init_iv(&ctx, iv, 16);
+	ocrypto_aes_gcm_init(ctx, key, 16, iv);
+	ocrypto_aes_gcm_init_iv(ctx, iv, 16);
+
+	/* Feed the cipher with whole blocks only, except for the last call.
+	 * The fragment bytes that do not fill a whole block are gathered in
+	 * the scratch block before being encrypted.
+	 */
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		const byte *data = msg_iov[i].data;
+		word32 nbytes = msg_iov[i].nbytes;
+		word32 chunk;
+
+		LOG_HEXDUMP_DBG(data, nbytes, "pt");
+
+		if (block_nbytes > 0) {
+			chunk = sizeof(scr->block) - block_nbytes;
+			if (chunk > nbytes) {
+				chunk = nbytes;
+			}
+
+			memcpy(block + block_nbytes, data, chunk);
+			block_nbytes += chunk;
+			data += chunk;
+			nbytes -= chunk;
+
+			if (block_nbytes == sizeof(scr->block)) {
+				ocrypto_aes_gcm_update_enc(ctx, ct, block, sizeof(scr->block));
+				ct += sizeof(scr->block);
+				block_nbytes = 0;
+			}
+		}
+
+		chunk = nbytes - (nbytes % sizeof(scr->block));
+		if (chunk > 0) {
+			ocrypto_aes_gcm_update_enc(ctx, ct, data, chunk);
+			ct += chunk;
+			data += chunk;
+			nbytes -= chunk;
+		}
+
+		if (nbytes > 0) {
+			memcpy(block, data, nbytes);
+			block_nbytes = nbytes;
+		}
+	}
+
+	if (block_nbytes > 0) {
+		ocrypto_aes_gcm_update_enc(ctx, ct, block, block_nbytes);
+		ct += block_nbytes;
+	}
 
-	ocrypto_aes_gcm_update_enc(&ctx, out, msg, msg_nbytes);
-	ocrypto_aes_gcm_final_enc(&ctx, tag, 16);
+	ocrypto_aes_gcm_final_enc(ctx, tag, 16);
 
 	LOG_HEXDUMP_DBG(tag, 16, "tag");
-	LOG_HEXDUMP_DBG(out, msg_nbytes, "out");
+	LOG_HEXDUMP_DBG(out, ct - out, "out");
+
+	SCRATCH_FREE(scr);
 
 	return 0;
 }
 
-/*! @function _fm_crypto_aes128gcm_decrypt
+/*! @function fm_crypto_oberon_aes128gcm_decrypt
  @abstract Decrypts a ciphertext using AES-128-GCM.
 
  @param key       128-bit AES key.
@@ -662,17 +1119,17 @@ static int _fm_crypto_aes128gcm_encrypt(const byte key[16],
 
  @return 0 on success, a negative value on error.
  */
-static int _fm_crypto_aes128gcm_decrypt(const byte key[16],
-					const byte iv[16],
-					word32 ct_nbytes,
-					const byte *ct,
-					const byte *tag,
-					byte *out)
+int fm_crypto_oberon_aes128gcm_decrypt(const byte key[16],
+				       const byte iv[16],
+				       word32 ct_nbytes,
+				       const byte *ct,
+				       const byte tag[16],
+				       byte *out)
 {
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ocrypto_aes_gcm_ctx ctx = {0};
+	struct scratch_aes_gcm *scr = SCRATCH_ALLOC(struct scratch_aes_gcm, SCRATCH_FRAME_AES_GCM);
 
-	LOG_DBG("_fm_crypto_aes128gcm_decrypt");
+	LOG_DBG("fm_crypto_oberon_aes128gcm_decrypt");
 	/*
 	* OpenSSL: EVP_DecryptInit_ex()
 	* nrf_oberon: Not needed
@@ -686,15 +1143,17 @@ static int _fm_crypto_aes128gcm_decrypt(const byte key[16],
 	LOG_HEXDUMP_DBG(key, 16, "key");
 	LOG_HEXDUMP_DBG(iv, 16, "iv");
 
-	ocrypto_aes_gcm_init(&ctx, key, 16, iv);
-	ocrypto_aes_gcm_init_iv(&ctx, iv, 16);
+	ocrypto_aes_gcm_init(&scr->ctx, key, 16, iv);
+	ocrypto_aes_gcm_init_iv(&scr->ctx, iv, 16);
+
+	ocrypto_aes_gcm_update_dec(&scr->ctx, out, ct, ct_nbytes);
+	ret = ocrypto_aes_gcm_final_dec(&scr->ctx, tag, 16);
 
-	ocrypto_aes_gcm_update_dec(&ctx, out, ct, ct_nbytes);
-	ret = ocrypto_aes_gcm_final_dec(&ctx, tag, 16);
+	SCRATCH_FREE(scr);
 
 	LOG_HEXDUMP_DBG(out, ct_nbytes, "out");
 
-	LOG_DBG("_fm_crypto_aes128gcm_decrypt result: 0x%X", ret);
+	LOG_DBG("fm_crypto_oberon_aes128gcm_decrypt result: 0x%X", ret);
 
 	return ret;
 }
@@ -748,7 +1207,7 @@ int fm_crypto_decrypt_e3(const byte serverss[32],
 	/*
 	* OpenSSL: EVP_Decrypt*() + EVP_aes_128_gcm()
 	*/
-	ret = _fm_crypto_aes128gcm_decrypt(
+	ret = fm_crypto_backend.aes128gcm_decrypt(
 		(uint8_t*)k_iv.k1,
 		(uint8_t*)k_iv.iv1,
 		e3_nbytes - 16,
@@ -770,6 +1229,25 @@ error:
 	return ret;
 }
 
+int fm_crypto_decrypt_e3_in_place(const byte serverss[32],
+				  word32 e3_nbytes,
+				  byte *e3,
+				  word32 *pt_nbytes)
+{
+	/* E3 has the 16 byte tag appended. */
+	if (e3_nbytes <= 16) {
+		return -1;
+	}
+
+	/* AES-GCM allows the plaintext to overwrite the ciphertext that
+	 * starts at the same address. The plaintext is zeroized together
+	 * with the ciphertext if the tag does not match.
+	 */
+	*pt_nbytes = e3_nbytes - 16;
+
+	return fm_crypto_decrypt_e3(serverss, e3_nbytes, e3, pt_nbytes, e3);
+}
+
 static int asn1_uint_decode(const uint8_t* asn1,
 			    size_t asn1_len,
 			    uint8_t* output,
@@ -838,21 +1316,61 @@ static int asn1_to_ocrypto_p256(const uint8_t* asn1,
 	return 0;
 }
 
-int fm_crypto_verify_s2(const byte pub[65],
-			word32 sig_nbytes,
-			const byte *sig,
-			word32 msg_nbytes,
-			const byte *msg)
+/*! @function fm_crypto_oberon_sha256_v
+ @abstract Computes the SHA-256 digest of a message given as a list of fragments.
+
+ @param out        Output buffer for the 32-byte digest.
+ @param msg_iov    Message fragments.
+ @param msg_iovcnt Number of message fragments.
+
+ @return 0.
+ */
+int fm_crypto_oberon_sha256_v(byte out[32],
+			      const struct fm_crypto_iovec *msg_iov,
+			      word32 msg_iovcnt)
 {
-	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	ocrypto_sha256_ctx *hash_ctx = SCRATCH_ALLOC(ocrypto_sha256_ctx, SCRATCH_FRAME_SHA256);
+
+	ocrypto_sha256_init(hash_ctx);
 
-	ecc_point pub_key = {0};
-	uint8_t sig_raw[64] = {0};
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		LOG_HEXDUMP_DBG(msg_iov[i].data, msg_iov[i].nbytes, "msg");
+
+		ocrypto_sha256_update(hash_ctx, msg_iov[i].data, msg_iov[i].nbytes);
+	}
+
+	ocrypto_sha256_final(hash_ctx, out);
+
+	SCRATCH_FREE(hash_ctx);
+
+	return 0;
+}
+
+int fm_crypto_oberon_p256_ecdh(byte secret[32], const byte sk[32], const byte pk[64])
+{
+	return ocrypto_ecdh_p256_common_secret(secret, sk, pk);
+}
+
+int fm_crypto_oberon_p256_ecdsa_verify_hash(const byte sig[64],
+					    const byte hash[32],
+					    const byte pk[64])
+{
+	return ocrypto_ecdsa_p256_verify_hash(sig, hash, pk);
+}
+
+int fm_crypto_verify_s2_v(const byte pub[65],
+			  word32 sig_nbytes,
+			  const byte *sig,
+			  const struct fm_crypto_iovec *msg_iov,
+			  word32 msg_iovcnt)
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	struct scratch_verify_s2 *scr =
+		SCRATCH_ALLOC(struct scratch_verify_s2, SCRATCH_FRAME_VERIFY);
 
 	LOG_DBG("fm_crypto_verify_s2");
 	LOG_HEXDUMP_DBG(pub, 65, "pub (BE)");
 	LOG_HEXDUMP_DBG(sig, sig_nbytes, "sig (asn1)");
-	LOG_HEXDUMP_DBG(msg, msg_nbytes, "msg");
 
 	/*
 	* OpenSSL: EC_KEY_new_by_curve_name(NID_X9_62_prime256v1)
@@ -871,44 +1389,103 @@ int fm_crypto_verify_s2(const byte pub[65],
 	* nrf_oberon: Validity checked in ocrypto_curve_p256_from64bytes
 	*/
 	/* Import public key to check that it is valid */
-	ret = ocrypto_curve_p256_from64bytes(&pub_key.point_p256, pub + 1);
+	ret = ocrypto_curve_p256_from64bytes(&scr->pub_key.point_p256, pub + 1);
 	CHECK_RV_GOTO(ret != 0, final);
 
-	LOG_HEXDUMP_DBG(pub_key.point_p256.x.w, 32,
+	LOG_HEXDUMP_DBG(scr->pub_key.point_p256.x.w, 32,
 			"pub_key.point_p256.x (LE)");
-	LOG_HEXDUMP_DBG(pub_key.point_p256.y.w, 32,
+	LOG_HEXDUMP_DBG(scr->pub_key.point_p256.y.w, 32,
 			"pub_key.point_p256.y (LE)");
 
+	ret = asn1_to_ocrypto_p256(sig, sig_nbytes, scr->sig_raw, 64);
+	CHECK_RV_GOTO(ret != 0, final);
+
+	LOG_HEXDUMP_DBG(scr->sig_raw, 64, "sig_raw (BE)");
+
 	/*
 	* OpenSSL: SHA256()
+	* nrf_oberon: Digest computed incrementally over the fragments
 	*/
+	ret = fm_crypto_backend.sha256_v(scr->hash, msg_iov, msg_iovcnt);
+	CHECK_RV_GOTO(ret, final);
+
 	/*
 	* OpenSSL: ECDSA_verify()
-	* nrf_oberon: SHA + ECDSA integrated
 	*/
+	/* Verify the message signature */
+	ret = fm_crypto_backend.p256_ecdsa_verify_hash(scr->sig_raw, scr->hash, pub + 1);
+	CHECK_RV_GOTO(ret, final);
+
+final:
+	SCRATCH_FREE(scr);
+	return ret;
+}
 
-	ret = asn1_to_ocrypto_p256(sig, sig_nbytes, sig_raw, 64);
+int fm_crypto_verify_s2(const byte pub[65],
+			word32 sig_nbytes,
+			const byte *sig,
+			word32 msg_nbytes,
+			const byte *msg)
+{
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_nbytes,
+	};
+
+	return fm_crypto_verify_s2_v(pub, sig_nbytes, sig, &msg_iov, 1);
+}
+
+int fm_crypto_verify_s2_with_table_v(const fm_crypto_p256_comb_table *pub_table,
+				     word32 sig_nbytes,
+				     const byte *sig,
+				     const struct fm_crypto_iovec *msg_iov,
+				     word32 msg_iovcnt)
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	struct scratch_verify_s2 *scr =
+		SCRATCH_ALLOC(struct scratch_verify_s2, SCRATCH_FRAME_VERIFY);
+
+	LOG_DBG("fm_crypto_verify_s2_with_table");
+	LOG_HEXDUMP_DBG(sig, sig_nbytes, "sig (asn1)");
+
+	ret = asn1_to_ocrypto_p256(sig, sig_nbytes, scr->sig_raw, 64);
 	CHECK_RV_GOTO(ret != 0, final);
 
-	LOG_HEXDUMP_DBG(sig_raw, 64, "sig_raw (BE)");
+	LOG_HEXDUMP_DBG(scr->sig_raw, 64, "sig_raw (BE)");
 
-	/* Verify the message signature */
-	ret = ocrypto_ecdsa_p256_verify(sig_raw,
-					msg,
-					msg_nbytes,
-					pub + 1);
+	/*
+	* OpenSSL: SHA256()
+	*/
+	ret = fm_crypto_backend.sha256_v(scr->hash, msg_iov, msg_iovcnt);
 	CHECK_RV_GOTO(ret, final);
 
-	return 0;
+	/*
+	* OpenSSL: ECDSA_verify()
+	* nrf_oberon: Comb tables for G and the public key in fm_crypto_p256
+	*/
+	ret = fm_crypto_p256_verify_hash(scr->sig_raw, scr->hash, pub_table);
+	CHECK_RV_GOTO(ret, final);
 
 final:
+	SCRATCH_FREE(scr);
 	return ret;
 }
 
-int fm_crypto_authenticate_with_ksn(const byte serverss[32],
-				    word32 msg_nbytes,
-				    const byte *msg,
-				    byte out[32])
+int fm_crypto_verify_s2_with_table(const fm_crypto_p256_comb_table *pub_table,
+				   word32 sig_nbytes,
+				   const byte *sig,
+				   word32 msg_nbytes,
+				   const byte *msg)
+{
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_nbytes,
+	};
+
+	return fm_crypto_verify_s2_with_table_v(pub_table, sig_nbytes, sig, &msg_iov, 1);
+}
+
+int fm_crypto_ksn_hmac_init(fm_crypto_ksn_hmac_t ctx, const byte serverss[32])
 {
 	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
 	uint8_t ksn[32] = {0};
@@ -931,14 +1508,67 @@ int fm_crypto_authenticate_with_ksn(const byte serverss[32],
 	CHECK_RV_GOTO(ret, error);
 
 	/*
-	* OpenSSL: HMAC(EVP_sha256())
+	* OpenSSL: HMAC_Init_ex()
+	* nrf_oberon: The inner pad is hashed here and kept in the context
 	*/
-	/* Calculate HMAC from message and write into out */
-	ocrypto_hmac_sha256(out, ksn, 32, msg, msg_nbytes);
+	ocrypto_hmac_sha256_init(&ctx->hmac, ksn, sizeof(ksn));
+
+	ocrypto_constant_time_fill_zero(ksn, sizeof(ksn));
+
+	return 0;
+
+error:
+	ocrypto_constant_time_fill_zero(ksn, sizeof(ksn));
+	ocrypto_constant_time_fill_zero(ctx, sizeof(*ctx));
+	return ret;
+}
+
+void fm_crypto_ksn_hmac_free(fm_crypto_ksn_hmac_t ctx)
+{
+	ocrypto_constant_time_fill_zero(ctx, sizeof(*ctx));
+}
+
+int fm_crypto_authenticate_with_ksn_hmac(const struct fm_crypto_ksn_hmac *ctx,
+					 word32 msg_nbytes,
+					 const byte *msg,
+					 byte out[32])
+{
+	ocrypto_hmac_sha256_ctx *hmac = SCRATCH_ALLOC(ocrypto_hmac_sha256_ctx, SCRATCH_FRAME_HMAC);
+
+	/*
+	* OpenSSL: HMAC_CTX_copy() + HMAC_Update() + HMAC_Final()
+	*/
+	/* Continue from a copy of the keyed state and write the MAC into out */
+	ocrypto_constant_time_copy(hmac, &ctx->hmac, sizeof(*hmac));
+	ocrypto_hmac_sha256_update(hmac, msg, msg_nbytes);
+	ocrypto_hmac_sha256_final(hmac, out);
+
+	SCRATCH_FREE(hmac);
+
+	return 0;
+}
+
+int fm_crypto_authenticate_with_ksn(const byte serverss[32],
+				    word32 msg_nbytes,
+				    const byte *msg,
+				    byte out[32])
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	struct fm_crypto_ksn_hmac *ksn_hmac =
+		SCRATCH_ALLOC(struct fm_crypto_ksn_hmac, SCRATCH_FRAME_AUTHENTICATE);
+
+	ret = fm_crypto_ksn_hmac_init(ksn_hmac, serverss);
+	CHECK_RV_GOTO(ret, error);
+
+	ret = fm_crypto_authenticate_with_ksn_hmac(ksn_hmac, msg_nbytes, msg, out);
+	CHECK_RV_GOTO(ret, error);
+
+	SCRATCH_FREE(ksn_hmac);
 
 	return 0;
 
 error:
+	SCRATCH_FREE(ksn_hmac);
 	ocrypto_constant_time_fill_zero(out, 32);
 	return ret;
 }
@@ -954,26 +1584,42 @@ int fm_crypto_generate_seedk1(byte out[32])
 	return ret;
 }
 
-int fm_crypto_encrypt_to_server(const byte pub[65],
-				word32 msg_nbytes,
-				const byte *msg,
-				word32 *out_nbytes,
-				byte *out)
+int fm_crypto_ephemeral_key_generate(fm_crypto_ephemeral_key_t key)
 {
-	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
-	ecc_point pub_key = {0};
-	ecc_key Q = {0};
-	uint8_t common_secret[32] = {0};
+	int ret;
 
-	struct {
-		uint32_t k[4];
-		uint32_t iv[4];
-	} k_iv = {0};
+	/*
+	* Generate ephemeral key.
+	*
+	* OpenSSL: EC_KEY_generate_key()
+	*/
+	ret = ecc_gen_keypair(&key->q, ECC_TYPE_P256);
+	if (ret) {
+		ocrypto_constant_time_fill_zero(key, sizeof(*key));
+	}
 
-	uint8_t QP[2 * 65] = {0};
+	return ret;
+}
+
+int fm_crypto_encrypt_to_server_v_with_key(fm_crypto_ephemeral_key_t key,
+					   const byte pub[65],
+					   const struct fm_crypto_iovec *msg_iov,
+					   word32 msg_iovcnt,
+					   word32 *out_nbytes,
+					   byte *out)
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	word32 msg_nbytes = 0;
+	ecc_key *Q = &key->q;
+	struct scratch_encrypt *scr =
+		SCRATCH_ALLOC(struct scratch_encrypt, SCRATCH_FRAME_ENCRYPT_WITH_KEY);
 
 	LOG_DBG("fm_crypto_encrypt_to_server");
 
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		msg_nbytes += msg_iov[i].nbytes;
+	}
+
 	/*
 	* OpenSSL: EC_KEY_new_by_curve_name(NID_X9_62_prime256v1)
 	* nrf_oberon: Allocation not needed
@@ -997,34 +1643,27 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 	* nrf_oberon: Validated in ocrypto_curve_p256_from64bytes
 	*/
 	/* Import public key and check that it is valid */
-	ret = ocrypto_curve_p256_from64bytes(&pub_key.point_p256, pub + 1);
+	ret = ocrypto_curve_p256_from64bytes(&scr->pub_key.point_p256, pub + 1);
 	CHECK_RV_GOTO(ret, error);
 
-	/*
-	* Generate ephemeral key.
-	*
-	* OpenSSL: EC_KEY_generate_key()
-	*/
-	/* 1. Generate an ephemeral P-256 key. */
-	ret = ecc_gen_keypair(&Q, ECC_TYPE_P256);
-	CHECK_RV_GOTO(ret, error);
+	/* 1. The ephemeral P-256 key is generated by the caller. */
 
-	LOG_HEXDUMP_DBG(Q.private_key.scalar_p256.w, 32, "ephemeral prv (LE)");
-	LOG_HEXDUMP_DBG(Q.public_key.point_p256.x.w, 32, "ephemeral pub.x (LE)");
-	LOG_HEXDUMP_DBG(Q.public_key.point_p256.y.w, 32, "ephemeral pub.y (LE)");
+	LOG_HEXDUMP_DBG(Q->private_key.scalar_p256.w, 32, "ephemeral prv (LE)");
+	LOG_HEXDUMP_DBG(Q->public_key.point_p256.x.w, 32, "ephemeral pub.x (LE)");
+	LOG_HEXDUMP_DBG(Q->public_key.point_p256.y.w, 32, "ephemeral pub.y (LE)");
 
 	/*
 	* Generate shared secret.
 	*
 	* OpenSSL: ECDH_compute_key()
 	*/
-	ret = ocrypto_ecdh_p256_common_secret(
-		common_secret,
-		Q.private_key.buffer,
+	ret = fm_crypto_backend.p256_ecdh(
+		scr->common_secret,
+		Q->private_key.buffer,
 		pub + 1);
 	CHECK_RV_GOTO(ret, error);
 
-	LOG_HEXDUMP_DBG(common_secret, 32, "common_secret");
+	LOG_HEXDUMP_DBG(scr->common_secret, 32, "common_secret");
 
 	/*
 	* OpenSSL: BN_bn2bin() + EC_POINT_get_affine_coordinates_GFp()
@@ -1034,15 +1673,15 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 	/* Creating sharedinfo: Q || P */
 
 	/* Set uncompressed tag for Q in QP */
-	QP[0] = 0x04;
+	scr->QP[0] = 0x04;
 	/* Copy Q into QP */
-	ocrypto_curve_p256_to64bytes(QP + 1, &Q.public_key.point_p256);
+	ocrypto_curve_p256_to64bytes(scr->QP + 1, &Q->public_key.point_p256);
 
 	/* Copy Point Q into out */
-	ocrypto_constant_time_copy(out, QP, 65);
+	ocrypto_constant_time_copy(out, scr->QP, 65);
 
 	/* Copy Point P (with uncompressed tag) to QP */
-	ocrypto_constant_time_copy(QP + 65, pub, 65);
+	ocrypto_constant_time_copy(scr->QP + 65, pub, 65);
 
 	/*
 	* Derive key and IV.
@@ -1054,13 +1693,13 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 	 * V = ANSI-X9.63-KDF(x(Z), Q || P).
 	 */
 	ret = ansi_x963_kdf(
-		(uint8_t*) &k_iv, 32, /* Generated Key IV */
-		common_secret, 32, /* Key input: common_secret */
-		QP, sizeof(QP)); /* SharedInfo: QP */
+		(uint8_t*) &scr->k_iv, 32, /* Generated Key IV */
+		scr->common_secret, 32, /* Key input: common_secret */
+		scr->QP, sizeof(scr->QP)); /* SharedInfo: QP */
 	CHECK_RV_GOTO(ret, error);
 
-	LOG_HEXDUMP_DBG((uint8_t*) &k_iv.k, 16, "key");
-	LOG_HEXDUMP_DBG((uint8_t*) &k_iv.iv, 16, "iv");
+	LOG_HEXDUMP_DBG((uint8_t*) &scr->k_iv.k, 16, "key");
+	LOG_HEXDUMP_DBG((uint8_t*) &scr->k_iv.iv, 16, "iv");
 
 	/*
 	* Encrypt.
@@ -1073,11 +1712,11 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 	 *   data. K is the 128-bit AES key, IV is the initialization vector, C is the ciphertext, and T is the 16-
 	 *   byte authentication tag.
 	 */
-	ret = _fm_crypto_aes128gcm_encrypt(
-		(uint8_t*) k_iv.k,
-		(uint8_t*) k_iv.iv,
-		msg_nbytes,
-		msg,
+	ret = fm_crypto_backend.aes128gcm_encrypt_v(
+		(uint8_t*) scr->k_iv.k,
+		(uint8_t*) scr->k_iv.iv,
+		msg_iov,
+		msg_iovcnt,
 		out + 65,
 		out + 65 + msg_nbytes);
 	CHECK_RV_GOTO(ret, error);
@@ -1085,11 +1724,78 @@ int fm_crypto_encrypt_to_server(const byte pub[65],
 	/* Set the outut byte size */
 	*out_nbytes = 65 + msg_nbytes + 16;
 
+	ocrypto_constant_time_fill_zero(key, sizeof(*key));
+	/* The shared secret and the derived key are zeroized on release */
+	SCRATCH_FREE(scr);
+
 	return 0;
 
 error:
-	ocrypto_constant_time_fill_zero(&k_iv, sizeof(k_iv));
+	ocrypto_constant_time_fill_zero(key, sizeof(*key));
+	SCRATCH_FREE(scr);
 	ocrypto_constant_time_fill_zero(out, 65 + msg_nbytes + 16);
 	*out_nbytes = 0;
 	return ret;
 }
+
+int fm_crypto_encrypt_to_server_with_key(fm_crypto_ephemeral_key_t key,
+					 const byte pub[65],
+					 word32 msg_nbytes,
+					 const byte *msg,
+					 word32 *out_nbytes,
+					 byte *out)
+{
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_nbytes,
+	};
+
+	return fm_crypto_encrypt_to_server_v_with_key(key, pub, &msg_iov, 1, out_nbytes, out);
+}
+
+int fm_crypto_encrypt_to_server_v(const byte pub[65],
+				  const struct fm_crypto_iovec *msg_iov,
+				  word32 msg_iovcnt,
+				  word32 *out_nbytes,
+				  byte *out)
+{
+	int ret = FMN_ERROR_CRYPTO_NO_VALUE_SET;
+	word32 msg_nbytes = 0;
+	struct fm_crypto_ephemeral_key *key =
+		SCRATCH_ALLOC(struct fm_crypto_ephemeral_key, SCRATCH_FRAME_ENCRYPT);
+
+	/* 1. Generate an ephemeral P-256 key. */
+	ret = fm_crypto_ephemeral_key_generate(key);
+	CHECK_RV_GOTO(ret, error);
+
+	ret = fm_crypto_encrypt_to_server_v_with_key(key, pub, msg_iov, msg_iovcnt,
+						     out_nbytes, out);
+	SCRATCH_FREE(key);
+
+	return ret;
+
+error:
+	SCRATCH_FREE(key);
+
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		msg_nbytes += msg_iov[i].nbytes;
+	}
+
+	ocrypto_constant_time_fill_zero(out, 65 + msg_nbytes + 16);
+	*out_nbytes = 0;
+	return ret;
+}
+
+int fm_crypto_encrypt_to_server(const byte pub[65],
+				word32 msg_nbytes,
+				const byte *msg,
+				word32 *out_nbytes,
+				byte *out)
+{
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_nbytes,
+	};
+
+	return fm_crypto_encrypt_to_server_v(pub, &msg_iov, 1, out_nbytes, out);
+}
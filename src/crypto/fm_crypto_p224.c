@@ -0,0 +1,603 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fm_crypto_p224.h"
+#include "fm_crypto_platform.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <ocrypto_constant_time.h>
+
+/*
+ * Field elements are stored as 7 little-endian 32-bit words in Montgomery form
+ * with R = 2^224. Points use projective coordinates (X : Y : Z) and the complete
+ * addition formulas for short Weierstrass curves with a = -3 from
+ * Renes, Costello, Batina: "Complete addition formulas for prime order elliptic
+ * curves" (Algorithms 4 and 6). The formulas handle the point at infinity and
+ * doubling without branches, which keeps the whole ladder constant time.
+ */
+
+#define WORDS FM_CRYPTO_P224_WORDS
+
+typedef uint32_t fe[WORDS];
+
+/* p = 2^224 - 2^96 + 1 */
+static const fe p224 = {
+	0x00000001, 0x00000000, 0x00000000, 0xffffffff,
+	0xffffffff, 0xffffffff, 0xffffffff
+};
+
+/* R^2 mod p */
+static const fe p224_r2 = {
+	0x00000001, 0x00000000, 0x00000000, 0xfffffffe,
+	0xffffffff, 0xffffffff, 0x00000000
+};
+
+/* Curve parameter b in Montgomery form. */
+static const fe p224_b = {
+	0xe768cdf7, 0xccf01310, 0x743b1cc0, 0xc8528150,
+	0x3dceba98, 0x7fc02f93, 0x9c3fa633
+};
+
+/* 1 in Montgomery form (R mod p). */
+static const fe p224_one = {
+	0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+	0x00000000, 0x00000000, 0x00000000
+};
+
+/* Window table with the multiples 0 * G ... 15 * G of the base point G. */
+static const fm_crypto_p224_table p224_g_table = { .t = {
+	/* 0 * G */
+	{ .x = { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 },
+	  .y = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 },
+	  .z = { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 1 * G */
+	{ .x = { 0xbc905227, 0x6018bfaa, 0xf22fe220, 0xf96bec04,
+		 0x6dd3af9b, 0xa21b5e60, 0x92f5b516 },
+	  .y = { 0x2edca1e6, 0x05335a6b, 0xe8c15513, 0x03dfe878,
+		 0xaea9c5ae, 0x614786f1, 0x100c1218 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 2 * G */
+	{ .x = { 0x4ca9a1ed, 0x5650df9b, 0xbe27f7a3, 0x2a0f1689,
+		 0x10c911f7, 0xcafb50f5, 0x18dd00ac },
+	  .y = { 0x02aac79c, 0xc90ae186, 0xe72e600f, 0x76cc1019,
+		 0x0c84ced0, 0x5cabb880, 0x6a5db1a2 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 3 * G */
+	{ .x = { 0xe37710d8, 0xe0b02223, 0xab22ca96, 0xc3cf1c5a,
+		 0x00505bb6, 0xaf8b6496, 0x799eb566 },
+	  .y = { 0x9a73b174, 0x04144e62, 0xe434f88f, 0x357940ab,
+		 0xafe10c35, 0x6dfa492c, 0x8c1b1da3 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 4 * G */
+	{ .x = { 0x0a72faf7, 0x0860856c, 0xc03cd01a, 0xcb021705,
+		 0x4256e88a, 0x89f0c6a0, 0x7bf0ef17 },
+	  .y = { 0x6743e274, 0x98933269, 0x64b26855, 0x2058f0ba,
+		 0x7ee104d3, 0x8c87db62, 0x73e0d4c7 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 5 * G */
+	{ .x = { 0x0b10cc51, 0xf8dfc283, 0xac3c8962, 0x975a451e,
+		 0x39211b77, 0xf7f4fe95, 0x2bd053a8 },
+	  .y = { 0x2b552e74, 0x61a9e695, 0xc350ef91, 0x11bcf037,
+		 0x42b54f79, 0xc858da82, 0x9b052162 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 6 * G */
+	{ .x = { 0xde577c0e, 0x1a8aec73, 0xe82df964, 0xe0cd01d3,
+		 0x1addb3a1, 0xf25fe17c, 0x21b6fe25 },
+	  .y = { 0x5fae6c33, 0x0f5c7709, 0x327f8848, 0xf2d2c41c,
+		 0x9b6731a6, 0x162f9e1c, 0x2383dee4 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 7 * G */
+	{ .x = { 0x90462821, 0x68646e35, 0x5048b145, 0x1e2526ba,
+		 0xc81df812, 0x7ed50814, 0x7665453e },
+	  .y = { 0x610f2186, 0x1fb32889, 0x9d0eba26, 0xed8ceeed,
+		 0xce5eb25e, 0x0e5952e3, 0xa229bf84 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 8 * G */
+	{ .x = { 0xb4c9d866, 0x7bd696a2, 0x1de5d041, 0xa3bebfe9,
+		 0x8e4a5712, 0x1b59038c, 0x21e8f814 },
+	  .y = { 0x1bc1ff37, 0x7558734a, 0x38a20402, 0x0976258f,
+		 0xc4e19066, 0x2199c364, 0xd65a0dfb },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 9 * G */
+	{ .x = { 0x1c1ecc78, 0x743eda4a, 0x9f0b4f26, 0x2f993a4f,
+		 0x94f5e9ba, 0x79d4095a, 0x846b2c39 },
+	  .y = { 0xe07e55b7, 0x909bf3f1, 0xbacf5e6a, 0x77e1db6c,
+		 0xe733d627, 0x5114ac9d, 0x70889bf7 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 10 * G */
+	{ .x = { 0xb808145d, 0xb4f2672c, 0x328e0ac0, 0x3e8abf6a,
+		 0xc1f86e2c, 0x9d0cdd53, 0x5ac34abe },
+	  .y = { 0xccddcf00, 0x02883b6f, 0x225faa54, 0x873d7e4c,
+		 0xdbc0f8ee, 0x2a687506, 0x722981c9 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 11 * G */
+	{ .x = { 0xac358ca9, 0xe1bdd5ca, 0xde5d2c4d, 0xd0dee305,
+		 0x0f060758, 0xd6d89093, 0x9397da27 },
+	  .y = { 0x649ea143, 0x08181c2c, 0x79888920, 0x6c63713a,
+		 0xc1182bf0, 0x45e48d79, 0x0e48dd82 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 12 * G */
+	{ .x = { 0xf6495da2, 0xa37b7441, 0xed4d0ea3, 0x2b0b8e19,
+		 0x571d38d9, 0x517af941, 0x70792626 },
+	  .y = { 0x1305b613, 0x8cf21835, 0x208ffd66, 0x5f59deb1,
+		 0xbc243af0, 0xa71404ae, 0x6d228d4b },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 13 * G */
+	{ .x = { 0x489c8db3, 0xffbe563f, 0x83630fe6, 0xbc99fb0a,
+		 0x68ade63c, 0x398eacf0, 0xc5e095c8 },
+	  .y = { 0x83fdacb6, 0x800df824, 0xa3ffe74f, 0x442ed616,
+		 0xb4dc6bf8, 0x3f8060b4, 0x12ab633c },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 14 * G */
+	{ .x = { 0xf4109222, 0xcdbd6eec, 0x0e9441ba, 0x1ef814eb,
+		 0xf4550d2e, 0xb3a9b5e4, 0x47c1182a },
+	  .y = { 0x1544e90f, 0x3f51f9f9, 0x9ed249e3, 0x825b5794,
+		 0x6516bbc3, 0x3d1419d2, 0x92de7285 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+	/* 15 * G */
+	{ .x = { 0x55bfd51a, 0xb16ed1af, 0x464afb0a, 0xd91345bb,
+		 0xc5e26f62, 0x64a35d22, 0x16880cc7 },
+	  .y = { 0x05015843, 0x70203aa0, 0x11e4ffa1, 0x05a83a63,
+		 0xdaf3972b, 0x9422f10e, 0x5dbc0e12 },
+	  .z = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+		 0x00000000, 0x00000000, 0x00000000 } },
+} };
+
+/* r = a - b mod p for a, b < p */
+static void fe_sub(fe r, const fe a, const fe b)
+{
+	uint64_t t;
+	uint32_t borrow = 0;
+	uint32_t mask;
+	uint32_t carry = 0;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		t = (uint64_t)a[i] - b[i] - borrow;
+		r[i] = (uint32_t)t;
+		borrow = (uint32_t)(t >> 32) & 1;
+	}
+
+	/* Add p back if the subtraction has underflowed. */
+	mask = 0 - borrow;
+	for (size_t i = 0; i < WORDS; i++) {
+		t = (uint64_t)r[i] + (p224[i] & mask) + carry;
+		r[i] = (uint32_t)t;
+		carry = (uint32_t)(t >> 32);
+	}
+}
+
+/* r = a + b mod p for a, b < p */
+static void fe_add(fe r, const fe a, const fe b)
+{
+	uint64_t t;
+	uint32_t carry = 0;
+	uint32_t borrow = 0;
+	uint32_t mask;
+	fe d;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		t = (uint64_t)a[i] + b[i] + carry;
+		r[i] = (uint32_t)t;
+		carry = (uint32_t)(t >> 32);
+	}
+
+	/* Subtract p if the sum has overflowed or is not smaller than p. */
+	for (size_t i = 0; i < WORDS; i++) {
+		t = (uint64_t)r[i] - p224[i] - borrow;
+		d[i] = (uint32_t)t;
+		borrow = (uint32_t)(t >> 32) & 1;
+	}
+
+	mask = 0 - (carry | (borrow ^ 1));
+	for (size_t i = 0; i < WORDS; i++) {
+		r[i] = (d[i] & mask) | (r[i] & ~mask);
+	}
+}
+
+/* r = a * b * R^-1 mod p for a, b < p */
+static void fe_mul(fe r, const fe a, const fe b)
+{
+	uint32_t t[WORDS + 2] = {0};
+	uint64_t acc;
+	uint32_t m;
+	uint32_t borrow = 0;
+	uint32_t mask;
+	fe d;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		/* t = t + a * b[i] */
+		acc = 0;
+		for (size_t j = 0; j < WORDS; j++) {
+			acc += (uint64_t)t[j] + (uint64_t)a[j] * b[i];
+			t[j] = (uint32_t)acc;
+			acc >>= 32;
+		}
+		acc += t[WORDS];
+		t[WORDS] = (uint32_t)acc;
+		t[WORDS + 1] = (uint32_t)(acc >> 32);
+
+		/* -p^-1 mod 2^32 is 0xFFFFFFFF, since p = 1 mod 2^32. */
+		m = 0 - t[0];
+
+		/* t = (t + m * p) / 2^32 */
+		acc = (uint64_t)t[0] + (uint64_t)m * p224[0];
+		acc >>= 32;
+		for (size_t j = 1; j < WORDS; j++) {
+			acc += (uint64_t)t[j] + (uint64_t)m * p224[j];
+			t[j - 1] = (uint32_t)acc;
+			acc >>= 32;
+		}
+		acc += t[WORDS];
+		t[WORDS - 1] = (uint32_t)acc;
+		t[WORDS] = t[WORDS + 1] + (uint32_t)(acc >> 32);
+	}
+
+	/* The result is smaller than 2p, subtract p once if necessary. */
+	for (size_t i = 0; i < WORDS; i++) {
+		acc = (uint64_t)t[i] - p224[i] - borrow;
+		d[i] = (uint32_t)acc;
+		borrow = (uint32_t)(acc >> 32) & 1;
+	}
+
+	mask = 0 - (t[WORDS] | (borrow ^ 1));
+	for (size_t i = 0; i < WORDS; i++) {
+		r[i] = (d[i] & mask) | (t[i] & ~mask);
+	}
+}
+
+/* r = a^(p - 2) = a^-1 mod p, in Montgomery form */
+static void fe_inv(fe r, const fe a)
+{
+	/* p - 2 = 2^224 - 2^96 - 1: bits 0..95 and 97..223 are set. */
+	fe acc;
+
+	memcpy(acc, p224_one, sizeof(acc));
+	for (int bit = 223; bit >= 0; bit--) {
+		fe_mul(acc, acc, acc);
+		if (bit != 96) {
+			fe_mul(acc, acc, a);
+		}
+	}
+
+	memcpy(r, acc, sizeof(acc));
+}
+
+static void fe_from_bytes(fe r, const uint8_t in[28])
+{
+	fe t;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		const uint8_t *w = in + 4 * (WORDS - 1 - i);
+
+		t[i] = ((uint32_t)w[0] << 24) | ((uint32_t)w[1] << 16) |
+		       ((uint32_t)w[2] << 8) | (uint32_t)w[3];
+	}
+
+	/* Convert to the Montgomery form. */
+	fe_mul(r, t, p224_r2);
+}
+
+static void fe_to_bytes(uint8_t out[28], const fe a)
+{
+	static const fe one = {1};
+	fe t;
+
+	/* Convert from the Montgomery form. */
+	fe_mul(t, a, one);
+
+	for (size_t i = 0; i < WORDS; i++) {
+		uint8_t *w = out + 4 * (WORDS - 1 - i);
+
+		w[0] = (uint8_t)(t[i] >> 24);
+		w[1] = (uint8_t)(t[i] >> 16);
+		w[2] = (uint8_t)(t[i] >> 8);
+		w[3] = (uint8_t)t[i];
+	}
+}
+
+/* r = a + b, complete addition for a = -3 (RCB Algorithm 4) */
+static void point_add(fm_crypto_p224_point *r,
+		      const fm_crypto_p224_point *a,
+		      const fm_crypto_p224_point *b)
+{
+	fe t0, t1, t2, t3, t4;
+	fe x3, y3, z3;
+
+	fe_mul(t0, a->x, b->x);
+	fe_mul(t1, a->y, b->y);
+	fe_mul(t2, a->z, b->z);
+	fe_add(t3, a->x, a->y);
+	fe_add(t4, b->x, b->y);
+	fe_mul(t3, t3, t4);
+	fe_add(t4, t0, t1);
+	fe_sub(t3, t3, t4);
+	fe_add(t4, a->y, a->z);
+	fe_add(x3, b->y, b->z);
+	fe_mul(t4, t4, x3);
+	fe_add(x3, t1, t2);
+	fe_sub(t4, t4, x3);
+	fe_add(x3, a->x, a->z);
+	fe_add(y3, b->x, b->z);
+	fe_mul(x3, x3, y3);
+	fe_add(y3, t0, t2);
+	fe_sub(y3, x3, y3);
+	fe_mul(z3, p224_b, t2);
+	fe_sub(x3, y3, z3);
+	fe_add(z3, x3, x3);
+	fe_add(x3, x3, z3);
+	fe_sub(z3, t1, x3);
+	fe_add(x3, t1, x3);
+	fe_mul(y3, p224_b, y3);
+	fe_add(t1, t2, t2);
+	fe_add(t2, t1, t2);
+	fe_sub(y3, y3, t2);
+	fe_sub(y3, y3, t0);
+	fe_add(t1, y3, y3);
+	fe_add(y3, t1, y3);
+	fe_add(t1, t0, t0);
+	fe_add(t0, t1, t0);
+	fe_sub(t0, t0, t2);
+	fe_mul(t1, t4, y3);
+	fe_mul(t2, t0, y3);
+	fe_mul(y3, x3, z3);
+	fe_add(y3, y3, t2);
+	fe_mul(x3, t3, x3);
+	fe_sub(x3, x3, t1);
+	fe_mul(z3, t4, z3);
+	fe_mul(t1, t3, t0);
+	fe_add(z3, z3, t1);
+
+	memcpy(r->x, x3, sizeof(x3));
+	memcpy(r->y, y3, sizeof(y3));
+	memcpy(r->z, z3, sizeof(z3));
+}
+
+/* r = 2 * a, complete doubling for a = -3 (RCB Algorithm 6) */
+static void point_double(fm_crypto_p224_point *r, const fm_crypto_p224_point *a)
+{
+	fe t0, t1, t2, t3;
+	fe x3, y3, z3;
+
+	fe_mul(t0, a->x, a->x);
+	fe_mul(t1, a->y, a->y);
+	fe_mul(t2, a->z, a->z);
+	fe_mul(t3, a->x, a->y);
+	fe_add(t3, t3, t3);
+	fe_mul(z3, a->x, a->z);
+	fe_add(z3, z3, z3);
+	fe_mul(y3, p224_b, t2);
+	fe_sub(y3, y3, z3);
+	fe_add(x3, y3, y3);
+	fe_add(y3, x3, y3);
+	fe_sub(x3, t1, y3);
+	fe_add(y3, t1, y3);
+	fe_mul(y3, x3, y3);
+	fe_mul(x3, x3, t3);
+	fe_add(t3, t2, t2);
+	fe_add(t2, t2, t3);
+	fe_mul(z3, p224_b, z3);
+	fe_sub(z3, z3, t2);
+	fe_sub(z3, z3, t0);
+	fe_add(t3, z3, z3);
+	fe_add(z3, z3, t3);
+	fe_add(t3, t0, t0);
+	fe_add(t0, t3, t0);
+	fe_sub(t0, t0, t2);
+	fe_mul(t0, t0, z3);
+	fe_add(y3, y3, t0);
+	fe_mul(t0, a->y, a->z);
+	fe_add(t0, t0, t0);
+	fe_mul(z3, t0, z3);
+	fe_sub(x3, x3, z3);
+	fe_mul(z3, t0, t1);
+	fe_add(z3, z3, z3);
+	fe_add(z3, z3, z3);
+
+	memcpy(r->x, x3, sizeof(x3));
+	memcpy(r->y, y3, sizeof(y3));
+	memcpy(r->z, z3, sizeof(z3));
+}
+
+/* r = table[index], reading every entry to hide the secret index */
+static void table_select(fm_crypto_p224_point *r,
+			 const fm_crypto_p224_table *table,
+			 uint32_t index)
+{
+	memset(r, 0, sizeof(*r));
+
+	for (uint32_t i = 0; i < FM_CRYPTO_P224_TABLE_SIZE; i++) {
+		/* mask = 0xFFFFFFFF if i == index, 0 otherwise */
+		uint32_t diff = i ^ index;
+		uint32_t mask = ((diff | (0 - diff)) >> 31) - 1;
+
+		for (size_t j = 0; j < WORDS; j++) {
+			r->x[j] |= table->t[i].x[j] & mask;
+			r->y[j] |= table->t[i].y[j] & mask;
+			r->z[j] |= table->t[i].z[j] & mask;
+		}
+	}
+}
+
+/* Returns the 4-bit window at the given position, counting from the least significant. */
+static uint32_t scalar_window(const uint8_t s[28], size_t pos)
+{
+	uint8_t byte = s[27 - (pos / 2)];
+
+	return (pos & 1) ? (byte >> 4) : (byte & 0x0f);
+}
+
+void fm_crypto_p224_table_init(fm_crypto_p224_table *table, const uint8_t p[56])
+{
+	fm_crypto_p224_point *t = table->t;
+
+	/* 0 * P is the point at infinity (0 : 1 : 0). */
+	memset(&t[0], 0, sizeof(t[0]));
+	memcpy(t[0].y, p224_one, sizeof(p224_one));
+
+	/* 1 * P */
+	fe_from_bytes(t[1].x, p);
+	fe_from_bytes(t[1].y, p + 28);
+	memcpy(t[1].z, p224_one, sizeof(p224_one));
+
+	for (size_t i = 2; i < FM_CRYPTO_P224_TABLE_SIZE; i++) {
+		if (i & 1) {
+			point_add(&t[i], &t[i - 1], &t[1]);
+		} else {
+			point_double(&t[i], &t[i / 2]);
+		}
+	}
+}
+
+static void twin_ladder(fm_crypto_p224_point *acc,
+			const uint8_t u[28],
+			const fm_crypto_p224_table *p_table,
+			const uint8_t v[28])
+{
+	fm_crypto_p224_point tmp;
+
+	/* Start from the point at infinity. */
+	memset(acc, 0, sizeof(*acc));
+	memcpy(acc->y, p224_one, sizeof(p224_one));
+
+	for (size_t pos = 2 * 28; pos-- > 0;) {
+		for (size_t i = 0; i < FM_CRYPTO_P224_WINDOW_BITS; i++) {
+			point_double(acc, acc);
+		}
+
+		table_select(&tmp, p_table, scalar_window(u, pos));
+		point_add(acc, acc, &tmp);
+
+		table_select(&tmp, &p224_g_table, scalar_window(v, pos));
+		point_add(acc, acc, &tmp);
+	}
+
+	ocrypto_constant_time_fill_zero(&tmp, sizeof(tmp));
+}
+
+static bool point_is_infinity(const fm_crypto_p224_point *p)
+{
+	uint32_t z_acc = 0;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		z_acc |= p->z[i];
+	}
+
+	return (z_acc == 0);
+}
+
+static void point_to_bytes(uint8_t r[56], const fm_crypto_p224_point *p, const fe z_inv)
+{
+	fe x;
+	fe y;
+
+	fe_mul(x, p->x, z_inv);
+	fe_mul(y, p->y, z_inv);
+
+	fe_to_bytes(r, x);
+	fe_to_bytes(r + 28, y);
+}
+
+int fm_crypto_p224_twin_mult(uint8_t r[56],
+			     const uint8_t u[28],
+			     const fm_crypto_p224_table *p_table,
+			     const uint8_t v[28])
+{
+	fm_crypto_p224_point acc;
+	fe z_inv;
+
+	twin_ladder(&acc, u, p_table, v);
+
+	/* The result at infinity has no affine representation. */
+	if (point_is_infinity(&acc)) {
+		memset(r, 0, 56);
+		return FMN_ERROR_CRYPTO_INVALID_INPUT;
+	}
+
+	/* Convert to the affine coordinates. */
+	fe_inv(z_inv, acc.z);
+	point_to_bytes(r, &acc, z_inv);
+
+	ocrypto_constant_time_fill_zero(&acc, sizeof(acc));
+
+	return FMN_ERROR_CRYPTO_OK;
+}
+
+int fm_crypto_p224_twin_mult_batch(uint8_t r[][56],
+				   const uint8_t u[][28],
+				   const fm_crypto_p224_table *p_table,
+				   const uint8_t v[][28],
+				   size_t count)
+{
+	fm_crypto_p224_point acc[FM_CRYPTO_P224_BATCH_MAX];
+	fe prod[FM_CRYPTO_P224_BATCH_MAX];
+	fe inv;
+	fe z_inv;
+	int ret = FMN_ERROR_CRYPTO_OK;
+
+	if ((count == 0) || (count > FM_CRYPTO_P224_BATCH_MAX)) {
+		return FMN_ERROR_CRYPTO_INVALID_SIZE;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		twin_ladder(&acc[i], u[i], p_table, v[i]);
+
+		/* A single point at infinity would zero the whole product. */
+		if (point_is_infinity(&acc[i])) {
+			ret = FMN_ERROR_CRYPTO_INVALID_INPUT;
+			goto cleanup;
+		}
+	}
+
+	/* Montgomery's trick: prod[i] = z[0] * ... * z[i]. */
+	memcpy(prod[0], acc[0].z, sizeof(fe));
+	for (size_t i = 1; i < count; i++) {
+		fe_mul(prod[i], prod[i - 1], acc[i].z);
+	}
+
+	/* One inversion of the full product for the whole batch. */
+	fe_inv(inv, prod[count - 1]);
+
+	for (size_t i = count; i-- > 1;) {
+		/* 1 / z[i] = (z[0] * ... * z[i - 1]) / (z[0] * ... * z[i]) */
+		fe_mul(z_inv, inv, prod[i - 1]);
+		point_to_bytes(r[i], &acc[i], z_inv);
+
+		/* Drop z[i] from the inverted product. */
+		fe_mul(inv, inv, acc[i].z);
+	}
+	point_to_bytes(r[0], &acc[0], inv);
+
+cleanup:
+	if (ret) {
+		memset(r, 0, count * 56);
+	}
+
+	ocrypto_constant_time_fill_zero(acc, sizeof(acc));
+	ocrypto_constant_time_fill_zero(prod, sizeof(prod));
+	ocrypto_constant_time_fill_zero(inv, sizeof(inv));
+	ocrypto_constant_time_fill_zero(z_inv, sizeof(z_inv));
+
+	return ret;
+}
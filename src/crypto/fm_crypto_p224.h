@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FM_CRYPTO_P224_H_
+#define FM_CRYPTO_P224_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Number of 32-bit words in a P-224 field element. */
+#define FM_CRYPTO_P224_WORDS 7
+
+/** @brief Window width in bits used by the joint scalar multiplication. */
+#define FM_CRYPTO_P224_WINDOW_BITS 4
+
+/** @brief Number of multiples of a point stored in the window table. */
+#define FM_CRYPTO_P224_TABLE_SIZE (1 << FM_CRYPTO_P224_WINDOW_BITS)
+
+/** @brief Maximum number of results converted to affine with a shared inversion. */
+#define FM_CRYPTO_P224_BATCH_MAX 4
+
+/**
+ * @brief P-224 point in projective coordinates with Montgomery form elements
+ */
+typedef struct {
+	uint32_t x[FM_CRYPTO_P224_WORDS];
+	uint32_t y[FM_CRYPTO_P224_WORDS];
+	uint32_t z[FM_CRYPTO_P224_WORDS];
+} fm_crypto_p224_point;
+
+/**
+ * @brief Window table with the multiples 0 * P ... 15 * P of a point P
+ */
+typedef struct {
+	fm_crypto_p224_point t[FM_CRYPTO_P224_TABLE_SIZE];
+} fm_crypto_p224_table;
+
+/**
+ * @brief Function to prepare the window table for a given P-224 point
+ *
+ * @note The point is expected to be already validated to lie on the curve.
+ *
+ * @param[in,out]   table       Window table to populate.
+ * @param[in]       p           Point P encoded as x || y (big-endian, 56 bytes).
+ */
+void fm_crypto_p224_table_init(fm_crypto_p224_table *table, const uint8_t p[56]);
+
+/**
+ * @brief Function to compute r = u * P + v * G with a single interleaved ladder
+ *
+ * Both scalars are processed together in fixed 4-bit windows, sharing the point
+ * doublings. Table lookups and point additions run in constant time.
+ *
+ * @param[in,out]   r           Resulting point encoded as x || y (big-endian, 56 bytes).
+ * @param[in]       u           Scalar u (big-endian, 28 bytes).
+ * @param[in]       p_table     Window table of point P.
+ * @param[in]       v           Scalar v (big-endian, 28 bytes).
+ *
+ * @returns 0 on success, otherwise negative value.
+ */
+int fm_crypto_p224_twin_mult(uint8_t r[56],
+			     const uint8_t u[28],
+			     const fm_crypto_p224_table *p_table,
+			     const uint8_t v[28]);
+
+/**
+ * @brief Function to compute r[i] = u[i] * P + v[i] * G for a batch of scalar pairs
+ *
+ * Every result is computed with the same ladder as @ref fm_crypto_p224_twin_mult.
+ * The projective results are converted to affine with Montgomery's trick, so the
+ * whole batch costs a single field inversion.
+ *
+ * @param[in,out]   r           Resulting points encoded as x || y (big-endian, 56 bytes each).
+ * @param[in]       u           Scalars u (big-endian, 28 bytes each).
+ * @param[in]       p_table     Window table of point P.
+ * @param[in]       v           Scalars v (big-endian, 28 bytes each).
+ * @param[in]       count       Number of scalar pairs, at most @ref FM_CRYPTO_P224_BATCH_MAX.
+ *
+ * @returns 0 on success, otherwise negative value.
+ */
+int fm_crypto_p224_twin_mult_batch(uint8_t r[][56],
+				   const uint8_t u[][28],
+				   const fm_crypto_p224_table *p_table,
+				   const uint8_t v[][28],
+				   size_t count);
+
+#endif /* FM_CRYPTO_P224_H_ */
@@ -0,0 +1,547 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fm_crypto_p256.h"
+#include "fm_crypto_platform.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * ECDSA P-256 verification with fixed-base comb tables for both the base point
+ * G and the public key Q. The verification works on public values only, so the
+ * code below is not constant time.
+ *
+ * Field elements are stored as 8 little-endian 32-bit words. Arithmetic modulo
+ * p and modulo the group order n uses the Montgomery form with R = 2^256. Points
+ * use Jacobian coordinates (X : Y : Z) with the formulas for a = -3 from the
+ * Explicit-Formulas Database (dbl-2001-b and madd-2007-bl).
+ */
+
+#define WORDS FM_CRYPTO_P256_WORDS
+
+/* Distance in bits between the scalar bits combined by the comb table. */
+#define COMB_SPACING 64
+
+typedef uint32_t fe[WORDS];
+
+typedef struct {
+	fe x;
+	fe y;
+	fe z;
+} point;
+
+struct modulus {
+	fe m;
+	/* -m^-1 mod 2^32 */
+	uint32_t m0;
+	/* R^2 mod m */
+	fe r2;
+	/* 1 in Montgomery form (R mod m). */
+	fe one;
+};
+
+/* p = 2^256 - 2^224 + 2^192 + 2^96 - 1 */
+static const struct modulus p256_p = {
+	.m = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+	       0x00000000, 0x00000000, 0x00000001, 0xffffffff },
+	.m0 = 0x00000001,
+	.r2 = { 0x00000003, 0x00000000, 0xffffffff, 0xfffffffb,
+		0xfffffffe, 0xffffffff, 0xfffffffd, 0x00000004 },
+	.one = { 0x00000001, 0x00000000, 0x00000000, 0xffffffff,
+		 0xffffffff, 0xffffffff, 0xfffffffe, 0x00000000 },
+};
+
+/* Group order n */
+static const struct modulus p256_n = {
+	.m = { 0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad,
+	       0xffffffff, 0xffffffff, 0x00000000, 0xffffffff },
+	.m0 = 0xee00bc4f,
+	.r2 = { 0xbe79eea2, 0x83244c95, 0x49bd6fa6, 0x4699799c,
+		0x2b6bec59, 0x2845b239, 0xf3d95620, 0x66e12d94 },
+	.one = { 0x039cdaaf, 0x0c46353d, 0x58e8617b, 0x43190552,
+		 0x00000000, 0x00000000, 0xffffffff, 0x00000000 },
+};
+
+/* p - n, used for the x(R) = r + n case of the final check. */
+static const fe p256_p_minus_n = {
+	0x039cdaae, 0x0c46353d, 0x58e8617b, 0x43190553,
+	0x00000000, 0x00000000, 0x00000000, 0x00000000
+};
+
+/* Comb table of the base point G, generated with scripts/gen_p256_comb_table.py. */
+static const fm_crypto_p256_comb_table p256_g_comb_table = { .t = {
+	/* Combination 1 */
+	{ .x = { 0x18a9143c, 0x79e730d4, 0x5fedb601, 0x75ba95fc,
+		 0x77622510, 0x79fb732b, 0xa53755c6, 0x18905f76 },
+	  .y = { 0xce95560a, 0xddf25357, 0xba19e45c, 0x8b4ab8e4,
+		 0xdd21f325, 0xd2e88688, 0x25885d85, 0x8571ff18 } },
+	/* Combination 2 */
+	{ .x = { 0x16a0d2bb, 0x4f922fc5, 0x1a623499, 0x0d5cc16c,
+		 0x57c62c8b, 0x9241cf3a, 0xfd1b667f, 0x2f5e6961 },
+	  .y = { 0xf5a01797, 0x5c15c70b, 0x60956192, 0x3d20b44d,
+		 0x071fdb52, 0x04911b37, 0x8d6f0f7b, 0xf648f916 } },
+	/* Combination 3 */
+	{ .x = { 0xe137bbbc, 0x9e566847, 0x8a6a0bec, 0xe434469e,
+		 0x79d73463, 0xb1c42761, 0x133d0015, 0x5abe0285 },
+	  .y = { 0xc04c7dab, 0x92aa837c, 0x43260c07, 0x573d9f4c,
+		 0x78e6cc37, 0x0c931562, 0x6b6f7383, 0x94bb725b } },
+	/* Combination 4 */
+	{ .x = { 0xbfe20925, 0x62a8c244, 0x8fdce867, 0x91c19ac3,
+		 0xdd387063, 0x5a96a5d5, 0x21d324f6, 0x61d587d4 },
+	  .y = { 0xa37173ea, 0xe87673a2, 0x53778b65, 0x23848008,
+		 0x05bab43e, 0x10f8441e, 0x4621efbe, 0xfa11fe12 } },
+	/* Combination 5 */
+	{ .x = { 0x2cb19ffd, 0x1c891f2b, 0xb1923c23, 0x01ba8d5b,
+		 0x8ac5ca8e, 0xb6d03d67, 0x1f13bedc, 0x586eb04c },
+	  .y = { 0x27e8ed09, 0x0c35c6e5, 0x1819ede2, 0x1e81a33c,
+		 0x56c652fa, 0x278fd6c0, 0x70864f11, 0x19d5ac08 } },
+	/* Combination 6 */
+	{ .x = { 0xd2b533d5, 0x62577734, 0xa1bdddc0, 0x673b8af6,
+		 0xa79ec293, 0x577e7c9a, 0xc3b266b1, 0xbb6de651 },
+	  .y = { 0xb65259b3, 0xe7e9303a, 0xd03a7480, 0xd6a0afd3,
+		 0x9b3cfc27, 0xc5ac83d1, 0x5d18b99b, 0x60b4619a } },
+	/* Combination 7 */
+	{ .x = { 0x1ae5aa1c, 0xbd6a38e1, 0x49e73658, 0xb8b7652b,
+		 0xee5f87ed, 0x0b130014, 0xaeebffcd, 0x9d0f27b2 },
+	  .y = { 0x7a730a55, 0xca924631, 0xddbbc83a, 0x9c955b2f,
+		 0xac019a71, 0x07c1dfe0, 0x356ec48d, 0x244a566d } },
+	/* Combination 8 */
+	{ .x = { 0xf4f8b16a, 0x56f8410e, 0xc47b266a, 0x97241afe,
+		 0x6d9c87c1, 0x0a406b8e, 0xcd42ab1b, 0x803f3e02 },
+	  .y = { 0x04dbec69, 0x7f0309a8, 0x3bbad05f, 0xa83b85f7,
+		 0xad8e197f, 0xc6097273, 0x5067adc1, 0xc097440e } },
+	/* Combination 9 */
+	{ .x = { 0xc379ab34, 0x846a56f2, 0x841df8d1, 0xa8ee068b,
+		 0x176c68ef, 0x20314459, 0x915f1f30, 0xf1af32d5 },
+	  .y = { 0x5d75bd50, 0x99c37531, 0xf72f67bc, 0x837cffba,
+		 0x48d7723f, 0x0613a418, 0xe2d41c8b, 0x23d0f130 } },
+	/* Combination 10 */
+	{ .x = { 0xd5be5a2b, 0xed93e225, 0x5934f3c6, 0x6fe79983,
+		 0x22626ffc, 0x43140926, 0x7990216a, 0x50bbb4d9 },
+	  .y = { 0xe57ec63e, 0x378191c6, 0x181dcdb2, 0x65422c40,
+		 0x0236e0f6, 0x41a8099b, 0x01fe49c3, 0x2b100118 } },
+	/* Combination 11 */
+	{ .x = { 0x9b391593, 0xfc68b5c5, 0x598270fc, 0xc385f5a2,
+		 0xd19adcbb, 0x7144f3aa, 0x83fbae0c, 0xdd558999 },
+	  .y = { 0x74b82ff4, 0x93b88b8e, 0x71e734c9, 0xd2e03c40,
+		 0x43c0322a, 0x9a7a9eaf, 0x149d6041, 0xe6e4c551 } },
+	/* Combination 12 */
+	{ .x = { 0x80ec21fe, 0x5fe14bfe, 0xc255be82, 0xf6ce116a,
+		 0x2f4a5d67, 0x98bc5a07, 0xdb7e63af, 0xfad27148 },
+	  .y = { 0x29ab05b3, 0x90c0b6ac, 0x4e251ae6, 0x37a9a83c,
+		 0xc2aade7d, 0x0a7dc875, 0x9f0e1a84, 0x77387de3 } },
+	/* Combination 13 */
+	{ .x = { 0xa56c0dd7, 0x1e9ecc49, 0x46086c74, 0xa5cffcd8,
+		 0xf505aece, 0x8f7a1408, 0xbef0c47e, 0xb37b85c0 },
+	  .y = { 0xcc0e6a8f, 0x3596b6e4, 0x6b388f23, 0xfd6d4bbf,
+		 0xc39cef4e, 0xaba453fa, 0xf9f628d5, 0x9c135ac8 } },
+	/* Combination 14 */
+	{ .x = { 0x95c8f8be, 0x0a1c7294, 0x3bf362bf, 0x2961c480,
+		 0xdf63d4ac, 0x9e418403, 0x91ece900, 0xc109f9cb },
+	  .y = { 0x58945705, 0xc2d095d0, 0xddeb85c0, 0xb9083d96,
+		 0x7a40449b, 0x84692b8d, 0x2eee1ee1, 0x9bc3344f } },
+	/* Combination 15 */
+	{ .x = { 0x42913074, 0x0d5ae356, 0x48a542b1, 0x55491b27,
+		 0xb310732a, 0x469ca665, 0x5f1a4cc1, 0x29591d52 },
+	  .y = { 0xb84f983f, 0xe76f5b6b, 0x9f5f84e1, 0xbe7eef41,
+		 0x80baa189, 0x1200d496, 0x18ef332c, 0x6376551f } },
+} };
+
+static uint32_t fe_add_raw(fe r, const fe a, const fe b)
+{
+	uint64_t acc = 0;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		acc += (uint64_t)a[i] + b[i];
+		r[i] = (uint32_t)acc;
+		acc >>= 32;
+	}
+
+	return (uint32_t)acc;
+}
+
+static uint32_t fe_sub_raw(fe r, const fe a, const fe b)
+{
+	uint64_t acc;
+	uint32_t borrow = 0;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		acc = (uint64_t)a[i] - b[i] - borrow;
+		r[i] = (uint32_t)acc;
+		borrow = (uint32_t)(acc >> 32) & 1;
+	}
+
+	return borrow;
+}
+
+static int fe_cmp(const fe a, const fe b)
+{
+	for (size_t i = WORDS; i-- > 0;) {
+		if (a[i] != b[i]) {
+			return (a[i] > b[i]) ? 1 : -1;
+		}
+	}
+
+	return 0;
+}
+
+static bool fe_is_zero(const fe a)
+{
+	uint32_t acc = 0;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		acc |= a[i];
+	}
+
+	return (acc == 0);
+}
+
+/* r = a + b mod m for a, b < m */
+static void mod_add(fe r, const fe a, const fe b, const struct modulus *mod)
+{
+	uint32_t carry;
+
+	carry = fe_add_raw(r, a, b);
+	if (carry || (fe_cmp(r, mod->m) >= 0)) {
+		fe_sub_raw(r, r, mod->m);
+	}
+}
+
+/* r = a - b mod m for a, b < m */
+static void mod_sub(fe r, const fe a, const fe b, const struct modulus *mod)
+{
+	if (fe_sub_raw(r, a, b)) {
+		fe_add_raw(r, r, mod->m);
+	}
+}
+
+/* r = a * b * R^-1 mod m for a, b < m */
+static void mont_mul(fe r, const fe a, const fe b, const struct modulus *mod)
+{
+	uint32_t t[WORDS + 2] = {0};
+	uint64_t acc;
+	uint32_t q;
+
+	for (size_t i = 0; i < WORDS; i++) {
+		/* t = t + a * b[i] */
+		acc = 0;
+		for (size_t j = 0; j < WORDS; j++) {
+			acc += (uint64_t)t[j] + (uint64_t)a[j] * b[i];
+			t[j] = (uint32_t)acc;
+			acc >>= 32;
+		}
+		acc += t[WORDS];
+		t[WORDS] = (uint32_t)acc;
+		t[WORDS + 1] = (uint32_t)(acc >> 32);
+
+		q = t[0] * mod->m0;
+
+		/* t = (t + q * m) / 2^32 */
+		acc = (uint64_t)t[0] + (uint64_t)q * mod->m[0];
+		acc >>= 32;
+		for (size_t j = 1; j < WORDS; j++) {
+			acc += (uint64_t)t[j] + (uint64_t)q * mod->m[j];
+			t[j - 1] = (uint32_t)acc;
+			acc >>= 32;
+		}
+		acc += t[WORDS];
+		t[WORDS - 1] = (uint32_t)acc;
+		t[WORDS] = t[WORDS + 1] + (uint32_t)(acc >> 32);
+	}
+
+	/* The result is smaller than 2m, subtract m once if necessary. */
+	if (t[WORDS] || (fe_cmp(t, mod->m) >= 0)) {
+		fe_sub_raw(t, t, mod->m);
+	}
+
+	memcpy(r, t, sizeof(fe));
+}
+
+/* r = a^(m - 2) = a^-1 mod m, in Montgomery form */
+static void mont_inv(fe r, const fe a, const struct modulus *mod)
+{
+	fe e;
+	fe acc;
+
+	/* The lowest word of both moduli is larger than 2. */
+	memcpy(e, mod->m, sizeof(e));
+	e[0] -= 2;
+
+	memcpy(acc, mod->one, sizeof(acc));
+	for (int bit = 255; bit >= 0; bit--) {
+		mont_mul(acc, acc, acc, mod);
+		if ((e[bit / 32] >> (bit % 32)) & 1) {
+			mont_mul(acc, acc, a, mod);
+		}
+	}
+
+	memcpy(r, acc, sizeof(acc));
+}
+
+static void fe_from_bytes(fe r, const uint8_t in[32])
+{
+	for (size_t i = 0; i < WORDS; i++) {
+		const uint8_t *w = in + 4 * (WORDS - 1 - i);
+
+		r[i] = ((uint32_t)w[0] << 24) | ((uint32_t)w[1] << 16) |
+		       ((uint32_t)w[2] << 8) | (uint32_t)w[3];
+	}
+}
+
+static void point_set_infinity(point *r)
+{
+	memcpy(r->x, p256_p.one, sizeof(fe));
+	memcpy(r->y, p256_p.one, sizeof(fe));
+	memset(r->z, 0, sizeof(fe));
+}
+
+/* r = 2 * a */
+static void point_double(point *r, const point *a)
+{
+	const struct modulus *p = &p256_p;
+	fe delta, gamma, beta, alpha, t0, t1;
+
+	/* delta = Z^2, gamma = Y^2, beta = X * gamma */
+	mont_mul(delta, a->z, a->z, p);
+	mont_mul(gamma, a->y, a->y, p);
+	mont_mul(beta, a->x, gamma, p);
+
+	/* alpha = 3 * (X - delta) * (X + delta) */
+	mod_sub(t0, a->x, delta, p);
+	mod_add(t1, a->x, delta, p);
+	mont_mul(alpha, t0, t1, p);
+	mod_add(t0, alpha, alpha, p);
+	mod_add(alpha, t0, alpha, p);
+
+	/* Z3 = (Y + Z)^2 - gamma - delta */
+	mod_add(t0, a->y, a->z, p);
+	mont_mul(t0, t0, t0, p);
+	mod_sub(t0, t0, gamma, p);
+	mod_sub(r->z, t0, delta, p);
+
+	/* X3 = alpha^2 - 8 * beta */
+	mod_add(beta, beta, beta, p);
+	mod_add(beta, beta, beta, p);
+	mod_add(t1, beta, beta, p);
+	mont_mul(t0, alpha, alpha, p);
+	mod_sub(r->x, t0, t1, p);
+
+	/* Y3 = alpha * (4 * beta - X3) - 8 * gamma^2 */
+	mod_sub(t0, beta, r->x, p);
+	mont_mul(t0, alpha, t0, p);
+	mont_mul(gamma, gamma, gamma, p);
+	mod_add(gamma, gamma, gamma, p);
+	mod_add(gamma, gamma, gamma, p);
+	mod_add(gamma, gamma, gamma, p);
+	mod_sub(r->y, t0, gamma, p);
+}
+
+/* r = a + b, where b is an affine point */
+static void point_add_affine(point *r, const point *a, const fm_crypto_p256_affine *b)
+{
+	const struct modulus *p = &p256_p;
+	fe z1z1, u2, s2, h, hh, i, j, rr, v, t0;
+
+	if (fe_is_zero(a->z)) {
+		memcpy(r->x, b->x, sizeof(fe));
+		memcpy(r->y, b->y, sizeof(fe));
+		memcpy(r->z, p->one, sizeof(fe));
+		return;
+	}
+
+	/* U2 = X2 * Z1^2, S2 = Y2 * Z1^3 */
+	mont_mul(z1z1, a->z, a->z, p);
+	mont_mul(u2, b->x, z1z1, p);
+	mont_mul(s2, b->y, a->z, p);
+	mont_mul(s2, s2, z1z1, p);
+
+	/* H = U2 - X1, rr = 2 * (S2 - Y1) */
+	mod_sub(h, u2, a->x, p);
+	mod_sub(rr, s2, a->y, p);
+
+	if (fe_is_zero(h)) {
+		if (fe_is_zero(rr)) {
+			point_double(r, a);
+		} else {
+			point_set_infinity(r);
+		}
+		return;
+	}
+
+	mod_add(rr, rr, rr, p);
+
+	/* I = 4 * H^2, J = H * I, V = X1 * I */
+	mont_mul(hh, h, h, p);
+	mod_add(i, hh, hh, p);
+	mod_add(i, i, i, p);
+	mont_mul(j, h, i, p);
+	mont_mul(v, a->x, i, p);
+
+	/* Z3 = (Z1 + H)^2 - Z1Z1 - HH */
+	mod_add(t0, a->z, h, p);
+	mont_mul(t0, t0, t0, p);
+	mod_sub(t0, t0, z1z1, p);
+	mod_sub(r->z, t0, hh, p);
+
+	/* 2 * Y1 * J is needed for Y3 before Y1 can be overwritten. */
+	mont_mul(t0, a->y, j, p);
+	mod_add(t0, t0, t0, p);
+
+	/* X3 = rr^2 - J - 2 * V */
+	mont_mul(i, rr, rr, p);
+	mod_sub(i, i, j, p);
+	mod_sub(i, i, v, p);
+	mod_sub(r->x, i, v, p);
+
+	/* Y3 = rr * (V - X3) - 2 * Y1 * J */
+	mod_sub(v, v, r->x, p);
+	mont_mul(v, rr, v, p);
+	mod_sub(r->y, v, t0, p);
+}
+
+static void point_to_affine(fm_crypto_p256_affine *r, const point *a)
+{
+	const struct modulus *p = &p256_p;
+	fe z_inv;
+	fe z_inv2;
+
+	mont_inv(z_inv, a->z, p);
+	mont_mul(z_inv2, z_inv, z_inv, p);
+	mont_mul(r->x, a->x, z_inv2, p);
+	mont_mul(z_inv2, z_inv2, z_inv, p);
+	mont_mul(r->y, a->y, z_inv2, p);
+}
+
+void fm_crypto_p256_comb_table_init(fm_crypto_p256_comb_table *table, const uint8_t q[64])
+{
+	const struct modulus *p = &p256_p;
+	fm_crypto_p256_affine teeth[FM_CRYPTO_P256_COMB_TEETH];
+	point acc;
+
+	/* teeth[j] = 2^(64 * j) * Q */
+	fe_from_bytes(teeth[0].x, q);
+	fe_from_bytes(teeth[0].y, q + 32);
+	mont_mul(teeth[0].x, teeth[0].x, p->r2, p);
+	mont_mul(teeth[0].y, teeth[0].y, p->r2, p);
+
+	for (size_t j = 1; j < FM_CRYPTO_P256_COMB_TEETH; j++) {
+		point_set_infinity(&acc);
+		point_add_affine(&acc, &acc, &teeth[j - 1]);
+		for (size_t i = 0; i < COMB_SPACING; i++) {
+			point_double(&acc, &acc);
+		}
+		point_to_affine(&teeth[j], &acc);
+	}
+
+	/* Entry b - 1 = entry of b without its top bit + the tooth of the top bit. */
+	for (size_t b = 1; b <= FM_CRYPTO_P256_COMB_SIZE; b++) {
+		size_t top = FM_CRYPTO_P256_COMB_TEETH - 1;
+		size_t rest;
+
+		while (!(b & (1 << top))) {
+			top--;
+		}
+		rest = b & ~(1 << top);
+
+		if (rest == 0) {
+			table->t[b - 1] = teeth[top];
+			continue;
+		}
+
+		point_set_infinity(&acc);
+		point_add_affine(&acc, &acc, &table->t[rest - 1]);
+		point_add_affine(&acc, &acc, &teeth[top]);
+		point_to_affine(&table->t[b - 1], &acc);
+	}
+}
+
+static uint32_t comb_index(const fe k, size_t bit)
+{
+	uint32_t index = 0;
+
+	for (size_t j = 0; j < FM_CRYPTO_P256_COMB_TEETH; j++) {
+		size_t pos = bit + j * COMB_SPACING;
+
+		index |= ((k[pos / 32] >> (pos % 32)) & 1) << j;
+	}
+
+	return index;
+}
+
+int fm_crypto_p256_verify_hash(const uint8_t sig[64],
+			       const uint8_t hash[32],
+			       const fm_crypto_p256_comb_table *q_table)
+{
+	const struct modulus *p = &p256_p;
+	const struct modulus *n = &p256_n;
+	fe r, s, e, w, u1, u2, zz, t;
+	point acc;
+	uint32_t index;
+
+	fe_from_bytes(r, sig);
+	fe_from_bytes(s, sig + 32);
+
+	/* Both r and s must be in the range [1, n - 1]. */
+	if (fe_is_zero(r) || fe_is_zero(s) ||
+	    (fe_cmp(r, n->m) >= 0) || (fe_cmp(s, n->m) >= 0)) {
+		return FMN_ERROR_CRYPTO_INVALID_INPUT;
+	}
+
+	/* e = H(m) mod n, the hash is smaller than 2n. */
+	fe_from_bytes(e, hash);
+	if (fe_cmp(e, n->m) >= 0) {
+		fe_sub_raw(e, e, n->m);
+	}
+
+	/* w = s^-1 (Montgomery form), u1 = e * w, u2 = r * w (normal form) */
+	mont_mul(w, s, n->r2, n);
+	mont_inv(w, w, n);
+	mont_mul(u1, e, w, n);
+	mont_mul(u2, r, w, n);
+
+	/* R = u1 * G + u2 * Q with the shared doublings of both combs. */
+	point_set_infinity(&acc);
+	for (size_t bit = COMB_SPACING; bit-- > 0;) {
+		point_double(&acc, &acc);
+
+		index = comb_index(u1, bit);
+		if (index) {
+			point_add_affine(&acc, &acc, &p256_g_comb_table.t[index - 1]);
+		}
+
+		index = comb_index(u2, bit);
+		if (index) {
+			point_add_affine(&acc, &acc, &q_table->t[index - 1]);
+		}
+	}
+
+	if (fe_is_zero(acc.z)) {
+		return FMN_ERROR_CRYPTO_INVALID_INPUT;
+	}
+
+	/* Check x(R) = r mod n without the inversion: X == r * Z^2 mod p. Since
+	 * n < p, x(R) may also be equal to r + n if r + n < p.
+	 */
+	mont_mul(zz, acc.z, acc.z, p);
+
+	mont_mul(t, r, p->r2, p);
+	mont_mul(t, t, zz, p);
+	if (fe_cmp(t, acc.x) == 0) {
+		return FMN_ERROR_CRYPTO_OK;
+	}
+
+	if (fe_cmp(r, p256_p_minus_n) < 0) {
+		fe_add_raw(r, r, n->m);
+		mont_mul(t, r, p->r2, p);
+		mont_mul(t, t, zz, p);
+		if (fe_cmp(t, acc.x) == 0) {
+			return FMN_ERROR_CRYPTO_OK;
+		}
+	}
+
+	return FMN_ERROR_CRYPTO_INVALID_INPUT;
+}
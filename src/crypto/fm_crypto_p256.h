@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FM_CRYPTO_P256_H_
+#define FM_CRYPTO_P256_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Number of 32-bit words in a P-256 field element. */
+#define FM_CRYPTO_P256_WORDS 8
+
+/** @brief Number of points combined by the comb table. */
+#define FM_CRYPTO_P256_COMB_TEETH 4
+
+/** @brief Number of non-zero entries in the comb table. */
+#define FM_CRYPTO_P256_COMB_SIZE ((1 << FM_CRYPTO_P256_COMB_TEETH) - 1)
+
+/**
+ * @brief P-256 point in affine coordinates with Montgomery form elements
+ */
+typedef struct {
+	uint32_t x[FM_CRYPTO_P256_WORDS];
+	uint32_t y[FM_CRYPTO_P256_WORDS];
+} fm_crypto_p256_affine;
+
+/**
+ * @brief Comb table of a point Q
+ *
+ * Entry b - 1 holds the sum of 2^(64 * j) * Q over the bits j set in b,
+ * for b = 1 ... 15. The table can be generated offline with
+ * scripts/gen_p256_comb_table.py.
+ */
+typedef struct {
+	fm_crypto_p256_affine t[FM_CRYPTO_P256_COMB_SIZE];
+} fm_crypto_p256_comb_table;
+
+/**
+ * @brief Function to prepare the comb table for a given P-256 point at runtime
+ *
+ * @note The point is expected to be already validated to lie on the curve.
+ *
+ * @param[in,out]   table       Comb table to populate.
+ * @param[in]       q           Point Q encoded as x || y (big-endian, 64 bytes).
+ */
+void fm_crypto_p256_comb_table_init(fm_crypto_p256_comb_table *table, const uint8_t q[64]);
+
+/**
+ * @brief Function to verify an ECDSA P-256 signature over a SHA-256 hash
+ *
+ * The public key is given by its comb table only. The verification works on
+ * public data and does not run in constant time.
+ *
+ * @param[in]       sig         Signature encoded as r || s (big-endian, 64 bytes).
+ * @param[in]       hash        SHA-256 hash of the signed message (32 bytes).
+ * @param[in]       q_table     Comb table of the public key Q.
+ *
+ * @returns 0 if the signature is valid, otherwise negative value.
+ */
+int fm_crypto_p256_verify_hash(const uint8_t sig[64],
+			       const uint8_t hash[32],
+			       const fm_crypto_p256_comb_table *q_table);
+
+#endif /* FM_CRYPTO_P256_H_ */
@@ -11,10 +11,14 @@
 #include <stddef.h>
 
 #include <ocrypto_curve_p256.h>
+#include <ocrypto_hmac_sha256.h>
 #include <ocrypto_curve_p224.h>
 #include <ocrypto_sc_p256.h>
 #include <ocrypto_sc_p224.h>
 
+#include "fm_crypto_p224.h"
+#include "fm_crypto_p256.h"
+
 /** @brief Dummy type definition of byte */
 typedef uint8_t byte;
 
@@ -83,4 +87,29 @@ typedef struct fm_crypto_ckg_context {
 	ecc_point p;
 } *fm_crypto_ckg_context_t;
 
+/**
+ * @brief Type definition for the master public key P imported once after pairing
+ */
+typedef struct fm_crypto_master_pk {
+	ecc_point p;
+	fm_crypto_p224_table p_table;
+} *fm_crypto_master_pk_t;
+
+/**
+ * @brief Type definition for a P-256 ephemeral key pair generated ahead of an encryption
+ */
+typedef struct fm_crypto_ephemeral_key {
+	ecc_key q;
+} *fm_crypto_ephemeral_key_t;
+
+/**
+ * @brief Type definition for the HMAC-SHA256 state keyed with KSN
+ *
+ * The context holds the inner pad midstate, so each authentication only
+ * hashes the message and the outer pad.
+ */
+typedef struct fm_crypto_ksn_hmac {
+	ocrypto_hmac_sha256_ctx hmac;
+} *fm_crypto_ksn_hmac_t;
+
 #endif /* FM_CRYPTO_PLATFORM_H_ */
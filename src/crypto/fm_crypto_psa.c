@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <string.h>
+
+#include <psa/crypto.h>
+
+#include "fm_crypto_backend.h"
+
+#include <ocrypto_constant_time.h>
+
+#define LOG_MODULE_NAME fmna_crypto_psa
+#include "crypto_log.h"
+
+#define P256_PUB_KEY_LEN 65
+
+static int psa_to_fmn_error(psa_status_t status)
+{
+	if (status == PSA_SUCCESS) {
+		return FMN_ERROR_CRYPTO_OK;
+	}
+
+	LOG_DBG("PSA error: %d", status);
+
+	return FMN_ERROR_CRYPTO_DEFAULT;
+}
+
+static psa_status_t p256_key_import(psa_key_id_t *key_id,
+				    psa_key_type_t type,
+				    psa_key_usage_t usage,
+				    psa_algorithm_t alg,
+				    const uint8_t *data,
+				    size_t data_len)
+{
+	psa_status_t status;
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+	/* psa_crypto_init does nothing once the library is initialized. */
+	status = psa_crypto_init();
+	if (status != PSA_SUCCESS) {
+		return status;
+	}
+
+	psa_set_key_type(&attr, type);
+	psa_set_key_bits(&attr, 256);
+	psa_set_key_usage_flags(&attr, usage);
+	psa_set_key_algorithm(&attr, alg);
+	psa_set_key_lifetime(&attr, PSA_KEY_LIFETIME_VOLATILE);
+
+	status = psa_import_key(&attr, data, data_len, key_id);
+	psa_reset_key_attributes(&attr);
+
+	return status;
+}
+
+static psa_status_t aes_key_import(psa_key_id_t *key_id,
+				   psa_key_usage_t usage,
+				   const uint8_t key[16])
+{
+	psa_status_t status;
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+	status = psa_crypto_init();
+	if (status != PSA_SUCCESS) {
+		return status;
+	}
+
+	psa_set_key_type(&attr, PSA_KEY_TYPE_AES);
+	psa_set_key_bits(&attr, 128);
+	psa_set_key_usage_flags(&attr, usage);
+	psa_set_key_algorithm(&attr, PSA_ALG_GCM);
+	psa_set_key_lifetime(&attr, PSA_KEY_LIFETIME_VOLATILE);
+
+	status = psa_import_key(&attr, key, 16, key_id);
+	psa_reset_key_attributes(&attr);
+
+	return status;
+}
+
+int fm_crypto_psa_sha256_v(byte out[32],
+			   const struct fm_crypto_iovec *msg_iov,
+			   word32 msg_iovcnt)
+{
+	psa_status_t status;
+	psa_hash_operation_t op = PSA_HASH_OPERATION_INIT;
+	size_t hash_len;
+
+	status = psa_crypto_init();
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	status = psa_hash_setup(&op, PSA_ALG_SHA_256);
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		status = psa_hash_update(&op, msg_iov[i].data, msg_iov[i].nbytes);
+		if (status != PSA_SUCCESS) {
+			psa_hash_abort(&op);
+			return psa_to_fmn_error(status);
+		}
+	}
+
+	status = psa_hash_finish(&op, out, 32, &hash_len);
+	if (status != PSA_SUCCESS) {
+		psa_hash_abort(&op);
+	}
+
+	return psa_to_fmn_error(status);
+}
+
+int fm_crypto_psa_p256_ecdh(byte secret[32], const byte sk[32], const byte pk[64])
+{
+	psa_status_t status;
+	psa_key_id_t key_id;
+	uint8_t peer[P256_PUB_KEY_LEN];
+	size_t secret_len;
+
+	status = p256_key_import(&key_id,
+				 PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1),
+				 PSA_KEY_USAGE_DERIVE,
+				 PSA_ALG_ECDH,
+				 sk, 32);
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	/* PSA expects the uncompressed point format. */
+	peer[0] = 0x04;
+	memcpy(peer + 1, pk, 64);
+
+	status = psa_raw_key_agreement(PSA_ALG_ECDH, key_id, peer, sizeof(peer),
+				       secret, 32, &secret_len);
+
+	psa_destroy_key(key_id);
+
+	if (status != PSA_SUCCESS) {
+		ocrypto_constant_time_fill_zero(secret, 32);
+	}
+
+	return psa_to_fmn_error(status);
+}
+
+int fm_crypto_psa_p256_ecdsa_verify_hash(const byte sig[64],
+					 const byte hash[32],
+					 const byte pk[64])
+{
+	psa_status_t status;
+	psa_key_id_t key_id;
+	uint8_t pub[P256_PUB_KEY_LEN];
+
+	pub[0] = 0x04;
+	memcpy(pub + 1, pk, 64);
+
+	status = p256_key_import(&key_id,
+				 PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_FAMILY_SECP_R1),
+				 PSA_KEY_USAGE_VERIFY_HASH,
+				 PSA_ALG_ECDSA(PSA_ALG_SHA_256),
+				 pub, sizeof(pub));
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	status = psa_verify_hash(key_id, PSA_ALG_ECDSA(PSA_ALG_SHA_256), hash, 32, sig, 64);
+
+	psa_destroy_key(key_id);
+
+	return psa_to_fmn_error(status);
+}
+
+int fm_crypto_psa_aes128gcm_encrypt_v(const byte key[16],
+				      const byte iv[16],
+				      const struct fm_crypto_iovec *msg_iov,
+				      word32 msg_iovcnt,
+				      byte *out,
+				      byte tag[16])
+{
+	psa_status_t status;
+	psa_key_id_t key_id;
+	psa_aead_operation_t op = PSA_AEAD_OPERATION_INIT;
+	size_t msg_nbytes = 0;
+	size_t pos = 0;
+	size_t ct_len;
+	size_t tag_len;
+
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		msg_nbytes += msg_iov[i].nbytes;
+	}
+
+	status = aes_key_import(&key_id, PSA_KEY_USAGE_ENCRYPT, key);
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	status = psa_aead_encrypt_setup(&op, key_id, PSA_ALG_GCM);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	status = psa_aead_set_nonce(&op, iv, 16);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	/* The ciphertext written by each call may lag behind the input. It never
+	 * gets ahead of it, so a fragment that is encrypted in place is read
+	 * before it is overwritten.
+	 */
+	for (word32 i = 0; i < msg_iovcnt; i++) {
+		status = psa_aead_update(&op, msg_iov[i].data, msg_iov[i].nbytes,
+					 out + pos, msg_nbytes - pos, &ct_len);
+		if (status != PSA_SUCCESS) {
+			goto error;
+		}
+
+		pos += ct_len;
+	}
+
+	status = psa_aead_finish(&op, out + pos, msg_nbytes - pos, &ct_len, tag, 16, &tag_len);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	psa_destroy_key(key_id);
+
+	return 0;
+
+error:
+	psa_aead_abort(&op);
+	psa_destroy_key(key_id);
+	return psa_to_fmn_error(status);
+}
+
+int fm_crypto_psa_aes128gcm_decrypt(const byte key[16],
+				    const byte iv[16],
+				    word32 ct_nbytes,
+				    const byte *ct,
+				    const byte tag[16],
+				    byte *out)
+{
+	psa_status_t status;
+	psa_key_id_t key_id;
+	psa_aead_operation_t op = PSA_AEAD_OPERATION_INIT;
+	size_t pt_len;
+	size_t pt_tail_len;
+
+	status = aes_key_import(&key_id, PSA_KEY_USAGE_DECRYPT, key);
+	if (status != PSA_SUCCESS) {
+		return psa_to_fmn_error(status);
+	}
+
+	status = psa_aead_decrypt_setup(&op, key_id, PSA_ALG_GCM);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	status = psa_aead_set_nonce(&op, iv, 16);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	status = psa_aead_update(&op, ct, ct_nbytes, out, ct_nbytes, &pt_len);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	status = psa_aead_verify(&op, out + pt_len, ct_nbytes - pt_len, &pt_tail_len, tag, 16);
+	if (status != PSA_SUCCESS) {
+		goto error;
+	}
+
+	psa_destroy_key(key_id);
+
+	return 0;
+
+error:
+	psa_aead_abort(&op);
+	psa_destroy_key(key_id);
+	return psa_to_fmn_error(status);
+}
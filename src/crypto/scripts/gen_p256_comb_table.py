@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+#
+
+"""Generate the P-256 comb table used by fm_crypto_p256_verify_hash.
+
+The table holds the 15 non-zero combinations of the points
+Q, 2^64 * Q, 2^128 * Q and 2^192 * Q in affine coordinates, with both
+coordinates in the Montgomery form (R = 2^256) and stored as 8 little-endian
+32-bit words. The output is a C initializer of fm_crypto_p256_comb_table.
+
+Usage:
+    gen_p256_comb_table.py <name> <65-byte uncompressed point in hex>
+    gen_p256_comb_table.py <name> G
+"""
+
+import argparse
+import sys
+
+P = 2**256 - 2**224 + 2**192 + 2**96 - 1
+B = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+GX = 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296
+GY = 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5
+
+R = 2**256
+TEETH = 4
+SPACING = 64
+
+
+def point_add(p1, p2):
+    if p1 is None:
+        return p2
+    if p2 is None:
+        return p1
+    x1, y1 = p1
+    x2, y2 = p2
+    if x1 == x2:
+        if (y1 + y2) % P == 0:
+            return None
+        lam = (3 * x1 * x1 - 3) * pow(2 * y1, -1, P) % P
+    else:
+        lam = (y2 - y1) * pow(x2 - x1, -1, P) % P
+    x3 = (lam * lam - x1 - x2) % P
+    return (x3, (lam * (x1 - x3) - y1) % P)
+
+
+def point_double_n(p, n):
+    for _ in range(n):
+        p = point_add(p, p)
+    return p
+
+
+def comb_table(q):
+    teeth = [point_double_n(q, SPACING * j) for j in range(TEETH)]
+    table = []
+    for b in range(1, 2**TEETH):
+        acc = None
+        for j in range(TEETH):
+            if b & (1 << j):
+                acc = point_add(acc, teeth[j])
+        table.append(acc)
+    return table
+
+
+def words(v):
+    v = v * R % P
+    return ["0x%08x" % ((v >> (32 * i)) & 0xFFFFFFFF) for i in range(8)]
+
+
+def emit(name, table):
+    out = ["const fm_crypto_p256_comb_table %s = { .t = {" % name]
+    for b, (x, y) in enumerate(table, start=1):
+        xw = words(x)
+        yw = words(y)
+        out.append("\t/* Combination %d */" % b)
+        out.append("\t{ .x = { %s," % ", ".join(xw[:4]))
+        out.append("\t\t %s }," % ", ".join(xw[4:]))
+        out.append("\t  .y = { %s," % ", ".join(yw[:4]))
+        out.append("\t\t %s } }," % ", ".join(yw[4:]))
+    out.append("} };")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("name", help="Name of the generated C variable")
+    parser.add_argument("point", help="Uncompressed point (04 || x || y) in hex, or G")
+    args = parser.parse_args()
+
+    if args.point == "G":
+        q = (GX, GY)
+    else:
+        raw = bytes.fromhex(args.point)
+        if len(raw) != 65 or raw[0] != 0x04:
+            sys.exit("The point must be 65 bytes long and start with 0x04")
+        q = (int.from_bytes(raw[1:33], "big"), int.from_bytes(raw[33:], "big"))
+        if (q[1] ** 2 - (q[0] ** 3 - 3 * q[0] + B)) % P != 0:
+            sys.exit("The point is not on the P-256 curve")
+
+    print(emit(args.name, comb_table(q)))
+
+
+if __name__ == "__main__":
+    main()
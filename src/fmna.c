@@ -7,6 +7,7 @@
 #include "fmna_adv.h"
 #include "fmna_battery.h"
 #include "fmna_conn.h"
+#include "fmna_ecies_key_pool.h"
 #include "fmna_gatt_ais.h"
 #include "fmna_gatt_fmns.h"
 #include "fmna_keys.h"
@@ -302,6 +303,14 @@ int fmna_enable(const struct fmna_enable_param *param,
 		goto error;
 	}
 
+	if (IS_ENABLED(CONFIG_FMNA_ECIES_KEY_POOL)) {
+		err = fmna_ecies_key_pool_start();
+		if (err) {
+			LOG_ERR("fmna_ecies_key_pool_start returned error: %d", err);
+			goto error;
+		}
+	}
+
 	if (IS_ENABLED(CONFIG_FMNA_SERVICE_HIDDEN_MODE)) {
 		err = fmna_gatt_services_hidden_mode_set(false);
 		if (err) {
@@ -389,6 +398,11 @@ int fmna_disable(void)
 		}
 	}
 
+	if (IS_ENABLED(CONFIG_FMNA_ECIES_KEY_POOL)) {
+		/* Zeroize the pre-generated ephemeral keys. */
+		fmna_ecies_key_pool_stop();
+	}
+
 	/* Allow the API user to enable the FMN stack with the fmna_enable. */
 	atomic_clear_bit(flags, FMNA_ENABLE);
 
@@ -74,13 +74,31 @@ union adv_payload {
 	struct separated_adv_payload separated;
 };
 
+enum paired_adv_type {
+	PAIRED_ADV_TYPE_NONE,
+	PAIRED_ADV_TYPE_NEARBY,
+	PAIRED_ADV_TYPE_SEPARATED,
+};
+
+/* Encoded paired advertising payload and address together with the
+ * configuration and the battery state that they were encoded from.
+ */
+struct paired_adv_buf {
+	enum paired_adv_type type;
+	union {
+		struct fmna_adv_nearby_config nearby;
+		struct fmna_adv_separated_config separated;
+	} config;
+	enum fmna_battery_state battery_state;
+	bt_addr_le_t addr;
+	union adv_payload payload;
+};
+
 struct adv_start_config {
 	struct {
 		const struct bt_data *payload;
 		size_t len;
 	} ad;
-	const struct bt_le_ext_adv_cb *cb;
-
 	uint32_t interval;
 	uint16_t timeout;
 };
@@ -89,6 +107,14 @@ static uint8_t bt_id;
 static union adv_payload adv_payload;
 static struct bt_le_ext_adv *adv_set = NULL;
 
+/* The buffer that is not in use holds the payload prepared for the next key
+ * rotation. The buffers are swapped when the advertising is restarted.
+ */
+static struct paired_adv_buf paired_adv_bufs[2];
+static uint8_t paired_adv_buf_active;
+static uint32_t adv_set_interval;
+static bool adv_set_param_stale;
+
 static int bt_ext_advertising_tx_power_set(uint16_t handle, int8_t *tx_power)
 {
 	int err;
@@ -136,14 +162,6 @@ int fmna_adv_stop(void)
 			LOG_ERR("bt_le_ext_adv_stop returned error: %d", err);
 			return err;
 		}
-
-		err = bt_le_ext_adv_delete(adv_set);
-		if (err) {
-			LOG_ERR("bt_le_ext_adv_delete returned error: %d", err);
-			return err;
-		}
-
-		adv_set = NULL;
 	}
 
 	return 0;
@@ -154,44 +172,39 @@ static int bt_ext_advertising_start(const struct adv_start_config *config)
 	int err;
 	struct bt_le_adv_param param = {0};
 	struct bt_le_ext_adv_start_param ext_adv_start_param = {0};
-	uint8_t adv_handle;
 
-	if (adv_set) {
-		LOG_ERR("Advertising set is already claimed");
-		return -EAGAIN;
+	if (!adv_set) {
+		LOG_ERR("Advertising set is not created");
+		return -ENOENT;
 	}
 
-	param.id = bt_id;
-	param.options = BT_LE_ADV_OPT_CONNECTABLE | BT_LE_ADV_OPT_USE_IDENTITY;
-	param.interval_min = config->interval;
-	param.interval_max = config->interval;
+	/* The advertising set is updated in place. Its parameters are only
+	 * written again when the interval or the identity address has changed.
+	 */
+	if (adv_set_param_stale || (adv_set_interval != config->interval)) {
+		param.id = bt_id;
+		param.options = BT_LE_ADV_OPT_CONNECTABLE | BT_LE_ADV_OPT_USE_IDENTITY;
+		param.interval_min = config->interval;
+		param.interval_max = config->interval;
 
-	ext_adv_start_param.timeout = config->timeout;
+		err = bt_le_ext_adv_update_param(adv_set, &param);
+		if (err) {
+			LOG_ERR("bt_le_ext_adv_update_param returned error: %d", err);
+			return err;
+		}
 
-	err = bt_le_ext_adv_create(&param, config->cb, &adv_set);
-	if (err) {
-		LOG_ERR("bt_le_ext_adv_create returned error: %d", err);
-		return err;
+		adv_set_interval = config->interval;
+		adv_set_param_stale = false;
 	}
 
+	ext_adv_start_param.timeout = config->timeout;
+
 	err = bt_le_ext_adv_set_data(adv_set, config->ad.payload, config->ad.len, NULL, 0);
 	if (err) {
 		LOG_ERR("bt_le_ext_adv_set_data returned error: %d", err);
 		return err;
 	}
 
-	err = bt_hci_get_adv_handle(adv_set, &adv_handle);
-	if (err) {
-		LOG_ERR("bt_hci_get_adv_handle returned error: %d", err);
-		return err;
-	}
-
-	err = bt_ext_advertising_tx_power_set(adv_handle, NULL);
-	if (err) {
-		LOG_ERR("bt_ext_advertising_tx_power_set returned error: %d", err);
-		return err;
-	}
-
 	err = bt_le_ext_adv_start(adv_set, &ext_adv_start_param);
 	if (err) {
 		LOG_ERR("bt_le_ext_adv_start returned error: %d", err);
@@ -215,6 +228,9 @@ static int id_addr_reconfigure(bt_addr_le_t *addr)
 		return ret;
 	}
 
+	/* The advertising set still uses the previous identity address. */
+	adv_set_param_stale = true;
+
 	if (addr) {
 		bt_addr_le_to_str(addr, addr_str, sizeof(addr_str));
 		LOG_INF("FMN identity address reconfigured to: %s",
@@ -299,39 +315,44 @@ static void paired_adv_header_encode(struct paired_adv_payload_header *hdr,
 	hdr->len = (payload_len - sizeof(*hdr));
 }
 
-static void nearby_adv_payload_encode(struct nearby_adv_payload *adv_payload,
-				      const struct fmna_adv_nearby_config *config)
+static bool paired_adv_buf_match(const struct paired_adv_buf *buf,
+				 enum paired_adv_type type,
+				 const void *config,
+				 size_t config_len)
 {
-	uint8_t opt;
-	enum fmna_battery_state battery_state;
-
-	memset(adv_payload, 0, sizeof(*adv_payload));
+	return ((buf->type == type) &&
+		(buf->battery_state == fmna_battery_state_get()) &&
+		(memcmp(&buf->config, config, config_len) == 0));
+}
 
-	paired_adv_header_encode(&adv_payload->hdr, sizeof(*adv_payload));
+/* Find the buffer that is already encoded from the configuration. The buffer
+ * prepared for the next key rotation is checked first.
+ */
+static uint8_t paired_adv_buf_find(enum paired_adv_type type,
+				   const void *config,
+				   size_t config_len)
+{
+	uint8_t next = paired_adv_buf_active ^ 1;
 
-	battery_state = fmna_battery_state_get();
+	if (paired_adv_buf_match(&paired_adv_bufs[next], type, config, config_len)) {
+		return next;
+	}
 
-	if (config->is_maintained) {
-		adv_payload->status |= BIT(PAIRED_ADV_STATUS_MAINTAINED_BIT_POS);
+	if (paired_adv_buf_match(&paired_adv_bufs[paired_adv_buf_active],
+				 type, config, config_len)) {
+		return paired_adv_buf_active;
 	}
-	adv_payload->status |= BIT(PAIRED_ADV_STATUS_FIXED_BIT_POS);
-	adv_payload->status |= (battery_state << PAIRED_ADV_STATUS_BATTERY_STATE_BIT_POS) &
-		PAIRED_ADV_STATUS_BATTERY_STATE_MASK;
 
-	opt = (config->primary_key[0] & PAIRED_ADV_OPT_ADDR_TYPE_MASK);
-	opt = (opt >> PAIRED_ADV_OPT_ADDR_TYPE_BIT_POS);
-	adv_payload->opt = opt;
+	return ARRAY_SIZE(paired_adv_bufs);
 }
 
-int fmna_adv_start_nearby(const struct fmna_adv_nearby_config *config)
+static int paired_adv_start(uint8_t buf_index, size_t payload_len, uint32_t interval)
 {
-	static const struct bt_data nearby_ad[] = {
-		BT_DATA(BT_DATA_MANUFACTURER_DATA, (uint8_t *) &adv_payload,
-			sizeof(struct nearby_adv_payload)),
-	};
-
 	int err;
-	bt_addr_le_t addr;
+	struct paired_adv_buf *buf = &paired_adv_bufs[buf_index];
+	const struct bt_data paired_ad[] = {
+		BT_DATA(BT_DATA_MANUFACTURER_DATA, (uint8_t *) &buf->payload, payload_len),
+	};
 	struct adv_start_config start_config = {0};
 
 	/* Stop any ongoing advertising. */
@@ -341,47 +362,106 @@ int fmna_adv_start_nearby(const struct fmna_adv_nearby_config *config)
 		return err;
 	}
 
-	nearby_adv_payload_encode(&adv_payload.nearby, config);
-
 	/*
 	 * Reconfigure the BT address after coming back from the Separated
-	 * state. Each address reconfiguration changes the BLE identity and
-	 * removes BLE bonds.
+	 * state. Each address reconfiguration changes the BLE identity address
+	 * and removes BLE bonds.
 	 */
-	paired_addr_encode(&addr, config->primary_key);
-	err = id_addr_reconfigure(&addr);
+	err = id_addr_reconfigure(&buf->addr);
 	if (err) {
 		LOG_ERR("id_addr_reconfigure returned error: %d", err);
 		return err;
 	}
 
-	start_config.ad.payload = nearby_ad;
-	start_config.ad.len = ARRAY_SIZE(nearby_ad);
-	start_config.interval = config->fast_mode ?
-		PAIRED_ADV_INTERVAL_FAST : PAIRED_ADV_INTERVAL;
+	start_config.ad.payload = paired_ad;
+	start_config.ad.len = ARRAY_SIZE(paired_ad);
+	start_config.interval = interval;
 	err = bt_ext_advertising_start(&start_config);
 	if (err) {
 		LOG_ERR("bt_ext_advertising_start returned error: %d", err);
 		return err;
 	}
 
+	paired_adv_buf_active = buf_index;
+
+	return 0;
+}
+
+static void nearby_adv_payload_encode(struct nearby_adv_payload *adv_payload,
+				      const struct fmna_adv_nearby_config *config,
+				      enum fmna_battery_state battery_state)
+{
+	uint8_t opt;
+
+	memset(adv_payload, 0, sizeof(*adv_payload));
+
+	paired_adv_header_encode(&adv_payload->hdr, sizeof(*adv_payload));
+
+	if (config->is_maintained) {
+		adv_payload->status |= BIT(PAIRED_ADV_STATUS_MAINTAINED_BIT_POS);
+	}
+	adv_payload->status |= BIT(PAIRED_ADV_STATUS_FIXED_BIT_POS);
+	adv_payload->status |= (battery_state << PAIRED_ADV_STATUS_BATTERY_STATE_BIT_POS) &
+		PAIRED_ADV_STATUS_BATTERY_STATE_MASK;
+
+	opt = (config->primary_key[0] & PAIRED_ADV_OPT_ADDR_TYPE_MASK);
+	opt = (opt >> PAIRED_ADV_OPT_ADDR_TYPE_BIT_POS);
+	adv_payload->opt = opt;
+}
+
+static void nearby_adv_buf_encode(struct paired_adv_buf *buf,
+				  const struct fmna_adv_nearby_config *config)
+{
+	buf->type = PAIRED_ADV_TYPE_NEARBY;
+	buf->battery_state = fmna_battery_state_get();
+	memcpy(&buf->config.nearby, config, sizeof(*config));
+
+	nearby_adv_payload_encode(&buf->payload.nearby, config, buf->battery_state);
+	paired_addr_encode(&buf->addr, config->primary_key);
+}
+
+int fmna_adv_prepare_nearby(const struct fmna_adv_nearby_config *config)
+{
+	nearby_adv_buf_encode(&paired_adv_bufs[paired_adv_buf_active ^ 1], config);
+
+	return 0;
+}
+
+int fmna_adv_start_nearby(const struct fmna_adv_nearby_config *config)
+{
+	int err;
+	uint8_t buf_index;
+
+	buf_index = paired_adv_buf_find(PAIRED_ADV_TYPE_NEARBY, config, sizeof(*config));
+	if (buf_index == ARRAY_SIZE(paired_adv_bufs)) {
+		buf_index = paired_adv_buf_active ^ 1;
+		nearby_adv_buf_encode(&paired_adv_bufs[buf_index], config);
+	} else {
+		LOG_DBG("Using the prepared Nearby advertising payload");
+	}
+
+	err = paired_adv_start(buf_index, sizeof(struct nearby_adv_payload),
+			       config->fast_mode ? PAIRED_ADV_INTERVAL_FAST : PAIRED_ADV_INTERVAL);
+	if (err) {
+		LOG_ERR("paired_adv_start returned error: %d", err);
+		return err;
+	}
+
 	LOG_INF("FMN advertising started for the Nearby state");
 
 	return 0;
 }
 
 static void separated_adv_payload_encode(struct separated_adv_payload *adv_payload,
-					 const struct fmna_adv_separated_config *config)
+					 const struct fmna_adv_separated_config *config,
+					 enum fmna_battery_state battery_state)
 {
 	uint8_t opt;
-	enum fmna_battery_state battery_state;
 
 	memset(adv_payload, 0, sizeof(*adv_payload));
 
 	paired_adv_header_encode(&adv_payload->hdr, sizeof(*adv_payload));
 
-	battery_state = fmna_battery_state_get();
-
 	if (config->is_maintained) {
 		adv_payload->status |= BIT(PAIRED_ADV_STATUS_MAINTAINED_BIT_POS);
 	}
@@ -400,45 +480,41 @@ static void separated_adv_payload_encode(struct separated_adv_payload *adv_paylo
 	adv_payload->hint = config->primary_key[SEPARATED_ADV_HINT_INDEX];
 }
 
-int fmna_adv_start_separated(const struct fmna_adv_separated_config *config)
+static void separated_adv_buf_encode(struct paired_adv_buf *buf,
+				     const struct fmna_adv_separated_config *config)
 {
-	static const struct bt_data separated_ad[] = {
-		BT_DATA(BT_DATA_MANUFACTURER_DATA, (uint8_t *) &adv_payload,
-			sizeof(struct separated_adv_payload)),
-	};
+	buf->type = PAIRED_ADV_TYPE_SEPARATED;
+	buf->battery_state = fmna_battery_state_get();
+	memcpy(&buf->config.separated, config, sizeof(*config));
 
-	int err;
-	bt_addr_le_t addr;
-	struct adv_start_config start_config = {0};
+	separated_adv_payload_encode(&buf->payload.separated, config, buf->battery_state);
+	paired_addr_encode(&buf->addr, config->separated_key);
+}
 
-	/* Stop any ongoing advertising. */
-	err = fmna_adv_stop();
-	if (err) {
-		LOG_ERR("fmna_adv_stop returned error: %d", err);
-		return err;
-	}
+int fmna_adv_prepare_separated(const struct fmna_adv_separated_config *config)
+{
+	separated_adv_buf_encode(&paired_adv_bufs[paired_adv_buf_active ^ 1], config);
 
-	separated_adv_payload_encode(&adv_payload.separated, config);
+	return 0;
+}
 
-	/*
-	 * Reconfigure the BT address after coming back from the Separated
-	 * state. Each address reconfiguration changes the BLE identity and
-	 * removes BLE bonds.
-	 */
-	paired_addr_encode(&addr, config->separated_key);
-	err = id_addr_reconfigure(&addr);
-	if (err) {
-		LOG_ERR("id_addr_reconfigure returned error: %d", err);
-		return err;
+int fmna_adv_start_separated(const struct fmna_adv_separated_config *config)
+{
+	int err;
+	uint8_t buf_index;
+
+	buf_index = paired_adv_buf_find(PAIRED_ADV_TYPE_SEPARATED, config, sizeof(*config));
+	if (buf_index == ARRAY_SIZE(paired_adv_bufs)) {
+		buf_index = paired_adv_buf_active ^ 1;
+		separated_adv_buf_encode(&paired_adv_bufs[buf_index], config);
+	} else {
+		LOG_DBG("Using the prepared Separated advertising payload");
 	}
 
-	start_config.ad.payload = separated_ad;
-	start_config.ad.len = ARRAY_SIZE(separated_ad);
-	start_config.interval = config->fast_mode ?
-		PAIRED_ADV_INTERVAL_FAST : PAIRED_ADV_INTERVAL;
-	err = bt_ext_advertising_start(&start_config);
+	err = paired_adv_start(buf_index, sizeof(struct separated_adv_payload),
+			       config->fast_mode ? PAIRED_ADV_INTERVAL_FAST : PAIRED_ADV_INTERVAL);
 	if (err) {
-		LOG_ERR("bt_ext_advertising_start returned error: %d", err);
+		LOG_ERR("paired_adv_start returned error: %d", err);
 		return err;
 	}
 
@@ -447,33 +523,32 @@ int fmna_adv_start_separated(const struct fmna_adv_separated_config *config)
 	return 0;
 }
 
-static int bt_ext_advertising_tx_power_verify(uint8_t id)
+static int adv_set_create(void)
 {
-#if CONFIG_LOG
 	int err;
 	int del_err;
 	int8_t tx_power;
 	uint8_t adv_handle;
-	struct bt_le_ext_adv *tx_adv_set = NULL;
 	struct bt_le_adv_param param = {
-		.id = id,
+		.id = bt_id,
 		.options = BT_LE_ADV_OPT_CONNECTABLE | BT_LE_ADV_OPT_USE_IDENTITY,
 		.interval_min = UNPAIRED_ADV_INTERVAL,
 		.interval_max = UNPAIRED_ADV_INTERVAL,
 	};
 
-	err = bt_le_ext_adv_create(&param, NULL, &tx_adv_set);
+	err = bt_le_ext_adv_create(&param, NULL, &adv_set);
 	if (err) {
 		LOG_ERR("bt_le_ext_adv_create returned error: %d", err);
 		return err;
 	}
 
-	err = bt_hci_get_adv_handle(tx_adv_set, &adv_handle);
+	err = bt_hci_get_adv_handle(adv_set, &adv_handle);
 	if (err) {
 		LOG_ERR("bt_hci_get_adv_handle returned error: %d", err);
 		goto error;
 	}
 
+	/* The TX power is kept by the controller for the lifetime of the set. */
 	err = bt_ext_advertising_tx_power_set(adv_handle, &tx_power);
 	if (err) {
 		LOG_ERR("bt_ext_advertising_tx_power_set returned error: %d", err);
@@ -486,16 +561,20 @@ static int bt_ext_advertising_tx_power_verify(uint8_t id)
 			CONFIG_BOARD, tx_power, CONFIG_FMNA_TX_POWER);
 	}
 
+	adv_set_interval = UNPAIRED_ADV_INTERVAL;
+	adv_set_param_stale = false;
+
+	return 0;
+
 error:
-	del_err = bt_le_ext_adv_delete(tx_adv_set);
+	del_err = bt_le_ext_adv_delete(adv_set);
 	if (del_err) {
 		LOG_ERR("bt_le_ext_adv_delete returned error: %d", del_err);
 	}
 
-	return ((err != 0) ? err : del_err);
-#else
-	return 0;
-#endif /* CONFIG_LOG */
+	adv_set = NULL;
+
+	return err;
 }
 
 int fmna_adv_init(uint8_t id)
@@ -515,9 +594,9 @@ int fmna_adv_init(uint8_t id)
 		return id;
 	}
 
-	err = bt_ext_advertising_tx_power_verify(id);
+	err = adv_set_create();
 	if (err) {
-		LOG_ERR("TX power verification failed: %d", err);
+		LOG_ERR("adv_set_create returned error: %d", err);
 		return err;
 	}
 
@@ -534,6 +613,18 @@ int fmna_adv_uninit(void)
 		return err;
 	}
 
+	if (adv_set) {
+		err = bt_le_ext_adv_delete(adv_set);
+		if (err) {
+			LOG_ERR("bt_le_ext_adv_delete returned error: %d", err);
+			return err;
+		}
+
+		adv_set = NULL;
+	}
+
+	memset(paired_adv_bufs, 0, sizeof(paired_adv_bufs));
+
 	LOG_INF("Stopping advertising");
 
 	return 0;
@@ -36,6 +36,14 @@ int fmna_adv_start_nearby(const struct fmna_adv_nearby_config *config);
 
 int fmna_adv_start_separated(const struct fmna_adv_separated_config *config);
 
+/* Encode the Nearby or Separated payload and address ahead of the next key
+ * rotation. The next start call with the same configuration only swaps in
+ * the prepared payload.
+ */
+int fmna_adv_prepare_nearby(const struct fmna_adv_nearby_config *config);
+
+int fmna_adv_prepare_separated(const struct fmna_adv_separated_config *config);
+
 int fmna_adv_init(uint8_t id);
 
 int fmna_adv_uninit(void);
@@ -7,6 +7,7 @@
 #include "events/fmna_config_event.h"
 #include "events/fmna_event.h"
 #include "fmna_conn.h"
+#include "fmna_link.h"
 #include "fmna_state.h"
 #include "fmna_gatt_fmns.h"
 
@@ -130,6 +131,14 @@ static void connected(struct bt_conn *conn, uint8_t conn_err)
 	fmna_conn->is_valid = true;
 	bt_conn_ref(conn);
 
+	/* The owner is known once the link is encrypted with its key. */
+	if (IS_ENABLED(CONFIG_FMNA_LINK_OPTIMIZER) && !fmna_state_is_paired()) {
+		err = fmna_link_use_set(conn, FMNA_LINK_USE_PAIRING);
+		if (err) {
+			LOG_ERR("fmna_link_use_set returned error: %d", err);
+		}
+	}
+
 	FMNA_EVENT_CREATE(event, FMNA_EVENT_PEER_CONNECTED, conn);
 	APP_EVENT_SUBMIT(event);
 }
@@ -152,6 +161,10 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 
 	fmna_conn->is_disconnecting = true;
 
+	if (IS_ENABLED(CONFIG_FMNA_LINK_OPTIMIZER)) {
+		fmna_link_disconnected(conn);
+	}
+
 	bt_conn_unref(conn);
 
 	FMNA_EVENT_CREATE(event, FMNA_EVENT_PEER_DISCONNECTED, conn);
@@ -173,6 +186,14 @@ static void security_changed(struct bt_conn *conn, bt_security_t level,
 			addr, level, err);
 	} else {
 		LOG_DBG("FMN Peer security changed: %s level %u", addr, level);
+
+		if (IS_ENABLED(CONFIG_FMNA_LINK_OPTIMIZER) && fmna_state_is_paired()) {
+			int link_err = fmna_link_use_set(conn, FMNA_LINK_USE_OWNER);
+
+			if (link_err) {
+				LOG_ERR("fmna_link_use_set returned error: %d", link_err);
+			}
+		}
 	}
 
 	FMNA_EVENT_CREATE(event, FMNA_EVENT_PEER_SECURITY_CHANGED, conn);
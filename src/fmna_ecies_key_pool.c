@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fmna_ecies_key_pool.h"
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
+
+#define POOL_DEPTH     CONFIG_FMNA_ECIES_KEY_POOL_DEPTH
+#define POOL_WATERMARK CONFIG_FMNA_ECIES_KEY_POOL_WATERMARK
+
+#define POOL_THREAD_PRIORITY							\
+	(CONFIG_FMNA_ECIES_KEY_POOL_THREAD_PRIORITY < CONFIG_NUM_PREEMPT_PRIORITIES ? \
+	 CONFIG_FMNA_ECIES_KEY_POOL_THREAD_PRIORITY : CONFIG_NUM_PREEMPT_PRIORITIES - 1)
+
+BUILD_ASSERT(POOL_WATERMARK < POOL_DEPTH,
+	     "The refill watermark must be lower than the pool depth");
+
+static K_MSGQ_DEFINE(pool_msgq, sizeof(struct fm_crypto_ephemeral_key), POOL_DEPTH, 4);
+
+static struct fmna_ecies_key_pool_stats stats = {
+	.depth = POOL_DEPTH,
+	.watermark = POOL_WATERMARK,
+};
+static bool is_running;
+
+static K_MUTEX_DEFINE(pool_mutex);
+static K_SEM_DEFINE(pool_sem, 0, 1);
+
+static void pool_fill(void)
+{
+	int err;
+	struct fm_crypto_ephemeral_key key;
+
+	while (true) {
+		k_mutex_lock(&pool_mutex, K_FOREVER);
+		if (!is_running || (k_msgq_num_free_get(&pool_msgq) == 0)) {
+			k_mutex_unlock(&pool_mutex);
+			break;
+		}
+		k_mutex_unlock(&pool_mutex);
+
+		/* Generate the key without holding the lock. */
+		err = fm_crypto_ephemeral_key_generate(&key);
+		if (err) {
+			LOG_ERR("FMN ECIES key pool: fm_crypto_ephemeral_key_generate "
+				"returned error: %d", err);
+			break;
+		}
+
+		k_mutex_lock(&pool_mutex, K_FOREVER);
+		if (is_running) {
+			(void) k_msgq_put(&pool_msgq, &key, K_NO_WAIT);
+		}
+		k_mutex_unlock(&pool_mutex);
+	}
+
+	memset(&key, 0, sizeof(key));
+}
+
+static void pool_thread_entry_point(void *arg0, void *arg1, void *arg2)
+{
+	while (true) {
+		k_sem_take(&pool_sem, K_FOREVER);
+		pool_fill();
+	}
+}
+
+K_THREAD_DEFINE(fmna_ecies_key_pool_thread, CONFIG_FMNA_ECIES_KEY_POOL_THREAD_STACK_SIZE,
+		pool_thread_entry_point, NULL, NULL, NULL,
+		POOL_THREAD_PRIORITY, 0, 0);
+
+static void pool_clear(void)
+{
+	k_msgq_purge(&pool_msgq);
+	memset(pool_msgq.buffer_start, 0, pool_msgq.buffer_end - pool_msgq.buffer_start);
+}
+
+int fmna_ecies_key_pool_start(void)
+{
+	k_mutex_lock(&pool_mutex, K_FOREVER);
+	is_running = true;
+	k_mutex_unlock(&pool_mutex);
+
+	k_sem_give(&pool_sem);
+
+	LOG_DBG("FMN ECIES key pool: started");
+
+	return 0;
+}
+
+int fmna_ecies_key_pool_encrypt_to_server_v(const uint8_t pub[65],
+					    const struct fm_crypto_iovec *msg_iov,
+					    uint32_t msg_iovcnt,
+					    uint32_t *out_len,
+					    uint8_t *out)
+{
+	int err;
+	struct fm_crypto_ephemeral_key key;
+
+	k_mutex_lock(&pool_mutex, K_FOREVER);
+
+	err = k_msgq_get(&pool_msgq, &key, K_NO_WAIT);
+	if (err) {
+		stats.misses++;
+
+		LOG_DBG("FMN ECIES key pool: empty, generating the ephemeral key inline "
+			"(hits: %u, misses: %u)", stats.hits, stats.misses);
+	} else {
+		stats.hits++;
+
+		LOG_DBG("FMN ECIES key pool: %u keys left (hits: %u, misses: %u)",
+			k_msgq_num_used_get(&pool_msgq), stats.hits, stats.misses);
+	}
+
+	if (is_running && (k_msgq_num_used_get(&pool_msgq) <= POOL_WATERMARK)) {
+		/* Refill the pool in the background. */
+		k_sem_give(&pool_sem);
+	}
+
+	k_mutex_unlock(&pool_mutex);
+
+	if (err) {
+		return fm_crypto_encrypt_to_server_v(pub, msg_iov, msg_iovcnt, out_len, out);
+	}
+
+	/* The ephemeral key is zeroized by the encryption. */
+	return fm_crypto_encrypt_to_server_v_with_key(&key, pub, msg_iov, msg_iovcnt,
+						      out_len, out);
+}
+
+int fmna_ecies_key_pool_encrypt_to_server(const uint8_t pub[65],
+					  uint32_t msg_len,
+					  const uint8_t *msg,
+					  uint32_t *out_len,
+					  uint8_t *out)
+{
+	const struct fm_crypto_iovec msg_iov = {
+		.data = msg,
+		.nbytes = msg_len,
+	};
+
+	return fmna_ecies_key_pool_encrypt_to_server_v(pub, &msg_iov, 1, out_len, out);
+}
+
+void fmna_ecies_key_pool_stats_get(struct fmna_ecies_key_pool_stats *pool_stats)
+{
+	k_mutex_lock(&pool_mutex, K_FOREVER);
+
+	*pool_stats = stats;
+	pool_stats->available = k_msgq_num_used_get(&pool_msgq);
+
+	k_mutex_unlock(&pool_mutex);
+}
+
+void fmna_ecies_key_pool_stop(void)
+{
+	k_mutex_lock(&pool_mutex, K_FOREVER);
+
+	is_running = false;
+	pool_clear();
+
+	k_mutex_unlock(&pool_mutex);
+
+	LOG_DBG("FMN ECIES key pool: stopped");
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FMNA_ECIES_KEY_POOL_H_
+#define FMNA_ECIES_KEY_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+
+#include "crypto/fm_crypto.h"
+
+struct fmna_ecies_key_pool_stats {
+	/* Number of ephemeral keys the pool can hold. */
+	uint32_t depth;
+
+	/* Number of remaining keys that triggers a refill. */
+	uint32_t watermark;
+
+	/* Number of ephemeral keys currently in the pool. */
+	uint32_t available;
+
+	/* Encryptions that used a pre-generated ephemeral key. */
+	uint32_t hits;
+
+	/* Encryptions that had to generate the ephemeral key inline. */
+	uint32_t misses;
+};
+
+/* Start generating ephemeral keys in the background. */
+int fmna_ecies_key_pool_start(void);
+
+/* Encrypt a message to the server with an ephemeral key taken from the pool.
+ * The key is generated inline if the pool is empty. Each key is used only once.
+ */
+int fmna_ecies_key_pool_encrypt_to_server(const uint8_t pub[65],
+					  uint32_t msg_len,
+					  const uint8_t *msg,
+					  uint32_t *out_len,
+					  uint8_t *out);
+
+/* Variant of fmna_ecies_key_pool_encrypt_to_server for a message given as
+ * a list of fragments. See fm_crypto_encrypt_to_server_v.
+ */
+int fmna_ecies_key_pool_encrypt_to_server_v(const uint8_t pub[65],
+					    const struct fm_crypto_iovec *msg_iov,
+					    uint32_t msg_iovcnt,
+					    uint32_t *out_len,
+					    uint8_t *out);
+
+/* Get the pool configuration and usage statistics. */
+void fmna_ecies_key_pool_stats_get(struct fmna_ecies_key_pool_stats *stats);
+
+/* Stop the background generation and zeroize the pooled keys. */
+void fmna_ecies_key_pool_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* FMNA_ECIES_KEY_POOL_H_ */
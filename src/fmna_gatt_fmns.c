@@ -14,6 +14,7 @@
 
 #include "events/fmna_pair_event.h"
 
+#include <zephyr/bluetooth/att.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/conn.h>
@@ -107,16 +108,49 @@ enum debug_cp_opcode {
 };
 
 struct ind_packet {
-	void *fifo_reserved;
-	struct bt_conn *conn;
+	sys_snode_t node;
 	const struct bt_gatt_attr *attr;
+	uint32_t timestamp;
 	uint16_t opcode;
 	uint8_t data[FMNA_GATT_PKT_MAX_LEN];
 	uint16_t len;
 };
 
-static K_FIFO_DEFINE(fifo_ind_data);
-NET_BUF_SIMPLE_DEFINE_STATIC(cp_ind_buf, FMNA_GATT_PKT_MAX_LEN);
+#if CONFIG_FMNA_GATT_EATT
+#define CP_IND_CTX_CNT CONFIG_FMNA_GATT_EATT_IND_CNT
+#else
+#define CP_IND_CTX_CNT 1
+#endif
+
+/* Control point message in flight. Its fragments are sent one after
+ * another, each one once the previous one is confirmed.
+ */
+struct cp_ind_ctx {
+	struct bt_gatt_indicate_params params;
+	const struct bt_gatt_attr *attr;
+	struct net_buf_simple buf;
+	uint8_t buf_data[FMNA_GATT_PKT_MAX_LEN];
+	uint32_t timestamp;
+	bool in_flight;
+};
+
+/* Indication state of a connection. Each peer has its own messages in flight
+ * and its own queue so that a slow peer does not delay the indications to
+ * the other peers. Messages of different control points are sent in parallel
+ * when the peer opened Enhanced ATT bearers.
+ */
+struct cp_ind_conn {
+	struct cp_ind_ctx ctxs[CP_IND_CTX_CNT];
+	sys_slist_t queue;
+	struct fmna_gatt_ind_stats stats;
+};
+
+static struct cp_ind_conn cp_ind_conns[CONFIG_BT_MAX_CONN];
+static struct k_spinlock cp_ind_lock;
+
+K_MEM_SLAB_DEFINE_STATIC(ind_packet_slab, ROUND_UP(sizeof(struct ind_packet), 4),
+			 CONFIG_FMNA_GATT_IND_QUEUE_SIZE, 4);
+static struct fmna_gatt_ind_pool_stats ind_pool_stats;
 
 static void pairing_cp_ccc_cfg_changed(const struct bt_gatt_attr *attr,
 				       uint16_t value)
@@ -836,55 +870,253 @@ static struct bt_gatt_service fmns_svc = BT_GATT_SERVICE(fmns_svc_attrs);
 BT_GATT_SERVICE_DEFINE(fmns_svc, FMNA_ATTRS);
 #endif
 
-static int cp_indicate(struct bt_conn *conn,
-		       const struct bt_gatt_attr *attr,
+static struct cp_ind_conn *cp_ind_conn_get(struct bt_conn *conn)
+{
+	return &cp_ind_conns[bt_conn_index(conn)];
+}
+
+static void cp_ind_ctx_release(struct cp_ind_ctx *ctx)
+{
+	k_spinlock_key_t key;
+
+	net_buf_simple_init_with_data(&ctx->buf, ctx->buf_data, sizeof(ctx->buf_data));
+	net_buf_simple_reset(&ctx->buf);
+
+	key = k_spin_lock(&cp_ind_lock);
+	ctx->attr = NULL;
+	ctx->in_flight = false;
+	k_spin_unlock(&cp_ind_lock, key);
+}
+
+/* Number of messages that can be in flight on the connection: one for each
+ * Enhanced ATT bearer and one for the unenhanced bearer.
+ */
+static size_t cp_ind_bearer_cnt(struct bt_conn *conn)
+{
+#if CONFIG_FMNA_GATT_EATT
+	return 1 + bt_eatt_count(conn);
+#else
+	return 1;
+#endif
+}
+
+static bool cp_ind_attr_queued(struct cp_ind_conn *ind_conn, const struct bt_gatt_attr *attr)
+{
+	struct ind_packet *ind_packet;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ind_conn->queue, ind_packet, node) {
+		if (ind_packet->attr == attr) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Claim a context for a message of the control point. Must be called with
+ * cp_ind_lock held. A control point has at most one message in flight so
+ * that the peer receives its messages in order.
+ */
+static struct cp_ind_ctx *cp_ind_ctx_claim(struct bt_conn *conn,
+					   struct cp_ind_conn *ind_conn,
+					   const struct bt_gatt_attr *attr)
+{
+	struct cp_ind_ctx *free_ctx = NULL;
+	uint32_t in_flight_cnt = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(ind_conn->ctxs); i++) {
+		struct cp_ind_ctx *ctx = &ind_conn->ctxs[i];
+
+		if (ctx->in_flight) {
+			if (ctx->attr == attr) {
+				return NULL;
+			}
+
+			in_flight_cnt++;
+		} else if (!free_ctx) {
+			free_ctx = ctx;
+		}
+	}
+
+	if (!free_ctx || in_flight_cnt >= cp_ind_bearer_cnt(conn)) {
+		return NULL;
+	}
+
+	free_ctx->attr = attr;
+	free_ctx->in_flight = true;
+
+	in_flight_cnt++;
+	ind_conn->stats.in_flight_max = MAX(ind_conn->stats.in_flight_max, in_flight_cnt);
+
+	return free_ctx;
+}
+
+static struct ind_packet *ind_packet_alloc(void)
+{
+	int err;
+	void *block;
+	k_spinlock_key_t key;
+
+	err = k_mem_slab_alloc(&ind_packet_slab, &block, K_NO_WAIT);
+
+	key = k_spin_lock(&cp_ind_lock);
+	if (err) {
+		ind_pool_stats.alloc_failures++;
+		block = NULL;
+	} else {
+		ind_pool_stats.used = k_mem_slab_num_used_get(&ind_packet_slab);
+		ind_pool_stats.used_max = MAX(ind_pool_stats.used_max, ind_pool_stats.used);
+	}
+	k_spin_unlock(&cp_ind_lock, key);
+
+	return block;
+}
+
+static void ind_packet_free(struct ind_packet *ind_packet)
+{
+	k_spinlock_key_t key;
+
+	k_mem_slab_free(&ind_packet_slab, ind_packet);
+
+	key = k_spin_lock(&cp_ind_lock);
+	ind_pool_stats.used = k_mem_slab_num_used_get(&ind_packet_slab);
+	k_spin_unlock(&cp_ind_lock, key);
+}
+
+/* Take the first queued message that can be sent now, together with the
+ * context claimed for it.
+ */
+static struct ind_packet *cp_ind_queue_get(struct bt_conn *conn,
+					   struct cp_ind_conn *ind_conn,
+					   struct cp_ind_ctx **ctx)
+{
+	struct ind_packet *ind_packet;
+	k_spinlock_key_t key = k_spin_lock(&cp_ind_lock);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ind_conn->queue, ind_packet, node) {
+		*ctx = cp_ind_ctx_claim(conn, ind_conn, ind_packet->attr);
+		if (*ctx) {
+			sys_slist_find_and_remove(&ind_conn->queue, &ind_packet->node);
+			ind_conn->stats.queue_depth--;
+
+			k_spin_unlock(&cp_ind_lock, key);
+			return ind_packet;
+		}
+	}
+
+	k_spin_unlock(&cp_ind_lock, key);
+
+	return NULL;
+}
+
+static void cp_ind_cb(struct bt_conn *conn, struct bt_gatt_indicate_params *params, uint8_t err);
+
+static int cp_ind_send(struct bt_conn *conn,
+		       struct cp_ind_ctx *ctx,
 		       uint16_t opcode,
-		       struct net_buf_simple *buf);
+		       const uint8_t *data,
+		       uint16_t len)
+{
+	int err;
+	uint8_t *ind_data;
+	uint16_t ind_data_len;
+
+	/* Initialize buffer for sending. */
+	net_buf_simple_init_with_data(&ctx->buf, ctx->buf_data, sizeof(ctx->buf_data));
+	net_buf_simple_reset(&ctx->buf);
+	net_buf_simple_reserve(&ctx->buf, FMNA_GATT_PKT_HEADER_LEN);
+	net_buf_simple_add_le16(&ctx->buf, opcode);
+	net_buf_simple_add_mem(&ctx->buf, data, len);
 
-static void cp_ind_queue_process(void)
+	ind_data = fmna_gatt_pkt_manager_chunk_prepare(conn, &ctx->buf, &ind_data_len);
+	if (!ind_data) {
+		LOG_ERR("fmna_gatt_pkt_manager_chunk_prepare failed");
+
+		cp_ind_ctx_release(ctx);
+		return -EINVAL;
+	}
+
+	memset(&ctx->params, 0, sizeof(ctx->params));
+	ctx->params.attr = ctx->attr;
+	ctx->params.func = cp_ind_cb;
+	ctx->params.data = ind_data;
+	ctx->params.len = ind_data_len;
+
+	err = bt_gatt_indicate(conn, &ctx->params);
+	if (err) {
+		LOG_ERR("bt_gatt_indicate returned error: %d", err);
+
+		cp_ind_ctx_release(ctx);
+		return err;
+	}
+
+	return 0;
+}
+
+static void cp_ind_queue_process(struct bt_conn *conn)
 {
 	int err;
 	struct ind_packet *ind_packet;
-	NET_BUF_SIMPLE_DEFINE(data_buf, FMNA_GATT_PKT_MAX_LEN);
+	struct cp_ind_ctx *ctx;
+	struct cp_ind_conn *ind_conn = cp_ind_conn_get(conn);
 
-	ind_packet = k_fifo_get(&fifo_ind_data, K_NO_WAIT);
+	ind_packet = cp_ind_queue_get(conn, ind_conn, &ctx);
 	while (ind_packet) {
 		LOG_INF("FMN GATT: Processing indication queue");
 
-		net_buf_simple_reset(&data_buf);
-		net_buf_simple_add_mem(&data_buf, ind_packet->data, ind_packet->len);
-
-		err = cp_indicate(ind_packet->conn,
-				  ind_packet->attr,
-				  ind_packet->opcode,
-				  &data_buf);
-		k_free(ind_packet);
+		/* The latency is measured from the moment of queuing. */
+		ctx->timestamp = ind_packet->timestamp;
 
+		err = cp_ind_send(conn, ctx, ind_packet->opcode, ind_packet->data,
+				  ind_packet->len);
 		if (err) {
-			LOG_ERR("FMN GATT: cp_indicate returned error: %d", err);
-
-			ind_packet = k_fifo_get(&fifo_ind_data, K_NO_WAIT);
-		} else {
-			return;
+			LOG_ERR("FMN GATT: cp_ind_send returned error: %d", err);
 		}
+
+		ind_packet_free(ind_packet);
+
+		ind_packet = cp_ind_queue_get(conn, ind_conn, &ctx);
 	}
 }
 
+static void cp_ind_latency_record(struct cp_ind_conn *ind_conn, struct cp_ind_ctx *ctx)
+{
+	uint32_t latency = k_uptime_get_32() - ctx->timestamp;
+	k_spinlock_key_t key = k_spin_lock(&cp_ind_lock);
+
+	ind_conn->stats.latency_last_ms = latency;
+	ind_conn->stats.latency_max_ms = MAX(ind_conn->stats.latency_max_ms, latency);
+	ind_conn->stats.sent++;
+
+	k_spin_unlock(&cp_ind_lock, key);
+}
+
 static void cp_ind_cb(struct bt_conn *conn, struct bt_gatt_indicate_params *params, uint8_t err)
 {
 	uint8_t *ind_data;
 	uint16_t ind_data_len;
+	struct cp_ind_conn *ind_conn = cp_ind_conn_get(conn);
+	struct cp_ind_ctx *ctx = CONTAINER_OF(params, struct cp_ind_ctx, params);
 
 	LOG_INF("Received FMN CP indication ACK with status: 0x%04X", err);
 
-	ind_data = fmna_gatt_pkt_manager_chunk_prepare(conn, &cp_ind_buf, &ind_data_len);
+	if (err) {
+		/* Drop the rest of the message, the peer did not confirm the fragment. */
+		cp_ind_ctx_release(ctx);
+
+		cp_ind_queue_process(conn);
+		return;
+	}
+
+	ind_data = fmna_gatt_pkt_manager_chunk_prepare(conn, &ctx->buf, &ind_data_len);
 	if (!ind_data) {
 		/* Release the buffer when there is not more data
 		 * to be sent for the whole packet transmission.
 		 */
-		net_buf_simple_reset(&cp_ind_buf);
+		cp_ind_latency_record(ind_conn, ctx);
+		cp_ind_ctx_release(ctx);
 
-		cp_ind_queue_process();
+		cp_ind_queue_process(conn);
 	} else {
 		params->data = ind_data;
 		params->len = ind_data_len;
@@ -892,6 +1124,10 @@ static void cp_ind_cb(struct bt_conn *conn, struct bt_gatt_indicate_params *para
 		err = bt_gatt_indicate(conn, params);
 		if (err) {
 			LOG_ERR("bt_gatt_indicate returned error: %d", err);
+
+			cp_ind_ctx_release(ctx);
+
+			cp_ind_queue_process(conn);
 		}
 	}
 }
@@ -901,67 +1137,110 @@ static int cp_indicate(struct bt_conn *conn,
 		       uint16_t opcode,
 		       struct net_buf_simple *buf)
 {
-	if (net_buf_simple_headroom(&cp_ind_buf) != 0) {
-		/* Indication sending in progress. Queue the next item. */
-		struct ind_packet *ind_packet;
+	k_spinlock_key_t key;
+	struct cp_ind_ctx *ctx = NULL;
+	struct ind_packet *ind_packet;
+	struct cp_ind_conn *ind_conn = cp_ind_conn_get(conn);
 
-		if (buf->len > sizeof(ind_packet->data)) {
-			return -ENOMEM;
-		}
+	key = k_spin_lock(&cp_ind_lock);
+	if (!cp_ind_attr_queued(ind_conn, attr)) {
+		ctx = cp_ind_ctx_claim(conn, ind_conn, attr);
+	}
+	k_spin_unlock(&cp_ind_lock, key);
 
-		ind_packet = k_malloc(sizeof(*ind_packet));
-		if (!ind_packet) {
-			return -ENOMEM;
-		}
+	if (ctx) {
+		ctx->timestamp = k_uptime_get_32();
 
-		ind_packet->conn = conn;
-		ind_packet->attr = attr;
-		ind_packet->opcode = opcode;
-		ind_packet->len = buf->len;
-		memcpy(ind_packet->data, buf->data, buf->len);
+		return cp_ind_send(conn, ctx, opcode, buf->data, buf->len);
+	}
 
-		k_fifo_put(&fifo_ind_data, ind_packet);
+	/* Indication sending in progress. Queue the next item. */
+	if (buf->len > sizeof(ind_packet->data)) {
+		return -ENOMEM;
+	}
 
-		LOG_INF("FMN GATT: Adding indication to the queue");
+	ind_packet = ind_packet_alloc();
+	if (!ind_packet) {
+		LOG_WRN("FMN GATT: Indication queue is full");
+		return -ENOMEM;
+	}
 
-		return 0;
-	} else {
-		int err;
-		uint8_t *ind_data;
-		uint16_t ind_data_len;
+	ind_packet->attr = attr;
+	ind_packet->timestamp = k_uptime_get_32();
+	ind_packet->opcode = opcode;
+	ind_packet->len = buf->len;
+	memcpy(ind_packet->data, buf->data, buf->len);
 
-		static struct bt_gatt_indicate_params indicate_params;
+	key = k_spin_lock(&cp_ind_lock);
+	sys_slist_append(&ind_conn->queue, &ind_packet->node);
+	ind_conn->stats.queue_depth++;
+	ind_conn->stats.queue_depth_max = MAX(ind_conn->stats.queue_depth_max,
+					      ind_conn->stats.queue_depth);
+	k_spin_unlock(&cp_ind_lock, key);
 
-		/* Initialize buffer for sending. */
-		net_buf_simple_reset(&cp_ind_buf);
-		net_buf_simple_reserve(&cp_ind_buf, FMNA_GATT_PKT_HEADER_LEN);
-		net_buf_simple_add_le16(&cp_ind_buf, opcode);
-		net_buf_simple_add_mem(&cp_ind_buf, buf->data, buf->len);
+	LOG_INF("FMN GATT: Adding indication to the queue");
 
-		ind_data = fmna_gatt_pkt_manager_chunk_prepare(conn, &cp_ind_buf, &ind_data_len);
-		if (!ind_data) {
-			LOG_ERR("fmna_gatt_pkt_manager_chunk_prepare failed");
+	/* A message may have been confirmed since the context was claimed. */
+	cp_ind_queue_process(conn);
 
-			net_buf_simple_reset(&cp_ind_buf);
-			return -EINVAL;
-		}
+	return 0;
+}
 
-		memset(&indicate_params, 0, sizeof(indicate_params));
-		indicate_params.attr = attr;
-		indicate_params.func = cp_ind_cb;
-		indicate_params.data = ind_data;
-		indicate_params.len = ind_data_len;
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	sys_snode_t *node;
+	k_spinlock_key_t key;
+	struct cp_ind_conn *ind_conn = cp_ind_conn_get(conn);
 
-		err = bt_gatt_indicate(conn, &indicate_params);
-		if (err) {
-			LOG_ERR("bt_gatt_indicate returned error: %d", err);
+	/* Drop the indications that were not sent to the peer. */
+	key = k_spin_lock(&cp_ind_lock);
+	node = sys_slist_get(&ind_conn->queue);
+	k_spin_unlock(&cp_ind_lock, key);
 
-			net_buf_simple_reset(&cp_ind_buf);
-			return err;
-		}
+	while (node) {
+		ind_packet_free(CONTAINER_OF(node, struct ind_packet, node));
 
-		return 0;
+		key = k_spin_lock(&cp_ind_lock);
+		node = sys_slist_get(&ind_conn->queue);
+		k_spin_unlock(&cp_ind_lock, key);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(ind_conn->ctxs); i++) {
+		cp_ind_ctx_release(&ind_conn->ctxs[i]);
 	}
+
+	memset(&ind_conn->stats, 0, sizeof(ind_conn->stats));
+}
+
+BT_CONN_CB_DEFINE(fmns_conn_callbacks) = {
+	.disconnected = disconnected,
+};
+
+int fmna_gatt_ind_stats_get(struct bt_conn *conn, struct fmna_gatt_ind_stats *stats)
+{
+	k_spinlock_key_t key;
+	struct cp_ind_conn *ind_conn;
+
+	if (!conn || !stats) {
+		return -EINVAL;
+	}
+
+	ind_conn = cp_ind_conn_get(conn);
+
+	key = k_spin_lock(&cp_ind_lock);
+	*stats = ind_conn->stats;
+	k_spin_unlock(&cp_ind_lock, key);
+
+	return 0;
+}
+
+void fmna_gatt_ind_pool_stats_get(struct fmna_gatt_ind_pool_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&cp_ind_lock);
+
+	*stats = ind_pool_stats;
+
+	k_spin_unlock(&cp_ind_lock, key);
 }
 
 int fmna_gatt_pairing_cp_indicate(struct bt_conn *conn,
@@ -71,6 +71,39 @@ enum fmna_gatt_response_status {
 	FMNA_GATT_RESPONSE_STATUS_INVALID_COMMAND       = 0xFFFF,
 };
 
+struct fmna_gatt_ind_stats {
+	/* Indications waiting behind the ones in flight. */
+	uint32_t queue_depth;
+
+	/* Largest number of waiting indications. */
+	uint32_t queue_depth_max;
+
+	/* Time from the indication request to the confirmation of its last
+	 * fragment for the last indication and the slowest one.
+	 */
+	uint32_t latency_last_ms;
+	uint32_t latency_max_ms;
+
+	/* Indications confirmed by the peer. */
+	uint32_t sent;
+
+	/* Largest number of indications sent in parallel on the Enhanced ATT
+	 * bearers. It is 1 when only the unenhanced bearer is used.
+	 */
+	uint32_t in_flight_max;
+};
+
+struct fmna_gatt_ind_pool_stats {
+	/* Queued indications currently stored in the pool. */
+	uint32_t used;
+
+	/* Largest number of queued indications stored in the pool. */
+	uint32_t used_max;
+
+	/* Indications rejected because the pool was exhausted. */
+	uint32_t alloc_failures;
+};
+
 int fmna_gatt_pairing_cp_indicate(struct bt_conn *conn,
 				  enum fmna_gatt_pairing_ind ind_type,
 				  struct net_buf_simple *buf);
@@ -91,6 +124,14 @@ int fmna_gatt_debug_cp_indicate(struct bt_conn *conn,
 				enum fmna_gatt_debug_ind ind_type,
 				struct net_buf_simple *buf);
 
+/* Indication statistics of the connection. They are reset when the peer
+ * disconnects.
+ */
+int fmna_gatt_ind_stats_get(struct bt_conn *conn, struct fmna_gatt_ind_stats *stats);
+
+/* Usage of the pool that stores the queued indications of all connections. */
+void fmna_gatt_ind_pool_stats_get(struct fmna_gatt_ind_pool_stats *stats);
+
 int fmna_gatt_service_hidden_mode_set(bool hidden_mode);
 
 uint16_t fmna_config_event_to_gatt_cmd_opcode(enum fmna_config_event_id config_event);
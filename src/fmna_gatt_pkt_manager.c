@@ -23,6 +23,9 @@ static uint16_t pairing_ind_len_get(struct bt_conn *conn)
 {
 	uint16_t ind_data_len;
 
+	/* With Enhanced ATT this is the MTU of the largest bearer. The host
+	 * sends each fragment on a bearer that it fits in.
+	 */
 	ind_data_len = bt_gatt_get_mtu(conn);
 	if (ind_data_len <= BT_ATT_HEADER_LEN) {
 		LOG_ERR("FMNS: MTU value too low: %d", ind_data_len);
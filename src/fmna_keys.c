@@ -10,6 +10,8 @@
 #include "fmna_conn.h"
 #include "fmna_gatt_fmns.h"
 #include "fmna_keys.h"
+#include "fmna_keys_lookahead.h"
+#include "fmna_keys_ltk.h"
 #include "fmna_storage.h"
 #include "fmna_state.h"
 
@@ -27,7 +29,7 @@
 
 LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
 
-#define PRIMARY_KEYS_PER_SECONDARY_KEY       96
+#define PRIMARY_KEYS_PER_SECONDARY_KEY       FMNA_PRIMARY_KEYS_PER_SECONDARY_KEY
 #define SECONDARY_KEY_EVAL_INDEX_LOWER_BOUND 4
 #define SECONDARY_KEY_INDEX_FROM_PRIMARY(_index) \
 	(((_index) / PRIMARY_KEYS_PER_SECONDARY_KEY) + 1)
@@ -40,11 +42,19 @@ LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
  */
 #define STORAGE_UPDATE_PERIOD 16
 
+/* Each Secondary SK rotation must coincide with a storage checkpoint. This keeps the
+ * number of symmetric key rolls replayed on boot below STORAGE_UPDATE_PERIOD and
+ * guarantees that at most one Secondary SK roll is needed during the restore.
+ */
+BUILD_ASSERT((PRIMARY_KEYS_PER_SECONDARY_KEY % STORAGE_UPDATE_PERIOD) == 0,
+	     "Storage update period must be aligned with the Secondary Key period");
+
 #define KEY_ROTATION_TIMER_PERIOD K_MINUTES(15)
 
 static k_timeout_t key_rotation_timer_period;
 
 static uint8_t master_pk[FMNA_MASTER_PUBLIC_KEY_LEN];
+static struct fm_crypto_master_pk master_pk_ctx;
 static uint8_t curr_primary_sk[FMNA_SYMMETRIC_KEY_LEN];
 static uint8_t curr_secondary_sk[FMNA_SYMMETRIC_KEY_LEN];
 
@@ -60,11 +70,31 @@ static uint32_t secondary_pk_rotation_cnt = 0;
 
 static bool use_secondary_pk = false;
 
+static int64_t restore_duration = -1;
+
 /* Declaration of variables that are relevant to the BLE stack. */
 static uint8_t bt_id;
-static uint8_t bt_ltk[16];
+
+/* LTKs of the current, the previous and the next Primary Key indices. The LTK
+ * of the next index is derived in advance at rotation.
+ */
+static struct fmna_keys_ltk_candidates ltk_candidates;
+
+/* Protects the LTK candidates and the retry state, which are rewritten at
+ * rotation and read from the Bluetooth callbacks.
+ */
+static struct k_spinlock ltk_lock;
 static struct bt_keys fmna_bt_keys[CONFIG_BT_MAX_CONN];
 
+static uint8_t conn_ltk_candidate[CONFIG_BT_MAX_CONN];
+static struct fmna_keys_ltk_stats ltk_stats;
+
+/* LTK candidate to be used when the peer reconnects after an encryption failure. */
+static struct {
+	bt_addr_le_t addr;
+	uint8_t candidate;
+} ltk_retry;
+
 /* Make sure that number of keys supported in the Zephyr Bluetooth stack is sufficient. */
 BUILD_ASSERT(CONFIG_FMNA_MAX_CONN <= CONFIG_BT_MAX_PAIRED);
 
@@ -86,11 +116,11 @@ static bool bt_ltk_check(const struct bt_conn *conn)
 	return (conn->le.keys != NULL);
 }
 
-static void bt_ltk_set(struct bt_conn *conn)
+static void bt_ltk_set(struct bt_conn *conn, const uint8_t ltk[FMNA_KEYS_LTK_LEN])
 {
 	struct bt_keys *new_fmna_bt_keys;
 
-	BUILD_ASSERT(sizeof(bt_ltk) == sizeof(new_fmna_bt_keys->ltk.val));
+	BUILD_ASSERT(FMNA_KEYS_LTK_LEN == sizeof(new_fmna_bt_keys->ltk.val));
 
 	/* Pick the bt_keys instance that corresponds to the connection object index. */
 	new_fmna_bt_keys = &fmna_bt_keys[bt_conn_index(conn)];
@@ -101,7 +131,7 @@ static void bt_ltk_set(struct bt_conn *conn)
 	new_fmna_bt_keys->enc_size = sizeof(new_fmna_bt_keys->ltk.val);
 
 	/* Configure the new LTK. EDIV and Rand values are set to 0. */
-	memcpy(new_fmna_bt_keys->ltk.val, bt_ltk, sizeof(new_fmna_bt_keys->ltk.val));
+	memcpy(new_fmna_bt_keys->ltk.val, ltk, sizeof(new_fmna_bt_keys->ltk.val));
 
 	/* Inject the Find My LTK into the BLE stack connection object. */
 	conn->le.keys = new_fmna_bt_keys;
@@ -111,6 +141,120 @@ static void bt_ltk_set(struct bt_conn *conn)
 			"Setting BLE LTK");
 }
 
+static void ltk_clear(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&ltk_lock);
+
+	fmna_keys_ltk_candidates_clear(&ltk_candidates);
+	memset(&ltk_retry, 0, sizeof(ltk_retry));
+	memset(&ltk_stats, 0, sizeof(ltk_stats));
+
+	k_spin_unlock(&ltk_lock, key);
+}
+
+/* Derive LTK(i+1) from SK(i) ahead of time, so that the Bluetooth callbacks
+ * never run the key derivation nor read the Primary SK.
+ */
+static void next_ltk_update(void)
+{
+	int err = -ENOENT;
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	uint8_t next_sk[FMNA_SYMMETRIC_KEY_LEN];
+	k_spinlock_key_t key;
+
+	if (IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		struct fmna_keys_lookahead_entry entry;
+
+		err = fmna_keys_lookahead_peek(primary_pk_rotation_cnt + 1, &entry);
+		if (!err) {
+			memcpy(ltk, entry.ltk, sizeof(ltk));
+		}
+		memset(&entry, 0, sizeof(entry));
+	}
+
+	if (err) {
+		/* SK(i) -> SK(i+1) -> LTK(i+1) */
+		err = fm_crypto_roll_sk(curr_primary_sk, next_sk);
+		if (!err) {
+			err = fm_crypto_derive_ltk(next_sk, ltk);
+		}
+		memset(next_sk, 0, sizeof(next_sk));
+	}
+
+	if (err) {
+		LOG_ERR("fmna_keys: cannot derive the LTK of the next index: %d", err);
+	}
+
+	key = k_spin_lock(&ltk_lock);
+	fmna_keys_ltk_next_update(&ltk_candidates, err ? NULL : ltk);
+	k_spin_unlock(&ltk_lock, key);
+
+	memset(ltk, 0, sizeof(ltk));
+}
+
+/* Switch to LTK(i) of the new Primary Key index. LTK(i-1) is kept in the ring for
+ * the owner devices that are still on the previous index. The Primary SK and the
+ * rotation counter must already be updated.
+ */
+static void ltk_current_set(const uint8_t ltk[FMNA_KEYS_LTK_LEN])
+{
+	k_spinlock_key_t key = k_spin_lock(&ltk_lock);
+
+	if (fmna_keys_ltk_current_update(&ltk_candidates, ltk)) {
+		/* Candidate numbers are relative to the current index. */
+		memset(&ltk_retry, 0, sizeof(ltk_retry));
+	}
+
+	k_spin_unlock(&ltk_lock, key);
+
+	next_ltk_update();
+}
+
+static void ltk_stats_log(void)
+{
+	LOG_DBG("fmna_keys: LTK hits on the current index: %u, on a neighbouring index: %u, "
+		"misses: %u", ltk_stats.current_hits, ltk_stats.neighbour_hits, ltk_stats.misses);
+}
+
+static void ltk_candidate_advance(struct bt_conn *conn)
+{
+	int err;
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	uint8_t candidate = conn_ltk_candidate[bt_conn_index(conn)] + 1;
+	const bt_addr_le_t *addr = bt_conn_get_dst(conn);
+	k_spinlock_key_t key = k_spin_lock(&ltk_lock);
+
+	err = fmna_keys_ltk_candidate_find(&ltk_candidates, &candidate, ltk);
+	if (err) {
+		memset(&ltk_retry, 0, sizeof(ltk_retry));
+	} else {
+		/* Use the new candidate on reconnection too. */
+		bt_addr_le_copy(&ltk_retry.addr, addr);
+		ltk_retry.candidate = candidate;
+	}
+
+	if (err) {
+		ltk_stats.misses++;
+	}
+
+	k_spin_unlock(&ltk_lock, key);
+
+	if (err) {
+
+		LOG_WRN("fmna_keys: no more LTK candidates for the peer");
+		ltk_stats_log();
+		return;
+	}
+
+	LOG_INF("fmna_keys: switching to LTK candidate %d after encryption failure", candidate);
+
+	/* Use the new candidate for the encryption retry on this link. */
+	conn_ltk_candidate[bt_conn_index(conn)] = candidate;
+	bt_ltk_set(conn, ltk);
+
+	memset(ltk, 0, sizeof(ltk));
+}
+
 static int symmetric_key_roll(uint8_t sk[FMNA_SYMMETRIC_KEY_LEN])
 {
 	int err;
@@ -130,6 +274,7 @@ static int symmetric_key_roll(uint8_t sk[FMNA_SYMMETRIC_KEY_LEN])
 static int primary_key_roll(void)
 {
 	int err;
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
 
 	/* SK(i) -> SK(i+1) */
 	err = symmetric_key_roll(curr_primary_sk);
@@ -139,7 +284,8 @@ static int primary_key_roll(void)
 	}
 
 	/* SK(i+1) -> Primary_Key(i+1) */
-	err = fm_crypto_derive_primary_or_secondary_x(curr_primary_sk, master_pk, curr_primary_pk);
+	err = fm_crypto_derive_primary_or_secondary_x_from_master(curr_primary_sk, &master_pk_ctx,
+								   curr_primary_pk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for primary SK", err);
 		return err;
@@ -148,12 +294,15 @@ static int primary_key_roll(void)
 	primary_pk_rotation_cnt++;
 
 	/* SK(i+1) -> LTK(i+1) */
-	err = fm_crypto_derive_ltk(curr_primary_sk, bt_ltk);
+	err = fm_crypto_derive_ltk(curr_primary_sk, ltk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for primary SK", err);
 		return err;
 	}
 
+	ltk_current_set(ltk);
+	memset(ltk, 0, sizeof(ltk));
+
 	LOG_DBG("Rolling Primary Public Key to: P[%d]", primary_pk_rotation_cnt);
 	LOG_HEXDUMP_DBG(curr_primary_pk, sizeof(curr_primary_pk), "Primary Public Key");
 
@@ -188,8 +337,8 @@ static int secondary_key_roll(void)
 	}
 
 	/* SK(i+1) -> Secondary_Key(i+1) */
-	err = fm_crypto_derive_primary_or_secondary_x(curr_secondary_sk, master_pk,
-						      curr_secondary_pk);
+	err = fm_crypto_derive_primary_or_secondary_x_from_master(curr_secondary_sk, &master_pk_ctx,
+								   curr_secondary_pk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for secondary SK", err);
 		return err;
@@ -298,18 +447,48 @@ static void primary_key_rotation_indicate(void)
 	}
 }
 
-static void key_rotation_work_handle(struct k_work *item)
+static int lookahead_key_roll(void)
 {
 	int err;
-	bool separated_key_changed = true;
-	uint16_t storage_key_index_diff;
+	struct fmna_keys_lookahead_entry entry;
 
-	LOG_INF("Rotating FMNA keys");
+	err = fmna_keys_lookahead_get(primary_pk_rotation_cnt + 1, &entry);
+	if (err) {
+		return err;
+	}
+
+	/* Swap in the precomputed Primary Key set: SK(i+1), Primary_Key(i+1), LTK(i+1). */
+	memcpy(curr_primary_sk, entry.primary_sk, sizeof(curr_primary_sk));
+	memcpy(curr_primary_pk, entry.primary_pk, sizeof(curr_primary_pk));
+	primary_pk_rotation_cnt = entry.primary_index;
+	ltk_current_set(entry.ltk);
+
+	LOG_DBG("Rolling Primary Public Key to: P[%d]", primary_pk_rotation_cnt);
+	LOG_HEXDUMP_DBG(curr_primary_pk, sizeof(curr_primary_pk), "Primary Public Key");
+
+	if (entry.secondary_rolled) {
+		memcpy(curr_secondary_sk, entry.secondary_sk, sizeof(curr_secondary_sk));
+		memcpy(curr_secondary_pk, entry.secondary_pk, sizeof(curr_secondary_pk));
+		secondary_pk_rotation_cnt++;
+
+		LOG_DBG("Rolling Secondary Public Key: PW[%d]", secondary_pk_rotation_cnt);
+		LOG_HEXDUMP_DBG(curr_secondary_pk, sizeof(curr_secondary_pk),
+				"Secondary Public Key");
+	}
+
+	memset(&entry, 0, sizeof(entry));
+
+	return 0;
+}
+
+static int inline_key_roll(void)
+{
+	int err;
 
 	err = primary_key_roll();
 	if (err) {
 		LOG_ERR("primary_key_roll returned error: %d", err);
-		return;
+		return err;
 	}
 
 	/* Check if the secondary key update is necessary. */
@@ -317,6 +496,41 @@ static void key_rotation_work_handle(struct k_work *item)
 		err = secondary_key_roll();
 		if (err) {
 			LOG_ERR("secondary_key_roll returned error: %d", err);
+			return err;
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		/* Restart the lookahead cache from the current keys. */
+		err = fmna_keys_lookahead_start(curr_primary_sk, curr_secondary_sk,
+						primary_pk_rotation_cnt, &master_pk_ctx);
+		if (err) {
+			LOG_ERR("fmna_keys_lookahead_start returned error: %d", err);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static void key_rotation_work_handle(struct k_work *item)
+{
+	int err;
+	bool separated_key_changed = true;
+	uint16_t storage_key_index_diff;
+
+	LOG_INF("Rotating FMNA keys");
+
+	/* Use the precomputed keys if they are available. */
+	err = -ENOENT;
+	if (IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		err = lookahead_key_roll();
+	}
+
+	if (err) {
+		err = inline_key_roll();
+		if (err) {
+			LOG_ERR("inline_key_roll returned error: %d", err);
 			return;
 		}
 	}
@@ -402,6 +616,48 @@ int fmna_keys_separated_key_get(uint8_t separated_key[FMNA_PUBLIC_KEY_LEN])
 	return 0;
 }
 
+int fmna_keys_next_keys_get(uint8_t primary_key[FMNA_PUBLIC_KEY_LEN],
+			    uint8_t separated_key[FMNA_PUBLIC_KEY_LEN])
+{
+	int err;
+	uint32_t next_index = primary_pk_rotation_cnt + 1;
+	const uint8_t *next_secondary_pk;
+	struct fmna_keys_lookahead_entry entry;
+
+	if (!IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		return -ENOTSUP;
+	}
+
+	err = fmna_keys_lookahead_peek(next_index, &entry);
+	if (err) {
+		return err;
+	}
+
+	memcpy(primary_key, entry.primary_pk, FMNA_PUBLIC_KEY_LEN);
+
+	next_secondary_pk = entry.secondary_rolled ? entry.secondary_pk : curr_secondary_pk;
+
+	/* Follow the separated key selection of the key rotation. */
+	if ((next_index % PRIMARY_KEYS_PER_SECONDARY_KEY) == secondary_pk_rotation_delta) {
+		memcpy(separated_key, next_secondary_pk, FMNA_PUBLIC_KEY_LEN);
+	} else if (is_primary_pk_latched) {
+		memcpy(separated_key, latched_primary_pk, FMNA_PUBLIC_KEY_LEN);
+	} else if (use_secondary_pk) {
+		memcpy(separated_key, next_secondary_pk, FMNA_PUBLIC_KEY_LEN);
+	} else {
+		memcpy(separated_key, entry.primary_pk, FMNA_PUBLIC_KEY_LEN);
+	}
+
+	memset(&entry, 0, sizeof(entry));
+
+	return 0;
+}
+
+int64_t fmna_keys_restore_duration_get(void)
+{
+	return restore_duration;
+}
+
 static void fmna_keys_state_cleanup(void)
 {
 	primary_pk_rotation_cnt = 0;
@@ -411,6 +667,9 @@ static void fmna_keys_state_cleanup(void)
 	is_primary_pk_latched = false;
 	use_secondary_pk = false;
 
+	fm_crypto_master_pk_free(&master_pk_ctx);
+	ltk_clear();
+
 	if (IS_ENABLED(CONFIG_FMNA_QUALIFICATION)) {
 		key_rotation_timer_period = KEY_ROTATION_TIMER_PERIOD;
 	}
@@ -421,6 +680,11 @@ int fmna_keys_service_stop(void)
 	/* Stop the key rotation timeout. */
 	k_timer_stop(&key_rotation_timer);
 
+	if (IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		/* Zeroize the precomputed keys. */
+		fmna_keys_lookahead_stop();
+	}
+
 	fmna_keys_state_cleanup();
 
 	LOG_INF("FMNA Keys rotation service stopped");
@@ -430,6 +694,17 @@ int fmna_keys_service_stop(void)
 
 static void keys_service_timer_start(void)
 {
+	int err;
+
+	if (IS_ENABLED(CONFIG_FMNA_KEYS_LOOKAHEAD)) {
+		/* Precompute the upcoming keys in the background. */
+		err = fmna_keys_lookahead_start(curr_primary_sk, curr_secondary_sk,
+						primary_pk_rotation_cnt, &master_pk_ctx);
+		if (err) {
+			LOG_ERR("fmna_keys_lookahead_start returned error: %d", err);
+		}
+	}
+
 	/* Start key rotation timeout. */
 	k_timer_start(&key_rotation_timer, key_rotation_timer_period, key_rotation_timer_period);
 
@@ -447,6 +722,12 @@ int fmna_keys_service_start(const struct fmna_keys_init *init_keys)
 	memcpy(curr_secondary_sk, init_keys->secondary_sk,
 	       sizeof(curr_secondary_sk));
 
+	err = fm_crypto_master_pk_import(&master_pk_ctx, master_pk);
+	if (err) {
+		LOG_ERR("fm_crypto_master_pk_import returned error: %d", err);
+		return err;
+	}
+
 	/* Primary SK N -> Primary SK 0 */
 	err = symmetric_key_roll(curr_primary_sk);
 	if (err) {
@@ -507,10 +788,43 @@ int fmna_keys_service_start(const struct fmna_keys_init *init_keys)
 	return 0;
 }
 
+void fmna_keys_ltk_stats_get(struct fmna_keys_ltk_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&ltk_lock);
+
+	*stats = ltk_stats;
+
+	k_spin_unlock(&ltk_lock, key);
+}
+
 static void fmna_peer_connected(struct bt_conn *conn)
 {
+	int err;
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	uint8_t candidate = FMNA_KEYS_LTK_CANDIDATE_CURRENT;
+	k_spinlock_key_t key;
+
 	if (fmna_state_is_paired()) {
-		bt_ltk_set(conn);
+		key = k_spin_lock(&ltk_lock);
+
+		/* Continue with the next LTK candidate if the peer failed to encrypt before. */
+		if ((FMNA_KEYS_LTK_RING_SIZE > 0) &&
+		    bt_addr_le_eq(&ltk_retry.addr, bt_conn_get_dst(conn))) {
+			candidate = ltk_retry.candidate;
+		}
+
+		err = fmna_keys_ltk_candidate_find(&ltk_candidates, &candidate, ltk);
+		if (err) {
+			candidate = FMNA_KEYS_LTK_CANDIDATE_CURRENT;
+			(void) fmna_keys_ltk_candidate_get(&ltk_candidates, candidate, ltk);
+		}
+
+		k_spin_unlock(&ltk_lock, key);
+
+		conn_ltk_candidate[bt_conn_index(conn)] = candidate;
+		bt_ltk_set(conn, ltk);
+
+		memset(ltk, 0, sizeof(ltk));
 	}
 }
 
@@ -519,7 +833,28 @@ static void fmna_peer_security_changed(struct bt_conn *conn, bt_security_t level
 {
 	if (fmna_state_is_paired()) {
 		if (bt_ltk_check(conn)) {
-			if (!err) {
+			if (err) {
+				if (FMNA_KEYS_LTK_RING_SIZE > 0) {
+					ltk_candidate_advance(conn);
+				}
+			} else {
+				k_spinlock_key_t key = k_spin_lock(&ltk_lock);
+
+				if (conn_ltk_candidate[bt_conn_index(conn)] ==
+				    FMNA_KEYS_LTK_CANDIDATE_CURRENT) {
+					ltk_stats.current_hits++;
+				} else {
+					ltk_stats.neighbour_hits++;
+				}
+
+				if (bt_addr_le_eq(&ltk_retry.addr, bt_conn_get_dst(conn))) {
+					memset(&ltk_retry, 0, sizeof(ltk_retry));
+				}
+
+				k_spin_unlock(&ltk_lock, key);
+
+				ltk_stats_log();
+
 				fmna_conn_multi_status_bit_set(
 					conn, FMNA_CONN_MULTI_STATUS_BIT_OWNER_CONNECTED);
 
@@ -546,6 +881,7 @@ static int paired_state_restore(void)
 	int64_t start_time;
 	int64_t duration;
 	char hexdump_header[50];
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
 	uint16_t current_keys_index_diff = 0;
 
 	/* Load storage information relevant to the keys module. */
@@ -557,6 +893,12 @@ static int paired_state_restore(void)
 		return err;
 	}
 
+	err = fm_crypto_master_pk_import(&master_pk_ctx, master_pk);
+	if (err) {
+		LOG_ERR("fm_crypto_master_pk_import returned error: %d", err);
+		return err;
+	}
+
 	err = fmna_storage_pairing_item_load(FMNA_STORAGE_PRIMARY_SK_ID,
 					     curr_primary_sk,
 					     sizeof(curr_primary_sk));
@@ -589,6 +931,13 @@ static int paired_state_restore(void)
 		return err;
 	}
 
+	/* The diff is always expressed relative to the last storage checkpoint. */
+	if (current_keys_index_diff >= STORAGE_UPDATE_PERIOD) {
+		LOG_ERR("fmna_keys: invalid diff between current and storage key: %d",
+			current_keys_index_diff);
+		return -EINVAL;
+	}
+
 	/* Roll keys to the current index. */
 	LOG_DBG("Restoring FMN keys state. Rolling index: %d -> %d",
 		primary_pk_rotation_cnt,
@@ -622,22 +971,26 @@ static int paired_state_restore(void)
 
 	/* Derive public keys and LTK. */
 	/* SK(i+1) -> Primary_Key(i+1) */
-	err = fm_crypto_derive_primary_or_secondary_x(curr_primary_sk, master_pk, curr_primary_pk);
+	err = fm_crypto_derive_primary_or_secondary_x_from_master(curr_primary_sk, &master_pk_ctx,
+								   curr_primary_pk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for primary SK", err);
 		return err;
 	}
 
 	/* SK(i+1) -> LTK(i+1) */
-	err = fm_crypto_derive_ltk(curr_primary_sk, bt_ltk);
+	err = fm_crypto_derive_ltk(curr_primary_sk, ltk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for primary SK", err);
 		return err;
 	}
 
+	ltk_current_set(ltk);
+	memset(ltk, 0, sizeof(ltk));
+
 	/* SK(i+1) -> Secondary_Key(i+1) */
-	err = fm_crypto_derive_primary_or_secondary_x(curr_secondary_sk, master_pk,
-						      curr_secondary_pk);
+	err = fm_crypto_derive_primary_or_secondary_x_from_master(curr_secondary_sk, &master_pk_ctx,
+								   curr_secondary_pk);
 	if (err) {
 		LOG_ERR("symmetric_key_roll returned error: %d for secondary SK", err);
 		return err;
@@ -645,9 +998,10 @@ static int paired_state_restore(void)
 
 	/* Log the results and statistics */
 	duration = k_uptime_delta(&start_time);
+	restore_duration = duration;
 
-	LOG_DBG("Restored FMN keys state in: %lld.%lld [s]",
-		(duration / 1000), (duration % 1000));
+	LOG_INF("Restored FMN keys state to P[%d] in: %lld.%03lld [s]",
+		primary_pk_rotation_cnt, (duration / 1000), (duration % 1000));
 
 	snprintk(hexdump_header,
 		 sizeof(hexdump_header), 
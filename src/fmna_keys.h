@@ -17,16 +17,42 @@ extern "C" {
 
 #define FMNA_PUBLIC_KEY_LEN 28
 
+#define FMNA_PRIMARY_KEYS_PER_SECONDARY_KEY 96
+
 struct fmna_keys_init {
 	uint8_t master_pk[FMNA_MASTER_PUBLIC_KEY_LEN];
 	uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN];
 	uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN];
 };
 
+struct fmna_keys_ltk_stats {
+	/* Owner encrypted the link with the LTK of the current index. */
+	uint32_t current_hits;
+
+	/* Owner encrypted the link with the LTK of a neighbouring index. */
+	uint32_t neighbour_hits;
+
+	/* Owner failed to encrypt the link with any of the LTK candidates. */
+	uint32_t misses;
+};
+
 int fmna_keys_primary_key_get(uint8_t primary_key[FMNA_PUBLIC_KEY_LEN]);
 
 int fmna_keys_separated_key_get(uint8_t separated_key[FMNA_PUBLIC_KEY_LEN]);
 
+/* Returns the Primary Key and the separated key that will be used after the next
+ * key rotation. Returns -ENOENT if the keys are not precomputed yet.
+ */
+int fmna_keys_next_keys_get(uint8_t primary_key[FMNA_PUBLIC_KEY_LEN],
+			    uint8_t separated_key[FMNA_PUBLIC_KEY_LEN]);
+
+/* Returns the time in milliseconds spent on restoring the keys state from storage
+ * during the last boot or a negative value if the paired state was not restored.
+ */
+int64_t fmna_keys_restore_duration_get(void);
+
+void fmna_keys_ltk_stats_get(struct fmna_keys_ltk_stats *stats);
+
 int fmna_keys_service_stop(void);
 
 int fmna_keys_service_start(const struct fmna_keys_init *init_keys);
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fmna_keys_lookahead.h"
+#include "crypto/fm_crypto_p224.h"
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
+
+#define LOOKAHEAD_DEPTH CONFIG_FMNA_KEYS_LOOKAHEAD_DEPTH
+#define LOOKAHEAD_BATCH_SIZE MIN(LOOKAHEAD_DEPTH, FM_CRYPTO_P224_BATCH_MAX)
+
+#define LOOKAHEAD_THREAD_PRIORITY						\
+	(CONFIG_FMNA_KEYS_LOOKAHEAD_THREAD_PRIORITY < CONFIG_NUM_PREEMPT_PRIORITIES ? \
+	 CONFIG_FMNA_KEYS_LOOKAHEAD_THREAD_PRIORITY : CONFIG_NUM_PREEMPT_PRIORITIES - 1)
+
+/* State of the last key set that was queued by the producer thread. */
+struct lookahead_tail {
+	uint32_t primary_index;
+	uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN];
+	uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN];
+};
+
+static K_MSGQ_DEFINE(lookahead_msgq, sizeof(struct fmna_keys_lookahead_entry),
+		     LOOKAHEAD_DEPTH, 4);
+
+static struct lookahead_tail tail;
+static fm_crypto_master_pk_t master_pk_ctx;
+static uint32_t generation;
+static bool is_running;
+
+static K_MUTEX_DEFINE(lookahead_mutex);
+
+/* Held by the producer thread while it derives keys with the master public key
+ * context, so that the context is not released in the middle of a derivation.
+ * Always taken before lookahead_mutex.
+ */
+static K_MUTEX_DEFINE(lookahead_compute_mutex);
+static K_SEM_DEFINE(lookahead_sem, 0, 1);
+
+/* Key sets derived together by the producer thread. The Primary Keys of a batch
+ * share the affine conversion in fm_crypto_derive_primary_keys_batch_from_master,
+ * which also returns the rolled Primary SKs.
+ */
+static struct fmna_keys_lookahead_entry batch_entries[LOOKAHEAD_BATCH_SIZE];
+static uint8_t batch_pk[LOOKAHEAD_BATCH_SIZE][FMNA_PUBLIC_KEY_LEN];
+static uint8_t batch_sk[LOOKAHEAD_BATCH_SIZE][FMNA_SYMMETRIC_KEY_LEN];
+
+static int entry_compute(struct fmna_keys_lookahead_entry *entry,
+			 struct lookahead_tail *state,
+			 const uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			 const uint8_t primary_pk[FMNA_PUBLIC_KEY_LEN],
+			 fm_crypto_master_pk_t master_pk)
+{
+	int err;
+
+	entry->primary_index = state->primary_index + 1;
+
+	/* SK(i+1) and Primary_Key(i+1) come from the batch derivation. */
+	memcpy(entry->primary_sk, primary_sk, sizeof(entry->primary_sk));
+	memcpy(entry->primary_pk, primary_pk, sizeof(entry->primary_pk));
+
+	/* SK(i+1) -> LTK(i+1) */
+	err = fm_crypto_derive_ltk(entry->primary_sk, entry->ltk);
+	if (err) {
+		LOG_ERR("fm_crypto_derive_ltk returned error: %d", err);
+		return err;
+	}
+
+	entry->secondary_rolled =
+		((entry->primary_index % FMNA_PRIMARY_KEYS_PER_SECONDARY_KEY) == 0);
+	if (!entry->secondary_rolled) {
+		memcpy(entry->secondary_sk, state->secondary_sk, sizeof(entry->secondary_sk));
+		return 0;
+	}
+
+	/* SK(j) -> SK(j+1) */
+	err = fm_crypto_roll_sk(state->secondary_sk, entry->secondary_sk);
+	if (err) {
+		LOG_ERR("fm_crypto_roll_sk returned error: %d for secondary SK", err);
+		return err;
+	}
+
+	/* SK(j+1) -> Secondary_Key(j+1) */
+	err = fm_crypto_derive_primary_or_secondary_x_from_master(entry->secondary_sk, master_pk,
+								   entry->secondary_pk);
+	if (err) {
+		LOG_ERR("fm_crypto_derive_primary_or_secondary_x_from_master returned "
+			"error: %d for secondary SK", err);
+		return err;
+	}
+
+	return 0;
+}
+
+static int batch_compute(struct fmna_keys_lookahead_entry *entries,
+			 uint32_t count,
+			 struct lookahead_tail *state,
+			 fm_crypto_master_pk_t master_pk)
+{
+	int err;
+
+	/* SK(i) -> Primary_Key(i+1) ... Primary_Key(i+count) */
+	err = fm_crypto_derive_primary_keys_batch_from_master(state->primary_sk, master_pk,
+							      count, batch_pk, batch_sk);
+	if (err) {
+		LOG_ERR("fm_crypto_derive_primary_keys_batch_from_master returned error: %d",
+			err);
+		return err;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		err = entry_compute(&entries[i], state, batch_sk[i], batch_pk[i], master_pk);
+		if (err) {
+			break;
+		}
+
+		/* The next entry follows this one. */
+		state->primary_index = entries[i].primary_index;
+		memcpy(state->primary_sk, entries[i].primary_sk, sizeof(state->primary_sk));
+		memcpy(state->secondary_sk, entries[i].secondary_sk, sizeof(state->secondary_sk));
+	}
+
+	memset(batch_pk, 0, sizeof(batch_pk));
+	memset(batch_sk, 0, sizeof(batch_sk));
+
+	return err;
+}
+
+static void lookahead_fill(void)
+{
+	int err;
+	uint32_t count;
+	uint32_t entry_generation;
+	struct lookahead_tail state;
+	fm_crypto_master_pk_t master_pk;
+
+	while (true) {
+		k_mutex_lock(&lookahead_compute_mutex, K_FOREVER);
+		k_mutex_lock(&lookahead_mutex, K_FOREVER);
+		count = MIN(k_msgq_num_free_get(&lookahead_msgq), ARRAY_SIZE(batch_entries));
+		if (!is_running || (count == 0)) {
+			k_mutex_unlock(&lookahead_mutex);
+			k_mutex_unlock(&lookahead_compute_mutex);
+			break;
+		}
+
+		memcpy(&state, &tail, sizeof(state));
+		master_pk = master_pk_ctx;
+		entry_generation = generation;
+		k_mutex_unlock(&lookahead_mutex);
+
+		/* Derive the keys without holding the cache lock. */
+		err = batch_compute(batch_entries, count, &state, master_pk);
+		k_mutex_unlock(&lookahead_compute_mutex);
+		if (err) {
+			LOG_ERR("FMN Keys lookahead: cannot precompute keys for index %d",
+				state.primary_index + 1);
+			break;
+		}
+
+		k_mutex_lock(&lookahead_mutex, K_FOREVER);
+		/* Drop the results if the cache was restarted in the meantime. */
+		for (uint32_t i = 0; i < count; i++) {
+			struct fmna_keys_lookahead_entry *entry = &batch_entries[i];
+
+			if (!is_running || (entry_generation != generation)) {
+				break;
+			}
+
+			err = k_msgq_put(&lookahead_msgq, entry, K_NO_WAIT);
+			if (err) {
+				break;
+			}
+
+			tail.primary_index = entry->primary_index;
+			memcpy(tail.primary_sk, entry->primary_sk, sizeof(tail.primary_sk));
+			memcpy(tail.secondary_sk, entry->secondary_sk, sizeof(tail.secondary_sk));
+		}
+		k_mutex_unlock(&lookahead_mutex);
+
+		memset(batch_entries, 0, sizeof(batch_entries));
+	}
+
+	memset(&state, 0, sizeof(state));
+	memset(batch_entries, 0, sizeof(batch_entries));
+}
+
+static void lookahead_thread_entry_point(void *arg0, void *arg1, void *arg2)
+{
+	while (true) {
+		k_sem_take(&lookahead_sem, K_FOREVER);
+		lookahead_fill();
+	}
+}
+
+K_THREAD_DEFINE(fmna_keys_lookahead_thread, CONFIG_FMNA_KEYS_LOOKAHEAD_THREAD_STACK_SIZE,
+		lookahead_thread_entry_point, NULL, NULL, NULL,
+		LOOKAHEAD_THREAD_PRIORITY, 0, 0);
+
+static void lookahead_reset(void)
+{
+	generation++;
+
+	k_msgq_purge(&lookahead_msgq);
+	memset(lookahead_msgq.buffer_start, 0,
+	       lookahead_msgq.buffer_end - lookahead_msgq.buffer_start);
+	memset(&tail, 0, sizeof(tail));
+}
+
+int fmna_keys_lookahead_start(const uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			      const uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			      uint32_t primary_index,
+			      fm_crypto_master_pk_t master_pk)
+{
+	k_mutex_lock(&lookahead_mutex, K_FOREVER);
+
+	lookahead_reset();
+
+	tail.primary_index = primary_index;
+	memcpy(tail.primary_sk, primary_sk, sizeof(tail.primary_sk));
+	memcpy(tail.secondary_sk, secondary_sk, sizeof(tail.secondary_sk));
+	master_pk_ctx = master_pk;
+	is_running = true;
+
+	k_mutex_unlock(&lookahead_mutex);
+
+	k_sem_give(&lookahead_sem);
+
+	LOG_DBG("FMN Keys lookahead: started at index %d", primary_index);
+
+	return 0;
+}
+
+int fmna_keys_lookahead_get(uint32_t primary_index, struct fmna_keys_lookahead_entry *entry)
+{
+	int err;
+
+	k_mutex_lock(&lookahead_mutex, K_FOREVER);
+
+	if (!is_running) {
+		k_mutex_unlock(&lookahead_mutex);
+		return -ENOENT;
+	}
+
+	err = k_msgq_get(&lookahead_msgq, entry, K_NO_WAIT);
+	if (err) {
+		k_mutex_unlock(&lookahead_mutex);
+
+		LOG_WRN("FMN Keys lookahead: no entry ready for index %d", primary_index);
+
+		return -ENOENT;
+	}
+
+	if (entry->primary_index != primary_index) {
+		LOG_ERR("FMN Keys lookahead: index mismatch: %d != %d",
+			entry->primary_index, primary_index);
+
+		/* The cached keys are not usable anymore. The cache needs to be restarted. */
+		memset(entry, 0, sizeof(*entry));
+		is_running = false;
+		lookahead_reset();
+
+		k_mutex_unlock(&lookahead_mutex);
+
+		return -ENOENT;
+	}
+
+	k_mutex_unlock(&lookahead_mutex);
+
+	/* Refill the cache in the background. */
+	k_sem_give(&lookahead_sem);
+
+	return 0;
+}
+
+int fmna_keys_lookahead_peek(uint32_t primary_index, struct fmna_keys_lookahead_entry *entry)
+{
+	int err;
+
+	k_mutex_lock(&lookahead_mutex, K_FOREVER);
+
+	if (!is_running) {
+		k_mutex_unlock(&lookahead_mutex);
+		return -ENOENT;
+	}
+
+	err = k_msgq_peek(&lookahead_msgq, entry);
+	if (err || (entry->primary_index != primary_index)) {
+		k_mutex_unlock(&lookahead_mutex);
+
+		memset(entry, 0, sizeof(*entry));
+
+		return -ENOENT;
+	}
+
+	k_mutex_unlock(&lookahead_mutex);
+
+	return 0;
+}
+
+void fmna_keys_lookahead_stop(void)
+{
+	/* Wait for the derivation in progress to finish with the master public key. */
+	k_mutex_lock(&lookahead_compute_mutex, K_FOREVER);
+	k_mutex_lock(&lookahead_mutex, K_FOREVER);
+
+	is_running = false;
+	master_pk_ctx = NULL;
+	lookahead_reset();
+
+	k_mutex_unlock(&lookahead_mutex);
+	k_mutex_unlock(&lookahead_compute_mutex);
+
+	LOG_DBG("FMN Keys lookahead: stopped");
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FMNA_KEYS_LOOKAHEAD_H_
+#define FMNA_KEYS_LOOKAHEAD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+
+#include "crypto/fm_crypto.h"
+#include "fmna_keys.h"
+#include "fmna_keys_ltk.h"
+
+struct fmna_keys_lookahead_entry {
+	uint32_t primary_index;
+	uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN];
+	uint8_t primary_pk[FMNA_PUBLIC_KEY_LEN];
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+
+	/* Secondary key fields are valid only if the secondary key rolls together
+	 * with the primary key at this index.
+	 */
+	bool secondary_rolled;
+	uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN];
+	uint8_t secondary_pk[FMNA_PUBLIC_KEY_LEN];
+};
+
+/* Start precomputing the keys that follow the current Primary Key index. The master
+ * public key context must remain valid until fmna_keys_lookahead_stop is called.
+ */
+int fmna_keys_lookahead_start(const uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			      const uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			      uint32_t primary_index,
+			      fm_crypto_master_pk_t master_pk);
+
+/* Take the precomputed entry for the given Primary Key index. Returns -ENOENT
+ * if the entry is not ready yet and needs to be computed by the caller.
+ */
+int fmna_keys_lookahead_get(uint32_t primary_index, struct fmna_keys_lookahead_entry *entry);
+
+/* Copy the precomputed entry for the given Primary Key index without taking it
+ * from the cache. Returns -ENOENT if the entry is not ready yet.
+ */
+int fmna_keys_lookahead_peek(uint32_t primary_index, struct fmna_keys_lookahead_entry *entry);
+
+/* Stop the precomputation and zeroize all cached keys. Blocks until the key
+ * derivation in progress completes, after which the master public key context
+ * passed to fmna_keys_lookahead_start is no longer used.
+ */
+void fmna_keys_lookahead_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* FMNA_KEYS_LOOKAHEAD_H_ */
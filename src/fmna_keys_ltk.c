@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fmna_keys_ltk.h"
+
+#include <string.h>
+
+void fmna_keys_ltk_candidates_clear(struct fmna_keys_ltk_candidates *candidates)
+{
+	memset(candidates, 0, sizeof(*candidates));
+}
+
+bool fmna_keys_ltk_current_update(struct fmna_keys_ltk_candidates *candidates,
+				  const uint8_t ltk[FMNA_KEYS_LTK_LEN])
+{
+	bool pushed = false;
+
+	/* Before the first roll after the service start there is no LTK(i-1). */
+	if ((FMNA_KEYS_LTK_RING_SIZE > 0) && candidates->current_valid) {
+		struct fmna_keys_ltk_ring_entry *entry;
+
+		candidates->ring_head = (candidates->ring_head + 1) % ARRAY_SIZE(candidates->ring);
+
+		entry = &candidates->ring[candidates->ring_head];
+		memcpy(entry->ltk, candidates->current, sizeof(entry->ltk));
+		entry->valid = true;
+
+		pushed = true;
+	}
+
+	memcpy(candidates->current, ltk, sizeof(candidates->current));
+	candidates->current_valid = true;
+
+	memset(candidates->next, 0, sizeof(candidates->next));
+	candidates->next_valid = false;
+
+	return pushed;
+}
+
+void fmna_keys_ltk_next_update(struct fmna_keys_ltk_candidates *candidates,
+			       const uint8_t ltk[FMNA_KEYS_LTK_LEN])
+{
+	if (ltk) {
+		memcpy(candidates->next, ltk, sizeof(candidates->next));
+	} else {
+		memset(candidates->next, 0, sizeof(candidates->next));
+	}
+	candidates->next_valid = (ltk != NULL);
+}
+
+int fmna_keys_ltk_candidate_get(const struct fmna_keys_ltk_candidates *candidates,
+				uint8_t candidate, uint8_t ltk[FMNA_KEYS_LTK_LEN])
+{
+	if (candidate == FMNA_KEYS_LTK_CANDIDATE_CURRENT) {
+		memcpy(ltk, candidates->current, sizeof(candidates->current));
+		return 0;
+	}
+
+	if (candidate < FMNA_KEYS_LTK_CANDIDATE_NEXT) {
+		/* Candidate 1 is the previous index, candidate 2 is the one before it, etc. */
+		const struct fmna_keys_ltk_ring_entry *entry =
+			&candidates->ring[(candidates->ring_head + FMNA_KEYS_LTK_RING_SIZE + 1 -
+					   candidate) % ARRAY_SIZE(candidates->ring)];
+
+		if (!entry->valid) {
+			return -ENOENT;
+		}
+
+		memcpy(ltk, entry->ltk, sizeof(entry->ltk));
+		return 0;
+	}
+
+	if (candidate == FMNA_KEYS_LTK_CANDIDATE_NEXT) {
+		if (!candidates->next_valid) {
+			return -ENOENT;
+		}
+
+		memcpy(ltk, candidates->next, sizeof(candidates->next));
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+int fmna_keys_ltk_candidate_find(const struct fmna_keys_ltk_candidates *candidates,
+				 uint8_t *candidate, uint8_t ltk[FMNA_KEYS_LTK_LEN])
+{
+	for (uint8_t i = *candidate; i <= FMNA_KEYS_LTK_CANDIDATE_NEXT; i++) {
+		if (!fmna_keys_ltk_candidate_get(candidates, i, ltk)) {
+			*candidate = i;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
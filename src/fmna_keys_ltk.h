@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FMNA_KEYS_LTK_H_
+#define FMNA_KEYS_LTK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+
+#define FMNA_KEYS_LTK_LEN 16
+
+#define FMNA_KEYS_LTK_RING_SIZE CONFIG_FMNA_KEYS_LTK_RING_SIZE
+
+/* LTK candidates tried for the owner connection: current index, previous indices
+ * starting from the newest one and the next index.
+ */
+#define FMNA_KEYS_LTK_CANDIDATE_CURRENT 0
+#define FMNA_KEYS_LTK_CANDIDATE_NEXT    (FMNA_KEYS_LTK_RING_SIZE + 1)
+
+struct fmna_keys_ltk_ring_entry {
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	bool valid;
+};
+
+/* LTKs of the current, the previous and the next Primary Key indices. The
+ * functions below do not lock, the caller serializes the access.
+ */
+struct fmna_keys_ltk_candidates {
+	uint8_t current[FMNA_KEYS_LTK_LEN];
+	bool current_valid;
+
+	uint8_t next[FMNA_KEYS_LTK_LEN];
+	bool next_valid;
+
+	/* Ring of LTKs that correspond to the previous Primary Key indices. */
+	struct fmna_keys_ltk_ring_entry ring[MAX(FMNA_KEYS_LTK_RING_SIZE, 1)];
+	uint8_t ring_head;
+};
+
+/* Zeroize all LTKs. */
+void fmna_keys_ltk_candidates_clear(struct fmna_keys_ltk_candidates *candidates);
+
+/* Switch to the LTK of the new Primary Key index. The previous current LTK is
+ * pushed to the ring in place of the oldest one and the next LTK is invalidated.
+ * Returns true if the ring was updated, which shifts the candidate numbers.
+ */
+bool fmna_keys_ltk_current_update(struct fmna_keys_ltk_candidates *candidates,
+				  const uint8_t ltk[FMNA_KEYS_LTK_LEN]);
+
+/* Set the LTK of the next Primary Key index or invalidate it if ltk is NULL. */
+void fmna_keys_ltk_next_update(struct fmna_keys_ltk_candidates *candidates,
+			       const uint8_t ltk[FMNA_KEYS_LTK_LEN]);
+
+/* Copy the LTK of the given candidate. Returns -ENOENT if the candidate is not
+ * available. The current candidate is always available.
+ */
+int fmna_keys_ltk_candidate_get(const struct fmna_keys_ltk_candidates *candidates,
+				uint8_t candidate, uint8_t ltk[FMNA_KEYS_LTK_LEN]);
+
+/* Find the first available candidate, starting from the given one. Returns
+ * -ENOENT if none of the remaining candidates is available.
+ */
+int fmna_keys_ltk_candidate_find(const struct fmna_keys_ltk_candidates *candidates,
+				 uint8_t *candidate, uint8_t ltk[FMNA_KEYS_LTK_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* FMNA_KEYS_LTK_H_ */
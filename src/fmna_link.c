@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include "fmna_link.h"
+
+#include <zephyr/init.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
+
+/* Link parameters requested by a policy. The ANY values leave the link as negotiated. */
+enum link_data_len {
+	LINK_DATA_LEN_ANY,
+	LINK_DATA_LEN_DEFAULT,
+	LINK_DATA_LEN_MAX,
+};
+
+enum link_phy {
+	LINK_PHY_ANY,
+	LINK_PHY_1M,
+	LINK_PHY_2M,
+};
+
+struct link_policy {
+	bool mtu_max;
+	enum link_data_len data_len;
+	enum link_phy phy;
+};
+
+#define LINK_DATA_LEN_MAX_IF(_opt) (IS_ENABLED(_opt) ? LINK_DATA_LEN_MAX : LINK_DATA_LEN_ANY)
+#define LINK_PHY_2M_IF(_opt)       (IS_ENABLED(_opt) ? LINK_PHY_2M : LINK_PHY_ANY)
+
+#if CONFIG_FMNA_LINK_OWNER_DATA_LEN_MAX
+#define LINK_OWNER_DATA_LEN LINK_DATA_LEN_MAX
+#elif CONFIG_FMNA_LINK_OWNER_DATA_LEN_DEFAULT
+#define LINK_OWNER_DATA_LEN LINK_DATA_LEN_DEFAULT
+#else
+#define LINK_OWNER_DATA_LEN LINK_DATA_LEN_ANY
+#endif
+
+#if CONFIG_FMNA_LINK_OWNER_PHY_2M
+#define LINK_OWNER_PHY LINK_PHY_2M
+#elif CONFIG_FMNA_LINK_OWNER_PHY_1M
+#define LINK_OWNER_PHY LINK_PHY_1M
+#else
+#define LINK_OWNER_PHY LINK_PHY_ANY
+#endif
+
+static const struct link_policy link_policies[] = {
+	[FMNA_LINK_USE_NONE] = {0},
+	[FMNA_LINK_USE_PAIRING] = {
+		.mtu_max = IS_ENABLED(CONFIG_FMNA_LINK_PAIRING_MTU),
+		.data_len = LINK_DATA_LEN_MAX_IF(CONFIG_FMNA_LINK_PAIRING_DATA_LEN),
+		.phy = LINK_PHY_2M_IF(CONFIG_FMNA_LINK_PAIRING_PHY_2M),
+	},
+	[FMNA_LINK_USE_OWNER] = {
+		.mtu_max = IS_ENABLED(CONFIG_FMNA_LINK_OWNER_MTU),
+		.data_len = LINK_OWNER_DATA_LEN,
+		.phy = LINK_OWNER_PHY,
+	},
+	[FMNA_LINK_USE_UARP] = {
+		.mtu_max = IS_ENABLED(CONFIG_FMNA_LINK_UARP_MTU),
+		.data_len = LINK_DATA_LEN_MAX_IF(CONFIG_FMNA_LINK_UARP_DATA_LEN),
+		.phy = LINK_PHY_2M_IF(CONFIG_FMNA_LINK_UARP_PHY_2M),
+	},
+};
+
+struct fmna_link {
+	struct k_work work;
+	struct bt_conn *conn;
+	enum fmna_link_use use;
+	bool mtu_exchanged;
+#if CONFIG_BT_GATT_CLIENT
+	struct bt_gatt_exchange_params mtu_params;
+#endif
+};
+
+static struct fmna_link links[CONFIG_BT_MAX_CONN];
+static K_MUTEX_DEFINE(links_mutex);
+
+#if CONFIG_BT_GATT_CLIENT
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
+			    struct bt_gatt_exchange_params *params)
+{
+	if (err) {
+		LOG_WRN("FMN link: MTU exchange failed: 0x%02X", err);
+		return;
+	}
+
+	LOG_DBG("FMN link: MTU set to %d", bt_gatt_get_mtu(conn));
+}
+#endif
+
+static void mtu_update(struct fmna_link *link, struct bt_conn *conn)
+{
+#if CONFIG_BT_GATT_CLIENT
+	int err;
+
+	/* The MTU can only be exchanged once on a connection. */
+	if (link->mtu_exchanged) {
+		return;
+	}
+
+	link->mtu_params.func = mtu_exchange_cb;
+
+	err = bt_gatt_exchange_mtu(conn, &link->mtu_params);
+	if (err) {
+		LOG_ERR("bt_gatt_exchange_mtu returned error: %d", err);
+		return;
+	}
+
+	link->mtu_exchanged = true;
+#endif
+}
+
+static void data_len_update(struct bt_conn *conn,
+			    const struct bt_conn_info *conn_info,
+			    enum link_data_len data_len)
+{
+	int err;
+	uint16_t tx_max_len;
+	bool data_len_max = (data_len == LINK_DATA_LEN_MAX);
+
+	if (data_len == LINK_DATA_LEN_ANY) {
+		return;
+	}
+
+	tx_max_len = data_len_max ? BT_GAP_DATA_LEN_MAX : BT_GAP_DATA_LEN_DEFAULT;
+	if (conn_info->le.data_len->tx_max_len == tx_max_len) {
+		return;
+	}
+
+	err = bt_conn_le_data_len_update(conn, data_len_max ?
+					 BT_LE_DATA_LEN_PARAM_MAX :
+					 BT_LE_DATA_LEN_PARAM_DEFAULT);
+	if (err) {
+		LOG_ERR("bt_conn_le_data_len_update returned error: %d", err);
+	}
+}
+
+static void phy_update(struct bt_conn *conn,
+		       const struct bt_conn_info *conn_info,
+		       enum link_phy link_phy)
+{
+	int err;
+	uint8_t phy;
+	bool phy_2m = (link_phy == LINK_PHY_2M);
+
+	if (link_phy == LINK_PHY_ANY) {
+		return;
+	}
+
+	phy = phy_2m ? BT_GAP_LE_PHY_2M : BT_GAP_LE_PHY_1M;
+	if (conn_info->le.phy->tx_phy == phy && conn_info->le.phy->rx_phy == phy) {
+		return;
+	}
+
+	err = bt_conn_le_phy_update(conn, phy_2m ?
+				    BT_CONN_LE_PHY_PARAM_2M :
+				    BT_CONN_LE_PHY_PARAM_1M);
+	if (err) {
+		LOG_ERR("bt_conn_le_phy_update returned error: %d", err);
+	}
+}
+
+static void link_work_handle(struct k_work *item)
+{
+	int err;
+	struct bt_conn *conn;
+	struct bt_conn_info conn_info;
+	struct fmna_link *link = CONTAINER_OF(item, struct fmna_link, work);
+	enum fmna_link_use use;
+	const struct link_policy *policy;
+
+	/* Hold a reference of the connection for the duration of the work, as
+	 * the peer may disconnect while the procedures are being requested.
+	 */
+	k_mutex_lock(&links_mutex, K_FOREVER);
+	if (!link->conn || link->use == FMNA_LINK_USE_NONE) {
+		k_mutex_unlock(&links_mutex);
+		return;
+	}
+
+	conn = bt_conn_ref(link->conn);
+	use = link->use;
+	k_mutex_unlock(&links_mutex);
+
+	err = bt_conn_get_info(conn, &conn_info);
+	if (err) {
+		LOG_ERR("bt_conn_get_info returned error: %d", err);
+		goto exit;
+	}
+
+	if (conn_info.state != BT_CONN_STATE_CONNECTED) {
+		goto exit;
+	}
+
+	LOG_DBG("FMN link: applying policy %d", use);
+
+	policy = &link_policies[use];
+
+	if (policy->mtu_max) {
+		mtu_update(link, conn);
+	}
+
+	data_len_update(conn, &conn_info, policy->data_len);
+	phy_update(conn, &conn_info, policy->phy);
+
+exit:
+	bt_conn_unref(conn);
+}
+
+int fmna_link_use_set(struct bt_conn *conn, enum fmna_link_use use)
+{
+	int err;
+	struct fmna_link *link;
+	struct bt_conn_info conn_info;
+
+	if (!conn || use >= ARRAY_SIZE(link_policies)) {
+		return -EINVAL;
+	}
+
+	link = &links[bt_conn_index(conn)];
+
+	k_mutex_lock(&links_mutex, K_FOREVER);
+
+	if (link->conn != conn) {
+		/* The link state of a disconnected peer would never be
+		 * released, as its disconnection has already been reported.
+		 */
+		err = bt_conn_get_info(conn, &conn_info);
+		if (err || conn_info.state != BT_CONN_STATE_CONNECTED) {
+			k_mutex_unlock(&links_mutex);
+			return -ENOTCONN;
+		}
+
+		link->conn = bt_conn_ref(conn);
+		link->mtu_exchanged = false;
+	} else if (link->use == use) {
+		k_mutex_unlock(&links_mutex);
+		return 0;
+	}
+
+	link->use = use;
+	k_work_submit(&link->work);
+
+	k_mutex_unlock(&links_mutex);
+
+	return 0;
+}
+
+void fmna_link_disconnected(struct bt_conn *conn)
+{
+	struct fmna_link *link = &links[bt_conn_index(conn)];
+
+	k_mutex_lock(&links_mutex, K_FOREVER);
+
+	if (link->conn != conn) {
+		k_mutex_unlock(&links_mutex);
+		return;
+	}
+
+	/* A work item that is already running holds its own reference. */
+	k_work_cancel(&link->work);
+
+	link->conn = NULL;
+	link->use = FMNA_LINK_USE_NONE;
+
+	k_mutex_unlock(&links_mutex);
+
+	bt_conn_unref(conn);
+}
+
+static int link_init(void)
+{
+	/* The work items are initialized once, as the work of a previous
+	 * connection may still be running when its slot is reused.
+	 */
+	for (size_t i = 0; i < ARRAY_SIZE(links); i++) {
+		k_work_init(&links[i].work, link_work_handle);
+	}
+
+	return 0;
+}
+
+SYS_INIT(link_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
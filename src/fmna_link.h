@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef FMNA_LINK_H_
+#define FMNA_LINK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/conn.h>
+
+/* Uses of a FMN connection. Each one has its own policy for the ATT MTU,
+ * the LE Data Length and the PHY of the link.
+ */
+enum fmna_link_use {
+	FMNA_LINK_USE_NONE,
+	FMNA_LINK_USE_PAIRING,
+	FMNA_LINK_USE_OWNER,
+	FMNA_LINK_USE_UARP,
+};
+
+/* Apply the link policy of the use to the connection. The procedures are
+ * requested from the system workqueue.
+ */
+int fmna_link_use_set(struct bt_conn *conn, enum fmna_link_use use);
+
+/* Forget the link state of a disconnected peer. */
+void fmna_link_disconnected(struct bt_conn *conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* FMNA_LINK_H_ */
@@ -48,6 +48,15 @@ static struct sn_counter_update {
 	atomic_t increment;
 } sn_counter_update;
 
+static struct sn_prefetch {
+	uint64_t counter;
+	uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN];
+	bool is_ready;
+} sn_prefetch;
+
+static K_MUTEX_DEFINE(sn_prefetch_mutex);
+static K_SEM_DEFINE(sn_prefetch_sem, 0, 1);
+
 static void nfc_callback(void *context,
 			 nfc_t2t_event_t event,
 			 const uint8_t *data,
@@ -103,6 +112,118 @@ static void sn_counter_update_work_handle(struct k_work *item)
 	}
 }
 
+static void sn_prefetch_clear(void)
+{
+	k_mutex_lock(&sn_prefetch_mutex, K_FOREVER);
+	sn_prefetch.is_ready = false;
+	memset(sn_prefetch.serial_number_enc, 0, sizeof(sn_prefetch.serial_number_enc));
+	k_mutex_unlock(&sn_prefetch_mutex);
+}
+
+#if CONFIG_FMNA_NFC_SN_PREFETCH
+static void sn_prefetch_compute(void)
+{
+	int err;
+	uint64_t counter;
+	uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN];
+
+	k_mutex_lock(&sn_prefetch_mutex, K_FOREVER);
+	if (!paired_state || sn_prefetch.is_ready) {
+		k_mutex_unlock(&sn_prefetch_mutex);
+		return;
+	}
+
+	counter = sn_prefetch.counter;
+	k_mutex_unlock(&sn_prefetch_mutex);
+
+	/* Encrypt without holding the lock. */
+	err = fmna_serial_number_enc_with_counter_get(FMNA_SERIAL_NUMBER_ENC_QUERY_TYPE_TAP,
+						      counter,
+						      serial_number_enc);
+	if (err) {
+		LOG_WRN("FMN NFC: cannot prefetch the encrypted serial number: %d", err);
+		return;
+	}
+
+	/* Drop the result if the target counter changed in the meantime. */
+	k_mutex_lock(&sn_prefetch_mutex, K_FOREVER);
+	if (paired_state && (sn_prefetch.counter == counter)) {
+		memcpy(sn_prefetch.serial_number_enc, serial_number_enc,
+		       sizeof(sn_prefetch.serial_number_enc));
+		sn_prefetch.is_ready = true;
+
+		LOG_DBG("FMN NFC: prefetched the encrypted serial number for counter %llu",
+			counter);
+	}
+	k_mutex_unlock(&sn_prefetch_mutex);
+
+	memset(serial_number_enc, 0, sizeof(serial_number_enc));
+}
+
+static void sn_prefetch_thread_entry_point(void *arg0, void *arg1, void *arg2)
+{
+	while (true) {
+		k_sem_take(&sn_prefetch_sem, K_FOREVER);
+		sn_prefetch_compute();
+	}
+}
+
+#define SN_PREFETCH_THREAD_PRIORITY						\
+	(CONFIG_FMNA_NFC_SN_PREFETCH_THREAD_PRIORITY < CONFIG_NUM_PREEMPT_PRIORITIES ? \
+	 CONFIG_FMNA_NFC_SN_PREFETCH_THREAD_PRIORITY : CONFIG_NUM_PREEMPT_PRIORITIES - 1)
+
+K_THREAD_DEFINE(fmna_nfc_sn_prefetch_thread, CONFIG_FMNA_NFC_SN_PREFETCH_THREAD_STACK_SIZE,
+		sn_prefetch_thread_entry_point, NULL, NULL, NULL,
+		SN_PREFETCH_THREAD_PRIORITY, 0, 0);
+#endif
+
+static int sn_enc_get(uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN])
+{
+	int err;
+	uint64_t counter;
+	bool is_prefetched;
+
+	if (!IS_ENABLED(CONFIG_FMNA_NFC_SN_PREFETCH)) {
+		return fmna_serial_number_enc_get(FMNA_SERIAL_NUMBER_ENC_QUERY_TYPE_TAP,
+						  serial_number_enc);
+	}
+
+	err = fmna_serial_number_enc_counter_get(&counter);
+	if (err) {
+		return err;
+	}
+
+	/* Use the precomputed payload only for the current counter value, so that
+	 * the counter exposed to the reader never goes back.
+	 */
+	k_mutex_lock(&sn_prefetch_mutex, K_FOREVER);
+	is_prefetched = (sn_prefetch.is_ready && (sn_prefetch.counter == counter));
+	if (is_prefetched) {
+		memcpy(serial_number_enc, sn_prefetch.serial_number_enc,
+		       sizeof(sn_prefetch.serial_number_enc));
+	}
+	k_mutex_unlock(&sn_prefetch_mutex);
+
+	if (!is_prefetched) {
+		err = fmna_serial_number_enc_with_counter_get(
+			FMNA_SERIAL_NUMBER_ENC_QUERY_TYPE_TAP, counter, serial_number_enc);
+		if (err) {
+			return err;
+		}
+	}
+
+	/* Prepare the payload for the next tap in the background. */
+	k_mutex_lock(&sn_prefetch_mutex, K_FOREVER);
+	sn_prefetch.is_ready = false;
+	memset(sn_prefetch.serial_number_enc, 0, sizeof(sn_prefetch.serial_number_enc));
+	sn_prefetch.counter = counter + 1;
+	k_mutex_unlock(&sn_prefetch_mutex);
+
+	k_sem_give(&sn_prefetch_sem);
+
+	return 0;
+}
+
 static int fmna_nfc_url_prepare(char *url, size_t url_max_size)
 {
 	int ret;
@@ -150,10 +271,9 @@ static int fmna_nfc_url_prepare(char *url, size_t url_max_size)
 		uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN];
 		char serial_number_enc_str[FMNA_SERIAL_NUMBER_ENC_STR_LEN] = {0};
 
-		ret = fmna_serial_number_enc_get(FMNA_SERIAL_NUMBER_ENC_QUERY_TYPE_TAP,
-						serial_number_enc);
+		ret = sn_enc_get(serial_number_enc);
 		if (ret) {
-			LOG_ERR("FMN NFC: fmna_serial_number_enc_get err %d", ret);
+			LOG_ERR("FMN NFC: sn_enc_get err %d", ret);
 			return ret;
 		}
 
@@ -320,6 +440,7 @@ int fmna_nfc_uninit(void)
 	 */
 	k_work_cancel_delayable(&sn_counter_update.work);
 	atomic_clear(&sn_counter_update.increment);
+	sn_prefetch_clear();
 
 	LOG_INF("FMN NFC: NFC capability is disabled");
 
@@ -354,6 +475,8 @@ static void state_changed(void)
 
 		if (paired_state) {
 			atomic_clear(&sn_counter_update.increment);
+		} else {
+			sn_prefetch_clear();
 		}
 
 		fmna_nfc_buffer_update();
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
  */
 
+#include "fmna_ecies_key_pool.h"
 #include "fmna_keys.h"
 #include "fmna_gatt_fmns.h"
 #include "fmna_pair.h"
@@ -37,6 +38,25 @@ LOG_MODULE_DECLARE(fmna, CONFIG_FMNA_LOG_LEVEL);
 #define SESSION_NONCE_BLEN        32
 #define SEEDS_BLEN                32
 
+/* The ECIES ciphertext starts with the ephemeral public key. */
+#define ECIES_EPHEMERAL_KEY_BLEN  65
+
+/* Number of fragments of the E2 and E4 plaintext messages. */
+#define E2_IOVCNT 8
+#define E4_IOVCNT 6
+
+/* Number of fragments of the S2 verification message. */
+#define S2_VERIF_IOVCNT 6
+
+/* Position of a plaintext message field in the ECIES ciphertext buffer. The
+ * field can be written there and then encrypted in place.
+ */
+#define ECIES_FIELD(_out, _msg_type, _field) \
+	((_out) + ECIES_EPHEMERAL_KEY_BLEN + offsetof(_msg_type, _field))
+
+#define IOVEC(_data, _nbytes) \
+	((struct fm_crypto_iovec) { .data = (_data), .nbytes = (_nbytes) })
+
 /* FMN pairing command and response descriptors. */
 struct __packed fmna_initiate_pairing {
 	uint8_t session_nonce[SESSION_NONCE_BLEN];
@@ -97,10 +117,137 @@ static uint8_t e1[E1_BLEN];
 static uint8_t seedk1[FMNA_SYMMETRIC_KEY_LEN];
 static struct fm_crypto_ckg_context ckg_ctx;
 
+/* Collaborative key generation context precomputed in the pairing mode. */
+static struct ckg_prewarm {
+	struct fm_crypto_ckg_context ctx;
+	uint32_t generation;
+	bool is_requested;
+	bool is_ready;
+} ckg_prewarm;
+
+static K_MUTEX_DEFINE(ckg_prewarm_mutex);
+static K_SEM_DEFINE(ckg_prewarm_sem, 0, 1);
+
 static struct bt_conn *pairing_conn;
 static uint8_t fmna_bt_id;
 static fmna_pair_status_changed_t status_cb;
 
+#if CONFIG_FMNA_PAIRING_CKG_PREWARM
+static void ckg_prewarm_compute(void)
+{
+	int err;
+	uint32_t generation;
+	struct fm_crypto_ckg_context ctx;
+
+	k_mutex_lock(&ckg_prewarm_mutex, K_FOREVER);
+
+	/* The pairing mode may have ended before the thread got to run. */
+	if (!ckg_prewarm.is_requested || ckg_prewarm.is_ready) {
+		k_mutex_unlock(&ckg_prewarm_mutex);
+		return;
+	}
+
+	generation = ckg_prewarm.generation;
+	k_mutex_unlock(&ckg_prewarm_mutex);
+
+	/* Generate without holding the lock, so that the pairing never waits for it. */
+	err = fm_crypto_ckg_init(&ctx);
+	if (err) {
+		LOG_ERR("fmna_pair: fm_crypto_ckg_init returned error: %d", err);
+		return;
+	}
+
+	/* Drop the context if it was discarded in the meantime. */
+	k_mutex_lock(&ckg_prewarm_mutex, K_FOREVER);
+	if (ckg_prewarm.is_requested && !ckg_prewarm.is_ready &&
+	    (ckg_prewarm.generation == generation)) {
+		memcpy(&ckg_prewarm.ctx, &ctx, sizeof(ckg_prewarm.ctx));
+		ckg_prewarm.is_ready = true;
+
+		LOG_DBG("fmna_pair: CKG context precomputed");
+	}
+	k_mutex_unlock(&ckg_prewarm_mutex);
+
+	fm_crypto_ckg_free(&ctx);
+}
+
+static void ckg_prewarm_thread_entry_point(void *arg0, void *arg1, void *arg2)
+{
+	while (true) {
+		k_sem_take(&ckg_prewarm_sem, K_FOREVER);
+		ckg_prewarm_compute();
+	}
+}
+
+#define CKG_PREWARM_THREAD_PRIORITY						\
+	(CONFIG_FMNA_PAIRING_CKG_PREWARM_THREAD_PRIORITY < CONFIG_NUM_PREEMPT_PRIORITIES ? \
+	 CONFIG_FMNA_PAIRING_CKG_PREWARM_THREAD_PRIORITY : CONFIG_NUM_PREEMPT_PRIORITIES - 1)
+
+K_THREAD_DEFINE(fmna_pair_ckg_prewarm_thread, CONFIG_FMNA_PAIRING_CKG_PREWARM_THREAD_STACK_SIZE,
+		ckg_prewarm_thread_entry_point, NULL, NULL, NULL,
+		CKG_PREWARM_THREAD_PRIORITY, 0, 0);
+#endif
+
+void fmna_pair_ckg_prewarm(void)
+{
+	if (!IS_ENABLED(CONFIG_FMNA_PAIRING_CKG_PREWARM)) {
+		return;
+	}
+
+	k_mutex_lock(&ckg_prewarm_mutex, K_FOREVER);
+	ckg_prewarm.is_requested = true;
+	k_mutex_unlock(&ckg_prewarm_mutex);
+
+	k_sem_give(&ckg_prewarm_sem);
+}
+
+void fmna_pair_ckg_discard(void)
+{
+	if (!IS_ENABLED(CONFIG_FMNA_PAIRING_CKG_PREWARM)) {
+		return;
+	}
+
+	/* A generation that is still running is dropped when it completes. */
+	k_mutex_lock(&ckg_prewarm_mutex, K_FOREVER);
+
+	ckg_prewarm.generation++;
+	ckg_prewarm.is_requested = false;
+	ckg_prewarm.is_ready = false;
+	fm_crypto_ckg_free(&ckg_prewarm.ctx);
+
+	k_mutex_unlock(&ckg_prewarm_mutex);
+}
+
+static int ckg_ctx_init(void)
+{
+	bool is_ready = false;
+
+	if (IS_ENABLED(CONFIG_FMNA_PAIRING_CKG_PREWARM)) {
+		k_mutex_lock(&ckg_prewarm_mutex, K_FOREVER);
+
+		/* The precomputed context is used only once. */
+		is_ready = ckg_prewarm.is_ready;
+		if (is_ready) {
+			memcpy(&ckg_ctx, &ckg_prewarm.ctx, sizeof(ckg_ctx));
+
+			ckg_prewarm.is_ready = false;
+			fm_crypto_ckg_free(&ckg_prewarm.ctx);
+		}
+
+		k_mutex_unlock(&ckg_prewarm_mutex);
+
+		if (!is_ready) {
+			LOG_DBG("fmna_pair: no precomputed CKG context, generating it inline");
+		}
+	}
+
+	if (is_ready) {
+		return 0;
+	}
+
+	return fm_crypto_ckg_init(&ckg_ctx);
+}
+
 int fmna_pair_init(uint8_t bt_id, fmna_pair_status_changed_t cb)
 {
 	if (!cb) {
@@ -123,104 +270,120 @@ static void pairing_peer_disconnect(struct bt_conn *conn)
 	}
 }
 
-static int e2_msg_populate(struct fmna_initiate_pairing *init_pairing,
-			   struct e2_encr_msg *e2_encr_msg)
+static int e2_msg_populate(uint8_t *e2, struct fm_crypto_iovec e2_iov[E2_IOVCNT])
 {
 	int err;
 	struct fmna_version ver;
-
-	memcpy(e2_encr_msg->session_nonce,
-	       init_pairing->session_nonce,
-	       sizeof(e2_encr_msg->session_nonce));
-
-	err = fmna_storage_uuid_load(e2_encr_msg->software_auth_uuid);
+	uint32_t fw_version;
+	uint8_t *software_auth_token =
+		ECIES_FIELD(e2, struct e2_encr_msg, software_auth_token);
+	uint8_t *software_auth_uuid =
+		ECIES_FIELD(e2, struct e2_encr_msg, software_auth_uuid);
+	uint8_t *serial_number = ECIES_FIELD(e2, struct e2_encr_msg, serial_number);
+	uint8_t *fw_version_field = ECIES_FIELD(e2, struct e2_encr_msg, fw_version);
+
+	/* Load the fields that are not kept in the pairing state directly into
+	 * the output buffer.
+	 */
+	err = fmna_storage_uuid_load(software_auth_uuid);
 	if (err) {
 		return err;
 	}
 
-	err = fmna_storage_auth_token_load(e2_encr_msg->software_auth_token);
+	err = fmna_storage_auth_token_load(software_auth_token);
 	if (err) {
 		return err;
 	}
 
-	err = fmna_serial_number_get(e2_encr_msg->serial_number);
+	err = fmna_serial_number_get(serial_number);
 	if (err) {
 		LOG_ERR("FMNA Pair: Serial Number read failed");
-		memset(e2_encr_msg->serial_number, 0, sizeof(e2_encr_msg->serial_number));
+		memset(serial_number, 0, FMNA_SERIAL_NUMBER_BLEN);
 	}
 
-	memcpy(e2_encr_msg->e1, init_pairing->e1, sizeof(e2_encr_msg->e1));
-
-	memcpy(e2_encr_msg->seedk1, seedk1, sizeof(e2_encr_msg->seedk1));
-
 	err = fmna_version_fw_get(&ver);
 	if (err) {
 		LOG_ERR("FMNA Pair: Firmware Version read failed");
 		memset(&ver, 0, sizeof(ver));
 	}
 
-	e2_encr_msg->fw_version = FMNA_VERSION_ENCODE(ver);
+	fw_version = FMNA_VERSION_ENCODE(ver);
+	memcpy(fw_version_field, &fw_version, sizeof(fw_version));
 
-	memcpy(e2_encr_msg->product_data, fmna_pp_product_data, sizeof(e2_encr_msg->product_data));
+	/* Fragments in the order of the e2_encr_msg fields. */
+	e2_iov[0] = IOVEC(session_nonce, sizeof(session_nonce));
+	e2_iov[1] = IOVEC(software_auth_token, FMNA_SW_AUTH_TOKEN_BLEN);
+	e2_iov[2] = IOVEC(software_auth_uuid, FMNA_SW_AUTH_UUID_BLEN);
+	e2_iov[3] = IOVEC(serial_number, FMNA_SERIAL_NUMBER_BLEN);
+	e2_iov[4] = IOVEC(fmna_pp_product_data, FMNA_PP_PRODUCT_DATA_LEN);
+	e2_iov[5] = IOVEC(fw_version_field, sizeof(fw_version));
+	e2_iov[6] = IOVEC(e1, sizeof(e1));
+	e2_iov[7] = IOVEC(seedk1, sizeof(seedk1));
 
 	return err;
 }
 
-static int e4_msg_populate(struct e4_encr_msg *e4_encr_msg)
+static int e4_msg_populate(uint8_t *e4, struct fm_crypto_iovec e4_iov[E4_IOVCNT])
 {
 	int err;
-
-	memcpy(e4_encr_msg->session_nonce,
-	       session_nonce,
-	       sizeof(e4_encr_msg->session_nonce));
-
-	err = fmna_storage_uuid_load(e4_encr_msg->software_auth_uuid);
+	uint32_t status = 0;
+	uint8_t *software_auth_uuid =
+		ECIES_FIELD(e4, struct e4_encr_msg, software_auth_uuid);
+	uint8_t *serial_number = ECIES_FIELD(e4, struct e4_encr_msg, serial_number);
+	uint8_t *latest_sw_token = ECIES_FIELD(e4, struct e4_encr_msg, latest_sw_token);
+	uint8_t *status_field = ECIES_FIELD(e4, struct e4_encr_msg, status);
+
+	/* The latest token is expected to be in place already. */
+	err = fmna_storage_uuid_load(software_auth_uuid);
 	if (err) {
 		return err;
 	}
 
-	err = fmna_serial_number_get(e4_encr_msg->serial_number);
+	err = fmna_serial_number_get(serial_number);
 	if (err) {
 		LOG_ERR("FMNA Pair: Serial Number read failed");
-		memset(e4_encr_msg->serial_number, 0, sizeof(e4_encr_msg->serial_number));
+		memset(serial_number, 0, FMNA_SERIAL_NUMBER_BLEN);
 	}
 
-	memcpy(e4_encr_msg->e1, e1, sizeof(e4_encr_msg->e1));
-
-	err = fmna_storage_auth_token_load(e4_encr_msg->latest_sw_token);
-	if (err) {
-		return err;
-	}
+	memcpy(status_field, &status, sizeof(status));
 
-	e4_encr_msg->status = 0;
+	/* Fragments in the order of the e4_encr_msg fields. */
+	e4_iov[0] = IOVEC(software_auth_uuid, FMNA_SW_AUTH_UUID_BLEN);
+	e4_iov[1] = IOVEC(serial_number, FMNA_SERIAL_NUMBER_BLEN);
+	e4_iov[2] = IOVEC(session_nonce, sizeof(session_nonce));
+	e4_iov[3] = IOVEC(e1, sizeof(e1));
+	e4_iov[4] = IOVEC(latest_sw_token, FMNA_SW_AUTH_TOKEN_BLEN);
+	e4_iov[5] = IOVEC(status_field, sizeof(status));
 
-	return err;
+	return 0;
 }
 
 static int s2_verif_msg_populate(struct fmna_finalize_pairing *finalize_cmd,
-				 struct s2_verif_msg *s2_verif_msg)
+				 uint8_t software_auth_uuid[FMNA_SW_AUTH_UUID_BLEN],
+				 uint8_t h1[H1_BLEN],
+				 struct fm_crypto_iovec s2_verif_iov[S2_VERIF_IOVCNT])
 {
 	int err;
 
-	memcpy(s2_verif_msg->session_nonce,
-	       session_nonce,
-	       sizeof(s2_verif_msg->session_nonce));
-
-	err = fmna_storage_uuid_load(s2_verif_msg->software_auth_uuid);
+	err = fmna_storage_uuid_load(software_auth_uuid);
 	if (err) {
 		return err;
 	}
 
-	memcpy(s2_verif_msg->seeds,
-	       finalize_cmd->seeds,
-	       sizeof(s2_verif_msg->seeds));
+	err = fm_crypto_sha256(sizeof(finalize_cmd->c2), finalize_cmd->c2, h1);
+	if (err) {
+		return err;
+	}
 
-	memcpy(s2_verif_msg->e1, e1, sizeof(s2_verif_msg->e1));
-	memcpy(s2_verif_msg->e3, finalize_cmd->e3, sizeof(s2_verif_msg->e3));
+	/* Fragments in the order of the s2_verif_msg fields. */
+	s2_verif_iov[0] = IOVEC(software_auth_uuid, FMNA_SW_AUTH_UUID_BLEN);
+	s2_verif_iov[1] = IOVEC(session_nonce, sizeof(session_nonce));
+	s2_verif_iov[2] = IOVEC(finalize_cmd->seeds, sizeof(finalize_cmd->seeds));
+	s2_verif_iov[3] = IOVEC(h1, H1_BLEN);
+	s2_verif_iov[4] = IOVEC(e1, sizeof(e1));
+	s2_verif_iov[5] = IOVEC(finalize_cmd->e3, sizeof(finalize_cmd->e3));
 
-	return fm_crypto_sha256(sizeof(finalize_cmd->c2),
-				finalize_cmd->c2,
-				s2_verif_msg->h1);
+	return 0;
 }
 
 static int pairing_data_generate(struct net_buf_simple *buf)
@@ -229,12 +392,13 @@ static int pairing_data_generate(struct net_buf_simple *buf)
 	uint8_t c1[C1_BLEN];
 	uint8_t *e2;
 	uint32_t e2_blen;
-	struct e2_encr_msg e2_encr_msg = {0};
+	struct fm_crypto_iovec e2_iov[E2_IOVCNT];
 	struct fmna_initiate_pairing *initiate_cmd =
 		(struct fmna_initiate_pairing *) buf->data;
 
 	/* Store the command parameters that are required by the
-	 * successive pairing operations.
+	 * successive pairing operations. The command is overwritten
+	 * by the response.
 	 */
 	memcpy(session_nonce, initiate_cmd->session_nonce,
 	       sizeof(session_nonce));
@@ -253,25 +417,36 @@ static int pairing_data_generate(struct net_buf_simple *buf)
 		return err;
 	}
 
-	err = e2_msg_populate(initiate_cmd, &e2_encr_msg);
-	if (err) {
-		LOG_ERR("e2_msg_populate err %d", err);
-		return err;
-	}
-
 	e2_blen = E2_BLEN;
 
 	/* Prepare Send Pairing Data response */
 	net_buf_simple_add_mem(buf, c1, sizeof(c1));
 	e2 = net_buf_simple_add(buf, e2_blen);
 
-	err = fm_crypto_encrypt_to_server(fmna_pp_server_encryption_key,
-					  sizeof(e2_encr_msg),
-					  (const uint8_t *) &e2_encr_msg,
-					  &e2_blen,
-					  e2);
+	err = e2_msg_populate(e2, e2_iov);
 	if (err) {
-		LOG_ERR("fm_crypto_encrypt_to_server err %d", err);
+		LOG_ERR("e2_msg_populate err %d", err);
+
+		/* Do not leave the plaintext fields in the response. */
+		memset(e2, 0, e2_blen);
+		return err;
+	}
+
+	if (IS_ENABLED(CONFIG_FMNA_ECIES_KEY_POOL)) {
+		err = fmna_ecies_key_pool_encrypt_to_server_v(fmna_pp_server_encryption_key,
+							      e2_iov,
+							      ARRAY_SIZE(e2_iov),
+							      &e2_blen,
+							      e2);
+	} else {
+		err = fm_crypto_encrypt_to_server_v(fmna_pp_server_encryption_key,
+						    e2_iov,
+						    ARRAY_SIZE(e2_iov),
+						    &e2_blen,
+						    e2);
+	}
+	if (err) {
+		LOG_ERR("fm_crypto_encrypt_to_server_v err %d", err);
 		return err;
 	}
 
@@ -282,15 +457,18 @@ static int pairing_status_generate(struct net_buf_simple *buf)
 {
 	int err;
 	uint8_t *status_data;
+	uint8_t *latest_sw_token;
 	uint32_t e3_decrypt_plaintext_blen;
 	uint32_t e4_blen;
 	uint8_t c2[C2_BLEN];
 	uint8_t server_shared_secret[FMNA_SERVER_SHARED_SECRET_LEN];
+	uint8_t software_auth_uuid[FMNA_SW_AUTH_UUID_BLEN];
+	uint8_t h1[H1_BLEN];
 	uint64_t sn_query_count = 0;
 	union {
-		struct e4_encr_msg  e4_encr;
-		struct s2_verif_msg s2_verif;
-	} msg = {0};
+		struct fm_crypto_iovec s2_verif[S2_VERIF_IOVCNT];
+		struct fm_crypto_iovec e4[E4_IOVCNT];
+	} iov;
 	struct fmna_finalize_pairing *finalize_cmd =
 		(struct fmna_finalize_pairing *) buf->data;
 
@@ -304,40 +482,51 @@ static int pairing_status_generate(struct net_buf_simple *buf)
 	}
 
 	/* Validate S2 */
-	err = s2_verif_msg_populate(finalize_cmd, &msg.s2_verif);
+	err = s2_verif_msg_populate(finalize_cmd, software_auth_uuid, h1, iov.s2_verif);
 	if (err) {
 		LOG_ERR("s2_verif_msg_populate err %d", err);
 		return err;
 	}
 
-	err = fm_crypto_verify_s2(fmna_pp_server_sig_verification_key,
-				  sizeof(finalize_cmd->s2),
-				  finalize_cmd->s2,
-				  sizeof(msg.s2_verif),
-				  (const uint8_t *) &msg.s2_verif);
+	if (IS_ENABLED(CONFIG_FMNA_SERVER_SIG_VERIFICATION_TABLE)) {
+		err = fm_crypto_verify_s2_with_table_v(&fmna_pp_server_sig_verification_table,
+						       sizeof(finalize_cmd->s2),
+						       finalize_cmd->s2,
+						       iov.s2_verif,
+						       ARRAY_SIZE(iov.s2_verif));
+	} else {
+		err = fm_crypto_verify_s2_v(fmna_pp_server_sig_verification_key,
+					    sizeof(finalize_cmd->s2),
+					    finalize_cmd->s2,
+					    iov.s2_verif,
+					    ARRAY_SIZE(iov.s2_verif));
+	}
 	if (err) {
 		LOG_ERR("fm_crypto_verify_s2 err %d", err);
 		return err;
 	}
 
-	/* Use E4 encryption message descriptor to store the new token. */
-	memset(msg.e4_encr.latest_sw_token, 0,
-	       sizeof(msg.e4_encr.latest_sw_token));
-
-	/* Decrypt E3 message. */
-	e3_decrypt_plaintext_blen = sizeof(msg.e4_encr.latest_sw_token);
-	err = fm_crypto_decrypt_e3((const uint8_t *) server_shared_secret,
-				   sizeof(finalize_cmd->e3),
-				   (const uint8_t *) finalize_cmd->e3,
-				   &e3_decrypt_plaintext_blen,
-				   msg.e4_encr.latest_sw_token);
+	/* Decrypt E3 message within the command buffer. The new token is the
+	 * whole plaintext.
+	 */
+	err = fm_crypto_decrypt_e3_in_place((const uint8_t *) server_shared_secret,
+					    sizeof(finalize_cmd->e3),
+					    finalize_cmd->e3,
+					    &e3_decrypt_plaintext_blen);
 	if (err) {
-		LOG_ERR("fm_crypto_decrypt_e3 err %d", err);
+		LOG_ERR("fm_crypto_decrypt_e3_in_place err %d", err);
 		return err;
 	}
 
+	if (e3_decrypt_plaintext_blen != FMNA_SW_AUTH_TOKEN_BLEN) {
+		LOG_ERR("fmna_pair: invalid E3 plaintext length: %d", e3_decrypt_plaintext_blen);
+		return -EINVAL;
+	}
+
+	latest_sw_token = finalize_cmd->e3;
+
 	/* Update the SW Authentication Token in the storage module. */
-	err = fmna_storage_auth_token_update(msg.e4_encr.latest_sw_token);
+	err = fmna_storage_auth_token_update(latest_sw_token);
 	if (err) {
 		LOG_ERR("fmna_storage_auth_token_update err %d", err);
 		return err;
@@ -355,6 +544,8 @@ static int pairing_status_generate(struct net_buf_simple *buf)
 		return err;
 	}
 
+	fmna_serial_number_ksn_cache_clear();
+
 	err = fmna_storage_pairing_item_store(FMNA_STORAGE_SN_QUERY_COUNTER_ID,
 					      (uint8_t *) &sn_query_count,
 					      sizeof(sn_query_count));
@@ -384,21 +575,36 @@ static int pairing_status_generate(struct net_buf_simple *buf)
 	status_data = net_buf_simple_add(buf, sizeof(uint32_t));
 	memset(status_data, 0, sizeof(uint32_t));
 
-	err = e4_msg_populate(&msg.e4_encr);
+	e4_blen = E4_BLEN;
+	status_data = net_buf_simple_add(buf, e4_blen);
+
+	/* Move the new token from the command to its E4 field in the response.
+	 * Both are located in the same buffer and the areas may overlap.
+	 */
+	memmove(ECIES_FIELD(status_data, struct e4_encr_msg, latest_sw_token),
+		latest_sw_token, FMNA_SW_AUTH_TOKEN_BLEN);
+
+	err = e4_msg_populate(status_data, iov.e4);
 	if (err) {
 		LOG_ERR("e4_msg_populate err %d", err);
 		return err;
 	}
 
-	e4_blen = E4_BLEN;
-	status_data = net_buf_simple_add(buf, e4_blen);
-	err = fm_crypto_encrypt_to_server(fmna_pp_server_encryption_key,
-					  sizeof(msg.e4_encr),
-					  (const uint8_t *) &msg.e4_encr,
-					  &e4_blen,
-					  status_data);
+	if (IS_ENABLED(CONFIG_FMNA_ECIES_KEY_POOL)) {
+		err = fmna_ecies_key_pool_encrypt_to_server_v(fmna_pp_server_encryption_key,
+							      iov.e4,
+							      ARRAY_SIZE(iov.e4),
+							      &e4_blen,
+							      status_data);
+	} else {
+		err = fm_crypto_encrypt_to_server_v(fmna_pp_server_encryption_key,
+						    iov.e4,
+						    ARRAY_SIZE(iov.e4),
+						    &e4_blen,
+						    status_data);
+	}
 	if (err) {
-		LOG_ERR("fm_crypto_encrypt_to_server err %d", err);
+		LOG_ERR("fm_crypto_encrypt_to_server_v err %d", err);
 		return err;
 	}
 
@@ -521,6 +727,8 @@ static void fmna_peer_disconnected(struct bt_conn *conn)
 
 		LOG_WRN("FMN pairing has failed");
 
+		fm_crypto_ckg_free(&ckg_ctx);
+
 		err = bt_unpair(fmna_bt_id, bt_conn_get_dst(conn));
 		if (err) {
 			LOG_ERR("fmna_pair: bt_unpair returned error: %d", err);
@@ -547,9 +755,9 @@ static void fmna_peer_security_changed(struct bt_conn *conn, bt_security_t level
 
 	/* Find My pairing has started. */
 	if (!pairing_conn) {
-		err = fm_crypto_ckg_init(&ckg_ctx);
+		err = ckg_ctx_init();
 		if (err) {
-			LOG_ERR("fm_crypto_ckg_init returned error: %d", err);
+			LOG_ERR("ckg_ctx_init returned error: %d", err);
 		}
 
 		pairing_conn = conn;
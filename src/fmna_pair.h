@@ -24,6 +24,14 @@ typedef void (*fmna_pair_status_changed_t)(struct bt_conn *conn,
 
 int fmna_pair_init(uint8_t bt_id, fmna_pair_status_changed_t cb);
 
+/* Precompute the collaborative key generation context in the background,
+ * so that it is ready when the next pairing attempt starts.
+ */
+void fmna_pair_ckg_prewarm(void);
+
+/* Zeroize the precomputed collaborative key generation context. */
+void fmna_pair_ckg_discard(void);
+
 #ifdef __cplusplus
 }
 #endif
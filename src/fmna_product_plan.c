@@ -29,4 +29,85 @@ const uint8_t fmna_pp_server_sig_verification_key[] = {
 	0x04, 0x33, 0x4c, 0x5a, 0x73, 0xfd, 0x61, 0xdf, 0x36, 0x43, 0x3f, 0xbc, 0x69, 0x92, 0x36, 0xe3, 0x98, 0xe4, 0x94, 0x12, 0xf3, 0xc0, 0xfd, 0xc4, 0xe5, 0xda, 0x0b, 0x41, 0x18, 0x77, 0x95, 0x17, 0x08, 0x71, 0x20, 0x88, 0x8e, 0x97, 0x92, 0x37, 0x76, 0xba, 0x48, 0xdc, 0x51, 0x7c, 0x0f, 0xa8, 0x7b, 0x9c, 0x62, 0xa9, 0xfe, 0xe9, 0x6b, 0x0f, 0x38, 0x40, 0x3f, 0x66, 0x9e, 0x1e, 0x67, 0x55, 0x60
 };
 
+#if CONFIG_FMNA_SERVER_SIG_VERIFICATION_TABLE
+/* Comb table of Q_A, generated with src/crypto/scripts/gen_p256_comb_table.py */
+const fm_crypto_p256_comb_table fmna_pp_server_sig_verification_table = { .t = {
+	/* Combination 1 */
+	{ .x = { 0x9a33c5f4, 0x94e42c51, 0x31a3e1c5, 0xabe8f6ee,
+		 0x0d46193c, 0x0efdb9da, 0x505db6d4, 0x9671ae88 },
+	  .y = { 0xf45955bc, 0xea9f3103, 0xc2d21cdf, 0x1b663cb8,
+		 0xda98cb3a, 0x8f08f6e7, 0x0499d7d4, 0xb5a2b109 } },
+	/* Combination 2 */
+	{ .x = { 0xabc7ed16, 0x392675f2, 0x9291adec, 0x3a37056d,
+		 0xf4263373, 0x9ef8a4a4, 0xa612ab4f, 0xf56323d1 },
+	  .y = { 0xba3bec0a, 0xf6d2be99, 0x144be203, 0xb0be1f01,
+		 0x8b5c13c0, 0xdc88842b, 0x97e3c835, 0x77d28b1d } },
+	/* Combination 3 */
+	{ .x = { 0xd15801f1, 0xeb128e90, 0x0ed49332, 0x9162029b,
+		 0x81d49b45, 0x6958651d, 0x12ec05fb, 0xc64eea61 },
+	  .y = { 0x4d4a76a9, 0xbe053b1b, 0x852c4613, 0x11b3ec1d,
+		 0xcd99dbb8, 0x9e376f74, 0x1bc9790e, 0xe36cc730 } },
+	/* Combination 4 */
+	{ .x = { 0xd5839d83, 0xd239a265, 0xba70bde4, 0xa8334040,
+		 0xf118f739, 0xb293eaea, 0x00f42a71, 0x3376f4aa },
+	  .y = { 0x52740d0a, 0xcf07f41c, 0x80dd09c3, 0x5fdfc87a,
+		 0x5a7ad0cd, 0x152c66b8, 0x90d4941a, 0xbd78630b } },
+	/* Combination 5 */
+	{ .x = { 0xfeff5e78, 0x9e1008a7, 0x5b7c9f31, 0x824ab068,
+		 0x237889a0, 0xc9ba5871, 0xc8480fd5, 0x72ea107f },
+	  .y = { 0x17428fbd, 0x6712542e, 0x7d869181, 0xd13814b2,
+		 0xf600c64e, 0xba2d5a39, 0x1fb65bb4, 0xf390104e } },
+	/* Combination 6 */
+	{ .x = { 0xccb5a157, 0x08e4d1b1, 0xc4429a6d, 0x0b7f2c81,
+		 0x58c6989a, 0x532f0c83, 0x48c4bde0, 0xbd834f6b },
+	  .y = { 0xfe3af816, 0x6321d807, 0x35c29b2b, 0xd1668cf2,
+		 0x6bde160b, 0x36659aae, 0xffdbd48a, 0xd712375d } },
+	/* Combination 7 */
+	{ .x = { 0x169a9899, 0x62da8f81, 0x26c2bb5c, 0xed6028ea,
+		 0xe0a8473d, 0x27b24bf7, 0x7bed9dec, 0x49b230c4 },
+	  .y = { 0x92b2237c, 0xf2fe69d0, 0x93a034c2, 0x27ff11a1,
+		 0x3403526a, 0xbffb1671, 0x1fe10586, 0x47a00c9e } },
+	/* Combination 8 */
+	{ .x = { 0xe0769c02, 0xf2af72e9, 0xb0d406b2, 0x85853af9,
+		 0xab87023a, 0x2848d54f, 0x65b91f4e, 0x112c2a20 },
+	  .y = { 0xf3944479, 0x7cea22e3, 0xeaa34028, 0xc4f61f69,
+		 0xc80a9b26, 0xe1e14e3b, 0x1a5217ad, 0xc69453b6 } },
+	/* Combination 9 */
+	{ .x = { 0xa526751d, 0x11903755, 0x78262c63, 0x7b9c3ce2,
+		 0xdcf9e6fa, 0x077ad28e, 0x108275b7, 0x7520b279 },
+	  .y = { 0xc4ac46ba, 0x612359ee, 0x29534745, 0x9736847e,
+		 0x044f5a0a, 0x2da80e4e, 0x394fbeaf, 0xbc2b1031 } },
+	/* Combination 10 */
+	{ .x = { 0xbc239fc7, 0x84ae1899, 0xc6389c92, 0x3931f91a,
+		 0xcc3c3d3c, 0x28eb5181, 0xed877c6e, 0x83944870 },
+	  .y = { 0x321ca86e, 0x6a0b3350, 0x466eaa10, 0x1814148f,
+		 0x9236fefd, 0x217e5302, 0x200bc466, 0xfb6cbfac } },
+	/* Combination 11 */
+	{ .x = { 0x11afc166, 0xc3c17d03, 0x8578ee3a, 0x38cd4e39,
+		 0x2ba9e9fd, 0xbc91d68a, 0x6dc1e31e, 0x0f4c62b3 },
+	  .y = { 0x1f9830f3, 0x22015e3b, 0xe5f6c5bb, 0x66d5aefe,
+		 0x4f98e0ff, 0xb7aab330, 0x5c57fd58, 0xd018350a } },
+	/* Combination 12 */
+	{ .x = { 0x444fadb4, 0x5be54e71, 0x6df82c7f, 0x2372e2ee,
+		 0x5e2890d5, 0x3e26192b, 0x2dfeb4a6, 0x0349ac60 },
+	  .y = { 0x28f67b0b, 0xc525c58d, 0x29e3c9d6, 0x2079224f,
+		 0x353723f2, 0xdd200b7b, 0xd84d9b72, 0x51b9ddea } },
+	/* Combination 13 */
+	{ .x = { 0xfda9223a, 0x321467c9, 0xaab0b266, 0xda8e5886,
+		 0x85f524ec, 0xdea3860c, 0x964c315e, 0x86f95b07 },
+	  .y = { 0x4a8fc71f, 0x7113d62a, 0x06ca4b88, 0x2ed6c5e1,
+		 0x3fc85be4, 0x0c4f517f, 0x803d2b32, 0x93304776 } },
+	/* Combination 14 */
+	{ .x = { 0x3a1cafd5, 0x264df3b2, 0x3458bf57, 0xbedcfb50,
+		 0xeb18c40a, 0xb657d75e, 0x1f10dc0e, 0x6dfe4c01 },
+	  .y = { 0x7a1b34e7, 0xc8f60244, 0x79fb22fc, 0x009e79e2,
+		 0x91e6e30d, 0x1e019733, 0x7d2b3d68, 0xde3e6e16 } },
+	/* Combination 15 */
+	{ .x = { 0x18a6b51e, 0xe47c0e44, 0x90e3e461, 0x1a3a6584,
+		 0x822b9373, 0xbc32b5b1, 0x2055f028, 0xb7d1d40d },
+	  .y = { 0x8c78ad40, 0xc47b9ff2, 0xc29be237, 0x16b265da,
+		 0x65dc8d1a, 0x09153ee1, 0x804f7505, 0xf2a01088 } },
+} };
+#endif
+
 #endif
@@ -13,6 +13,8 @@ extern "C" {
 
 #include <zephyr/kernel.h>
 
+#include "crypto/fm_crypto_p256.h"
+
 #define FMNA_PP_PRODUCT_DATA_LEN                8
 #define FMNA_PP_SERVER_ENCRYPTION_KEY_LEN       65
 #define FMNA_PP_SERVER_SIG_VERIFICATION_KEY_LEN 65
@@ -23,6 +25,8 @@ extern const uint8_t fmna_pp_server_encryption_key[FMNA_PP_SERVER_ENCRYPTION_KEY
 
 extern const uint8_t fmna_pp_server_sig_verification_key[FMNA_PP_SERVER_SIG_VERIFICATION_KEY_LEN];
 
+extern const fm_crypto_p256_comb_table fmna_pp_server_sig_verification_table;
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,6 +9,7 @@
 #include "crypto/fm_crypto.h"
 #include "events/fmna_event.h"
 #include "events/fmna_owner_event.h"
+#include "fmna_ecies_key_pool.h"
 #include "fmna_gatt_fmns.h"
 #include "fmna_product_plan.h"
 #include "fmna_serial_number.h"
@@ -55,6 +56,12 @@ static K_TIMER_DEFINE(sn_lookup_timer, sn_lookup_timeout_handle, NULL);
 
 static bool is_lookup_enabled = false;
 
+/* HMAC state keyed with KSN, valid from pairing until unpairing. */
+static struct fm_crypto_ksn_hmac ksn_hmac;
+static bool is_ksn_hmac_cached = false;
+
+static K_MUTEX_DEFINE(ksn_hmac_mutex);
+
 static void sn_lookup_timeout_handle(struct k_timer *timer_id)
 {
 	is_lookup_enabled = false;
@@ -169,14 +176,96 @@ int fmna_serial_number_get(uint8_t serial_number[FMNA_SERIAL_NUMBER_BLEN])
 	return 0;
 }
 
+static int ksn_hmac_authenticate(const struct sn_hmac_payload *sn_hmac_payload,
+				 uint8_t hmac[SN_PAYLOAD_HMAC_LEN])
+{
+	int err;
+	uint8_t server_shared_secret[FMNA_SERVER_SHARED_SECRET_LEN];
+
+	k_mutex_lock(&ksn_hmac_mutex, K_FOREVER);
+
+	if (!is_ksn_hmac_cached) {
+		err = fmna_storage_pairing_item_load(FMNA_STORAGE_SERVER_SHARED_SECRET_ID,
+						     server_shared_secret,
+						     sizeof(server_shared_secret));
+		if (err) {
+			LOG_ERR("fmna_serial_number: fmna_storage_pairing_item_load err %d", err);
+			goto finish;
+		}
+
+		err = fm_crypto_ksn_hmac_init(&ksn_hmac, server_shared_secret);
+		memset(server_shared_secret, 0, sizeof(server_shared_secret));
+		if (err) {
+			LOG_ERR("fmna_serial_number: fm_crypto_ksn_hmac_init err %d", err);
+			goto finish;
+		}
+
+		is_ksn_hmac_cached = true;
+	}
+
+	err = fm_crypto_authenticate_with_ksn_hmac(&ksn_hmac,
+						   sizeof(*sn_hmac_payload),
+						   (const uint8_t *) sn_hmac_payload,
+						   hmac);
+	if (err) {
+		LOG_ERR("fmna_serial_number: fm_crypto_authenticate_with_ksn_hmac err %d", err);
+	}
+
+finish:
+	k_mutex_unlock(&ksn_hmac_mutex);
+
+	return err;
+}
+
+void fmna_serial_number_ksn_cache_clear(void)
+{
+	k_mutex_lock(&ksn_hmac_mutex, K_FOREVER);
+
+	fm_crypto_ksn_hmac_free(&ksn_hmac);
+	is_ksn_hmac_cached = false;
+
+	k_mutex_unlock(&ksn_hmac_mutex);
+}
+
+int fmna_serial_number_enc_counter_get(uint64_t *counter)
+{
+	int err;
+
+	err = fmna_storage_pairing_item_load(FMNA_STORAGE_SN_QUERY_COUNTER_ID,
+					     (uint8_t *) counter,
+					     sizeof(*counter));
+	if (err) {
+		LOG_ERR("fmna_serial_number: fmna_storage_pairing_item_load err %d", err);
+		return err;
+	}
+
+	return 0;
+}
+
 int fmna_serial_number_enc_get(enum fmna_serial_number_enc_query_type query_type,
 			       uint8_t sn_response[FMNA_SERIAL_NUMBER_ENC_BLEN])
 {
 	int err;
 	uint64_t counter;
+
+	/* Clear the encrypted serial number initially in case of error. */
+	memset(sn_response, 0, FMNA_SERIAL_NUMBER_ENC_BLEN);
+
+	err = fmna_serial_number_enc_counter_get(&counter);
+	if (err) {
+		return err;
+	}
+
+	return fmna_serial_number_enc_with_counter_get(query_type, counter, sn_response);
+}
+
+int fmna_serial_number_enc_with_counter_get(enum fmna_serial_number_enc_query_type query_type,
+					    uint64_t counter,
+					    uint8_t sn_response[FMNA_SERIAL_NUMBER_ENC_BLEN])
+{
+	int err;
 	struct sn_hmac_payload sn_hmac_payload;
 	struct sn_payload sn_payload;
-	uint8_t server_shared_secret[FMNA_SERVER_SHARED_SECRET_LEN];
 
 	/* Clear the encrypted serial number initially in case of error. */
 	memset(sn_response, 0, FMNA_SERIAL_NUMBER_ENC_BLEN);
@@ -185,14 +274,6 @@ int fmna_serial_number_enc_get(enum fmna_serial_number_enc_query_type query_type
 	memset(&sn_payload, 0, sizeof(sn_payload));
 	memset(&sn_hmac_payload, 0, sizeof(sn_hmac_payload));
 
-	err = fmna_storage_pairing_item_load(FMNA_STORAGE_SN_QUERY_COUNTER_ID,
-					     (uint8_t *) &counter,
-					     sizeof(counter));
-	if (err) {
-		LOG_ERR("fmna_serial_number: fmna_storage_pairing_item_load err %d", err);
-		return err;
-	}
-
 	sn_payload.counter = counter;
 	sn_hmac_payload.counter = counter;
 
@@ -219,29 +300,25 @@ int fmna_serial_number_enc_get(enum fmna_serial_number_enc_query_type query_type
 		return -EINVAL;
 	}
 
-	err = fmna_storage_pairing_item_load(FMNA_STORAGE_SERVER_SHARED_SECRET_ID,
-					     server_shared_secret,
-					     sizeof(server_shared_secret));
-	if (err) {
-		LOG_ERR("fmna_serial_number: fmna_storage_pairing_item_load err %d", err);
-		return err;
-	}
-
-	err = fm_crypto_authenticate_with_ksn(server_shared_secret,
-					      sizeof(sn_hmac_payload),
-					      (const uint8_t *) &sn_hmac_payload,
-					      sn_payload.hmac);
+	err = ksn_hmac_authenticate(&sn_hmac_payload, sn_payload.hmac);
 	if (err) {
-		LOG_ERR("fmna_serial_number: fm_crypto_authenticate_with_ksn err %d", err);
 		return err;
 	}
 
 	uint32_t sn_response_len = FMNA_SERIAL_NUMBER_ENC_BLEN;
-	err = fm_crypto_encrypt_to_server(fmna_pp_server_encryption_key,
-					  sizeof(sn_payload),
-					  (const uint8_t *) &sn_payload,
-					  &sn_response_len,
-					  sn_response);
+	if (IS_ENABLED(CONFIG_FMNA_ECIES_KEY_POOL)) {
+		err = fmna_ecies_key_pool_encrypt_to_server(fmna_pp_server_encryption_key,
+							    sizeof(sn_payload),
+							    (const uint8_t *) &sn_payload,
+							    &sn_response_len,
+							    sn_response);
+	} else {
+		err = fm_crypto_encrypt_to_server(fmna_pp_server_encryption_key,
+						  sizeof(sn_payload),
+						  (const uint8_t *) &sn_payload,
+						  &sn_response_len,
+						  sn_response);
+	}
 	if (err) {
 		LOG_ERR("fmna_serial_number: fm_crypto_encrypt_to_server err %d", err);
 
@@ -262,11 +339,8 @@ int fmna_serial_number_enc_counter_increase(uint32_t increment)
 
 	__ASSERT(increment > 0, "fmna serial number increment must be greater than zero");
 
-	err = fmna_storage_pairing_item_load(FMNA_STORAGE_SN_QUERY_COUNTER_ID,
-					     (uint8_t *) &counter,
-					     sizeof(counter));
+	err = fmna_serial_number_enc_counter_get(&counter);
 	if (err) {
-		LOG_ERR("fmna_serial_number: fmna_storage_pairing_item_load err %d", err);
 		return err;
 	}
 
@@ -27,8 +27,20 @@ int fmna_serial_number_enc_get(
 	enum fmna_serial_number_enc_query_type query_type,
 	uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN]);
 
+int fmna_serial_number_enc_with_counter_get(
+	enum fmna_serial_number_enc_query_type query_type,
+	uint64_t counter,
+	uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN]);
+
+int fmna_serial_number_enc_counter_get(uint64_t *counter);
+
 int fmna_serial_number_enc_counter_increase(uint32_t increment);
 
+/* Drop the cached KSN state. Call it whenever the Server Shared Secret is
+ * written or erased so that the stale key is not used for the next request.
+ */
+void fmna_serial_number_ksn_cache_clear(void);
+
 
 #ifdef __cplusplus
 }
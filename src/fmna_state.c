@@ -11,6 +11,7 @@
 #include "fmna_gatt_fmns.h"
 #include "fmna_keys.h"
 #include "fmna_pair.h"
+#include "fmna_serial_number.h"
 #include "fmna_state.h"
 
 #include <zephyr/bluetooth/conn.h>
@@ -74,6 +75,9 @@ static int unpaired_adv_start(bool change_address)
 		return err;
 	}
 
+	/* Prepare the key generation for the next pairing attempt. */
+	fmna_pair_ckg_prewarm();
+
 	return err;
 }
 
@@ -240,6 +244,8 @@ static int state_set(struct bt_conn *conn, enum fmna_state new_state)
 				return err;
 			}
 
+			fmna_serial_number_ksn_cache_clear();
+
 			unpair_pending = false;
 			persistent_conn_adv = false;
 			nearby_separated_timeout = NEARBY_SEPARATED_TIMEOUT_DEFAULT;
@@ -273,6 +279,7 @@ static int state_set(struct bt_conn *conn, enum fmna_state new_state)
 		if (prev_state == FMNA_STATE_UNPAIRED) {
 			pairing_mode = false;
 			k_work_cancel_delayable(&pairing_mode_timeout_work);
+			fmna_pair_ckg_discard();
 		}
 
 		is_maintained = true;
@@ -361,6 +368,7 @@ static int state_set(struct bt_conn *conn, enum fmna_state new_state)
 		unpair_pending = false;
 		persistent_conn_adv = false;
 		pairing_mode = false;
+		fmna_pair_ckg_discard();
 	}
 
 	if (prev_state == FMNA_STATE_DISABLED) {
@@ -432,6 +440,7 @@ static void pairing_mode_timeout_work_handle(struct k_work *item)
 	fmna_adv_stop();
 
 	pairing_mode = false;
+	fmna_pair_ckg_discard();
 
 	if (pairing_mode_timeout_cb) {
 		pairing_mode_timeout_cb();
@@ -557,6 +566,7 @@ int fmna_pairing_mode_cancel(void)
 
 	pairing_mode = false;
 	k_work_cancel_delayable(&pairing_mode_timeout_work);
+	fmna_pair_ckg_discard();
 
 	err = fmna_adv_stop();
 	if (err) {
@@ -700,6 +710,55 @@ int fmna_state_pairing_failed_cb_register(fmna_state_pairing_failed_t cb)
 	return 0;
 }
 
+/* Encode the advertising payload for the keys of the next rotation so that
+ * the rotation only needs to swap it in.
+ */
+static void paired_adv_next_prepare(void)
+{
+	int err;
+	uint8_t primary_key[FMNA_PUBLIC_KEY_LEN];
+	uint8_t separated_key[FMNA_PUBLIC_KEY_LEN];
+
+	err = fmna_keys_next_keys_get(primary_key, separated_key);
+	if (err) {
+		LOG_DBG("Next keys are not available for the advertising: %d", err);
+		return;
+	}
+
+	switch (state) {
+	case FMNA_STATE_CONNECTED:
+	case FMNA_STATE_NEARBY:
+	{
+		struct fmna_adv_nearby_config config;
+
+		memcpy(config.primary_key, primary_key, sizeof(config.primary_key));
+		config.fast_mode = persistent_conn_adv;
+		config.is_maintained = (state == FMNA_STATE_CONNECTED);
+
+		err = fmna_adv_prepare_nearby(&config);
+		break;
+	}
+	case FMNA_STATE_SEPARATED:
+	{
+		struct fmna_adv_separated_config config;
+
+		memcpy(config.primary_key, primary_key, sizeof(config.primary_key));
+		memcpy(config.separated_key, separated_key, sizeof(config.separated_key));
+		config.fast_mode = persistent_conn_adv;
+		config.is_maintained = false;
+
+		err = fmna_adv_prepare_separated(&config);
+		break;
+	}
+	default:
+		return;
+	}
+
+	if (err) {
+		LOG_ERR("fmna_adv_prepare returned error: %d", err);
+	}
+}
+
 static void fmna_public_keys_changed(struct fmna_public_keys_changed *keys_changed)
 {
 	/* Set the maintained status. */
@@ -710,12 +769,12 @@ static void fmna_public_keys_changed(struct fmna_public_keys_changed *keys_chang
 		return;
 	}
 
-	if ((state == FMNA_STATE_SEPARATED) &&
-	    !keys_changed->separated_key_changed) {
-		return;
+	if ((state != FMNA_STATE_SEPARATED) ||
+	    keys_changed->separated_key_changed) {
+		advertise_restart_on_no_state_change();
 	}
 
-	advertise_restart_on_no_state_change();
+	paired_adv_next_prepare();
 }
 
 static void nearby_timeout_set_request_handle(struct bt_conn *conn, uint16_t nearby_timeout)
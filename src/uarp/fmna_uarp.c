@@ -79,6 +79,8 @@ static struct fmna_uarp_accessory
 	struct net_buf_simple *pending_buf;
 	ocrypto_sha256_ctx hash_ctx;
 	fmna_uarp_send_message_fn send_message;
+	fmna_uarp_transfer_state_fn transfer_state;
+	bool transfer_active;
 	uint32_t last_error;
 	enum asset_state state;
 	uint8_t payload_hash[ocrypto_sha256_BYTES];
@@ -87,6 +89,9 @@ static struct fmna_uarp_accessory
 } accessory;
 
 static int64_t payload_ready_timestamp;
+static uint32_t payload_received;
+static int64_t conn_param_timestamp;
+static uint32_t conn_param_received;
 
 static uint32_t query_active_firmware_version(void *accessory_delegate,
 					      uint32_t asset_tag,
@@ -94,6 +99,19 @@ static uint32_t query_active_firmware_version(void *accessory_delegate,
 static void payload_meta_data_complete(void *accessory_delegate, void *asset_delegate);
 static void asset_meta_data_complete(void *accessory_delegate, void *asset_delegate);
 
+static void transfer_state_set(struct fmna_uarp_accessory *accessory, bool active)
+{
+	if (accessory->transfer_active == active) {
+		return;
+	}
+
+	accessory->transfer_active = active;
+
+	if (accessory->transfer_state) {
+		accessory->transfer_state(active);
+	}
+}
+
 void fmna_uarp_controller_add(void)
 {
 	uint32_t status;
@@ -115,6 +133,8 @@ void fmna_uarp_controller_remove(void)
 	
 	LOG_INF("Removing controller");
 
+	transfer_state_set(&accessory, false);
+
 	uarpFree(accessory.buf);
 	uarpFree(accessory.pending_buf);
 	accessory.buf = NULL;
@@ -262,15 +282,39 @@ void fmna_uarp_send_message_complete(void)
 	}
 }
 
+void fmna_uarp_transfer_conn_param_changed(void)
+{
+	if (IS_ENABLED(CONFIG_FMNA_UARP_LOG_TRANSFER_THROUGHPUT) && accessory.transfer_active) {
+		conn_param_timestamp = k_uptime_get();
+		conn_param_received = payload_received;
+	}
+}
+
 static uint32_t data_transfer_pause(void *accessory_delegate, void *p_controller_delegate)
 {
+	struct fmna_uarp_accessory *accessory = (struct fmna_uarp_accessory *) accessory_delegate;
+
+	__ASSERT(accessory_delegate, "NULL argument");
+
 	LOG_INF("Transfer paused by the controller");
+
+	transfer_state_set(accessory, false);
+
 	return kUARPStatusSuccess;
 }
 
 static uint32_t data_transfer_resume(void *accessory_delegate, void *p_controller_delegate)
 {
+	struct fmna_uarp_accessory *accessory = (struct fmna_uarp_accessory *) accessory_delegate;
+
+	__ASSERT(accessory_delegate, "NULL argument");
+
 	LOG_INF("Transfer resumed by the controller");
+
+	if (accessory->state == ASSET_ACTIVE) {
+		transfer_state_set(accessory, true);
+	}
+
 	return kUARPStatusSuccess;
 }
 
@@ -398,6 +442,8 @@ static void remove_asset(struct fmna_uarp_accessory *accessory,
 		uarpPlatformAccessoryAssetRelease(&accessory->accessory, NULL, asset);
 	}
 
+	transfer_state_set(accessory, false);
+
 	accessory->state = ASSET_NONE;
 	accessory->asset = NULL;
 
@@ -446,6 +492,7 @@ static void asset_orphaned(void *accessory_delegate, void *asset_delegate)
 
 	switch (accessory->state) {
 	case ASSET_ACTIVE:
+		transfer_state_set(accessory, false);
 		accessory->state = ASSET_ORPHANED;
 		break;
 
@@ -471,6 +518,8 @@ static void report_failure(struct fmna_uarp_accessory *accessory,
 
 	accessory->last_error = (last_error << 16) | (last_error_info & 0xFFFF);
 
+	transfer_state_set(accessory, false);
+
 	switch (accessory->state) {
 	case ASSET_ACTIVE:
 		accessory->state = ASSET_FAILED;
@@ -553,6 +602,8 @@ static void payload_ready(void *accessory_delegate, void *asset_delegate)
 
 	if (IS_ENABLED(CONFIG_FMNA_UARP_LOG_TRANSFER_THROUGHPUT)) {
 		payload_ready_timestamp = k_uptime_get();
+		payload_received = 0;
+		conn_param_timestamp = 0;
 	}
 
 	LOG_INF("Payload Ready - Index %d Tag <%c%c%c%c>",
@@ -717,6 +768,8 @@ static void payload_meta_data_complete(void *accessory_delegate, void *asset_del
 	if (status != kUARPStatusSuccess) {
 		LOG_ERR("uarpPlatformAccessoryPayloadRequestData failed, status 0x%04X", status);
 		report_failure(accessory, asset, LAST_ERROR_PAYLOAD_REQUEST_DATA_FAILED, status);
+	} else {
+		transfer_state_set(accessory, true);
 	}
 
 	return;
@@ -742,6 +795,10 @@ static void payload_data(void *accessory_delegate, void *asset_delegate,
 
 	ocrypto_sha256_update(&accessory->hash_ctx, buffer, buffer_length);
 
+	if (IS_ENABLED(CONFIG_FMNA_UARP_LOG_TRANSFER_THROUGHPUT)) {
+		payload_received += buffer_length;
+	}
+
 	ret = dfu_target_write(buffer, buffer_length);
 
 	if (ret) {
@@ -781,6 +838,18 @@ static int apply_and_reboot(struct fmna_uarp_accessory *accessory,
 	return ret;
 }
 
+static void throughput_log(const char *label, uint32_t size, uint64_t elapsed_ms)
+{
+	static const uint64_t bytes_per_kbyte = 1000;
+	uint64_t throughput = (uint64_t) size * MSEC_PER_SEC / MAX(elapsed_ms, 1);
+
+	LOG_INF("%s size: %" PRIu32 " [B], elapsed time: %" PRIu64 ".%03" PRIu64
+		" [s], throughput: %" PRIu64 ".%03" PRIu64 " [kB/s]",
+		label, size,
+		elapsed_ms / MSEC_PER_SEC, elapsed_ms % MSEC_PER_SEC,
+		throughput / bytes_per_kbyte, throughput % bytes_per_kbyte);
+}
+
 static void payload_data_complete(void *accessory_delegate, void *asset_delegate)
 {
 	uint8_t hash[ocrypto_sha256_BYTES];
@@ -796,19 +865,22 @@ static void payload_data_complete(void *accessory_delegate, void *asset_delegate
 		return;
 	}
 
+	transfer_state_set(accessory, false);
+
 	if (IS_ENABLED(CONFIG_FMNA_UARP_LOG_TRANSFER_THROUGHPUT)) {
-		static const uint64_t bytes_per_kbyte = 1000;
 		int64_t timestamp = k_uptime_get();
-		uint64_t elapsed_ms = timestamp - payload_ready_timestamp;
-		uint64_t throughput = asset->payload.plHdr.payloadLength * MSEC_PER_SEC /
-											elapsed_ms;
 
 		LOG_INF("Payload transfer complete");
-		LOG_INF("Payload size: %" PRIu32 " [B], elapsed time: %" PRIu64 ".%" PRIu64
-			" [s], throughput: %" PRIu64 ".%" PRIu64 " [kB/s]",
-			asset->payload.plHdr.payloadLength,
-			elapsed_ms / MSEC_PER_SEC, elapsed_ms % MSEC_PER_SEC,
-			throughput / bytes_per_kbyte, throughput % bytes_per_kbyte);
+		throughput_log("Payload", asset->payload.plHdr.payloadLength,
+			       timestamp - payload_ready_timestamp);
+
+		if (conn_param_timestamp) {
+			throughput_log("Before connection parameter update", conn_param_received,
+				       conn_param_timestamp - payload_ready_timestamp);
+			throughput_log("After connection parameter update",
+				       payload_received - conn_param_received,
+				       timestamp - conn_param_timestamp);
+		}
 	}
 
 	ocrypto_sha256_final(&accessory->hash_ctx, hash);
@@ -1029,7 +1101,8 @@ int fmna_uarp_img_confirm(void)
 	return ret;
 }
 
-bool fmna_uarp_init(fmna_uarp_send_message_fn send_message_callback)
+bool fmna_uarp_init(fmna_uarp_send_message_fn send_message_callback,
+		    fmna_uarp_transfer_state_fn transfer_state_callback)
 {
 	uint32_t status;
 	struct uarpPlatformOptionsObj options;
@@ -1044,6 +1117,7 @@ bool fmna_uarp_init(fmna_uarp_send_message_fn send_message_callback)
 	options.payloadWindowLength = CONFIG_FMNA_UARP_PAYLOAD_WINDOW_SIZE;
 	
 	accessory.send_message = send_message_callback;
+	accessory.transfer_state = transfer_state_callback;
 	
 	callbacks.fRequestBuffer = request_buffer;
 	callbacks.fReturnBuffer = return_buffer;
@@ -13,7 +13,11 @@
 
 typedef uint32_t (*fmna_uarp_send_message_fn)(struct net_buf_simple *buf);
 
-bool fmna_uarp_init(fmna_uarp_send_message_fn send_message_callback);
+/* Called when a payload transfer starts and when it completes or is abandoned. */
+typedef void (*fmna_uarp_transfer_state_fn)(bool active);
+
+bool fmna_uarp_init(fmna_uarp_send_message_fn send_message_callback,
+		    fmna_uarp_transfer_state_fn transfer_state_callback);
 
 void fmna_uarp_controller_add(void);
 
@@ -23,6 +27,12 @@ void fmna_uarp_recv_message(struct net_buf_simple *buf);
 
 void fmna_uarp_send_message_complete(void);
 
+/* Mark the moment when the connection parameters changed during the payload
+ * transfer. The transfer throughput is then logged before and after it.
+ * Must be called from the UARP context.
+ */
+void fmna_uarp_transfer_conn_param_changed(void);
+
 int fmna_uarp_img_confirm(void);
 
 #endif /* FMNA_UARP_H_ */
@@ -6,6 +6,7 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/init.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
@@ -23,6 +24,7 @@
 #include "fmna_gatt_pkt_manager.h"
 
 #include "fmna_conn.h"
+#include "fmna_link.h"
 #include "fmna_uarp.h"
 
 LOG_MODULE_DECLARE(LOG_MODULE_NAME, CONFIG_FMNA_UARP_LOG_LEVEL);
@@ -39,6 +41,7 @@ enum rx_event_id
 	RX_EVENT_DISCONNECT,
 	RX_EVENT_INDICATION_ACK,
 	RX_EVENT_WRITE,
+	RX_EVENT_CONN_PARAM_UPDATE,
 };
 
 struct rx_event {
@@ -52,6 +55,11 @@ struct rx_event {
 			uint8_t err;
 		} indication_ack_data;
 		struct
+		{
+			uint16_t interval;
+			uint16_t latency;
+		} conn_param_data;
+		struct
 		{
 			uint16_t len;
 			uint8_t buf[];
@@ -59,8 +67,17 @@ struct rx_event {
 	};
 };
 
+enum conn_param_flag {
+	CONN_PARAM_FLAG_BURST_ACTIVE,
+	CONN_PARAM_FLAG_IDLE_PENDING,
+};
+
 static struct bt_conn *active_conn = NULL;
 static struct net_buf_simple *sending_buf = NULL;
+/* The connection parameter updates are posted to the UARP context, which is
+ * the only one that accesses the flags.
+ */
+static atomic_t conn_param_flags;
 static K_FIFO_DEFINE(rx_buf_fifo);
 
 static bool submit_event_indication_ack(struct bt_conn *conn, uint8_t err);
@@ -157,12 +174,146 @@ static uint32_t uarp_send_message(struct net_buf_simple *buf)
 	return kUARPStatusSuccess;
 }
 
+#if CONFIG_FMNA_UARP_BURST_CONN_PARAM
+/* iOS rejects the requests with a minimum connection interval below 15 ms or
+ * with less than 15 ms between the minimum and the maximum connection interval.
+ */
+#define IDLE_CONN_INTERVAL_MIN 12
+#define IDLE_CONN_INTERVAL_WINDOW 12
+
+/* Requested when the transfer ends, derived from the parameters that were in
+ * use before the burst parameters were requested.
+ */
+static struct bt_le_conn_param idle_conn_param;
+
+static void idle_conn_param_record(const struct bt_conn_info *conn_info)
+{
+	uint16_t interval = conn_info->le.interval;
+	uint16_t timeout_min;
+
+	/* Center the window on the previous connection interval. */
+	if (interval > IDLE_CONN_INTERVAL_MIN + IDLE_CONN_INTERVAL_WINDOW / 2) {
+		idle_conn_param.interval_min = interval - IDLE_CONN_INTERVAL_WINDOW / 2;
+	} else {
+		idle_conn_param.interval_min = IDLE_CONN_INTERVAL_MIN;
+	}
+	idle_conn_param.interval_max = MIN(idle_conn_param.interval_min +
+					   IDLE_CONN_INTERVAL_WINDOW,
+					   3200);
+	idle_conn_param.latency = conn_info->le.latency;
+
+	/* The supervision timeout must cover two maximum length connection events
+	 * with the peripheral latency: (1 + latency) * interval * 2.
+	 */
+	timeout_min = (1 + idle_conn_param.latency) * idle_conn_param.interval_max * 125 * 2 /
+		      1000 + 1;
+	idle_conn_param.timeout = MIN(MAX(conn_info->le.timeout, timeout_min), 3200);
+}
+
+static void burst_conn_param_request(void)
+{
+	int err;
+	struct bt_conn_info conn_info;
+	const struct bt_le_conn_param burst_conn_param = BT_LE_CONN_PARAM_INIT(
+		CONFIG_FMNA_UARP_BURST_CONN_INTERVAL_MIN,
+		CONFIG_FMNA_UARP_BURST_CONN_INTERVAL_MAX,
+		0,
+		CONFIG_FMNA_UARP_BURST_CONN_TIMEOUT);
+
+	err = bt_conn_get_info(active_conn, &conn_info);
+	if (err) {
+		LOG_ERR("bt_conn_get_info returned error: %d", err);
+		return;
+	}
+
+	if (conn_info.le.interval <= CONFIG_FMNA_UARP_BURST_CONN_INTERVAL_MAX &&
+	    conn_info.le.latency == 0) {
+		return;
+	}
+
+	atomic_clear_bit(&conn_param_flags, CONN_PARAM_FLAG_IDLE_PENDING);
+
+	LOG_INF("UARP: requesting burst connection parameters, current interval: %u, "
+		"latency: %u, timeout: %u", conn_info.le.interval, conn_info.le.latency,
+		conn_info.le.timeout);
+
+	idle_conn_param_record(&conn_info);
+	atomic_set_bit(&conn_param_flags, CONN_PARAM_FLAG_BURST_ACTIVE);
+
+	err = bt_conn_le_param_update(active_conn, &burst_conn_param);
+	if (err) {
+		LOG_ERR("bt_conn_le_param_update returned error: %d", err);
+		atomic_clear_bit(&conn_param_flags, CONN_PARAM_FLAG_BURST_ACTIVE);
+	}
+}
+
+static void idle_conn_param_restore(void)
+{
+	int err;
+
+	if (!atomic_test_and_clear_bit(&conn_param_flags, CONN_PARAM_FLAG_BURST_ACTIVE)) {
+		return;
+	}
+
+	LOG_INF("UARP: restoring connection parameters, interval: %u-%u, latency: %u, "
+		"timeout: %u", idle_conn_param.interval_min, idle_conn_param.interval_max,
+		idle_conn_param.latency, idle_conn_param.timeout);
+
+	/* Checked when the update is reported. */
+	atomic_set_bit(&conn_param_flags, CONN_PARAM_FLAG_IDLE_PENDING);
+
+	err = bt_conn_le_param_update(active_conn, &idle_conn_param);
+	if (err) {
+		LOG_ERR("bt_conn_le_param_update returned error: %d", err);
+		atomic_clear_bit(&conn_param_flags, CONN_PARAM_FLAG_IDLE_PENDING);
+	}
+}
+
+static bool idle_conn_param_check(uint16_t interval, uint16_t latency)
+{
+	return (interval >= idle_conn_param.interval_min) &&
+	       (interval <= idle_conn_param.interval_max) &&
+	       (latency == idle_conn_param.latency);
+}
+#endif /* CONFIG_FMNA_UARP_BURST_CONN_PARAM */
+
+static void link_use_update(bool active)
+{
+#if CONFIG_FMNA_LINK_OPTIMIZER
+	int err;
+
+	/* Go back to the owner link policy once the transfer is over. */
+	err = fmna_link_use_set(active_conn,
+				active ? FMNA_LINK_USE_UARP : FMNA_LINK_USE_OWNER);
+	if (err) {
+		LOG_ERR("fmna_link_use_set returned error: %d", err);
+	}
+#endif
+}
+
+static void uarp_transfer_state_changed(bool active)
+{
+	if (!active_conn) {
+		return;
+	}
+
+	link_use_update(active);
+
+#if CONFIG_FMNA_UARP_BURST_CONN_PARAM
+	if (active) {
+		burst_conn_param_request();
+	} else {
+		idle_conn_param_restore();
+	}
+#endif
+}
+
 static bool uarp_init(void)
 {
 	static bool initialized = false;
 
 	if (!initialized) {
-		if (fmna_uarp_init(uarp_send_message)) {
+		if (fmna_uarp_init(uarp_send_message, uarp_transfer_state_changed)) {
 			initialized = true;
 		} else {
 			LOG_ERR("fmna_uarp_init: Initialization failed");
@@ -178,9 +329,14 @@ static void handle_disconnect(struct bt_conn *conn)
 		return;
 	}
 
+	/* The parameters and the link policy of a disconnected link are not
+	 * restored when the controller is removed.
+	 */
+	atomic_clear(&conn_param_flags);
+
 	sending_buf = NULL;
-	fmna_uarp_controller_remove();
 	active_conn = NULL;
+	fmna_uarp_controller_remove();
 }
 
 static void handle_indication_ack(struct bt_conn *conn, uint8_t err)
@@ -194,6 +350,10 @@ static void handle_indication_ack(struct bt_conn *conn, uint8_t err)
 		return;
 	}
 
+	/* The fragments of a UARP message are sent one at a time to keep them
+	 * in order. With Enhanced ATT they do not wait behind the FMN control
+	 * point indications, which may take the other bearers.
+	 */
 	chunk = fmna_gatt_pkt_manager_chunk_prepare(conn, sending_buf, &chunk_len);
 
 	if (!chunk || err) {
@@ -257,12 +417,46 @@ static void handle_write(struct bt_conn *conn, uint8_t *buf, uint16_t len)
 	}
 }
 
+static void handle_conn_param_update(struct bt_conn *conn, uint16_t interval,
+				     uint16_t latency)
+{
+	if (conn != active_conn) {
+		return;
+	}
+
+#if CONFIG_FMNA_UARP_BURST_CONN_PARAM
+	if (atomic_test_and_clear_bit(&conn_param_flags, CONN_PARAM_FLAG_IDLE_PENDING)) {
+		if (idle_conn_param_check(interval, latency)) {
+			LOG_INF("UARP: connection parameters restored, interval: %u, "
+				"latency: %u", interval, latency);
+		} else {
+			LOG_WRN("UARP: connection parameters not restored, interval: %u, "
+				"latency: %u", interval, latency);
+		}
+
+		return;
+	}
+#endif
+
+	if (!atomic_test_bit(&conn_param_flags, CONN_PARAM_FLAG_BURST_ACTIVE)) {
+		return;
+	}
+
+	LOG_INF("UARP: connection parameters updated, interval: %u, latency: %u",
+		interval, latency);
+
+	fmna_uarp_transfer_conn_param_changed();
+}
+
 static void handle_rx_event(struct rx_event *event)
 {
 	if (event->id == RX_EVENT_DISCONNECT) {
 		handle_disconnect(event->conn);
 	} else if (event->id == RX_EVENT_INDICATION_ACK) {
 		handle_indication_ack(event->conn, event->indication_ack_data.err);
+	} else if (event->id == RX_EVENT_CONN_PARAM_UPDATE) {
+		handle_conn_param_update(event->conn, event->conn_param_data.interval,
+					 event->conn_param_data.latency);
 	} else {
 		handle_write(event->conn, event->write_data.buf, event->write_data.len);
 	}
@@ -380,6 +574,42 @@ static bool submit_event_write(struct bt_conn *conn, const uint8_t *buf, uint16_
 	return true;
 }
 
+static bool submit_event_conn_param_update(struct bt_conn *conn, uint16_t interval,
+					   uint16_t latency)
+{
+	struct rx_event *event;
+
+	event = k_malloc(sizeof(struct rx_event));
+	if (event == NULL) {
+		return false;
+	}
+
+	event->id = RX_EVENT_CONN_PARAM_UPDATE;
+	event->conn = conn;
+	event->conn_param_data.interval = interval;
+	event->conn_param_data.latency = latency;
+
+	k_fifo_put(&rx_buf_fifo, event);
+
+#ifndef CONFIG_FMNA_UARP_DEDICATED_THREAD
+	k_work_submit(&rx_work);
+#endif
+	return true;
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+			     uint16_t latency, uint16_t timeout)
+{
+	/* The transfer state is owned by the UARP context. */
+	if (!submit_event_conn_param_update(conn, interval, latency)) {
+		LOG_WRN("UARP: cannot report the connection parameter update");
+	}
+}
+
+BT_CONN_CB_DEFINE(uarp_conn_callbacks) = {
+	.le_param_updated = le_param_updated,
+};
+
 static bool app_event_handler(const struct app_event_header *aeh)
 {
 	if (is_fmna_event(aeh)) {
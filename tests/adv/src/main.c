@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/settings/settings.h>
+
+static void *suite_fmn_adv_setup(void)
+{
+	int err;
+
+	err = bt_enable(NULL);
+	zassert_equal(err, 0, "bt_enable returned error: %d", err);
+
+	if (IS_ENABLED(CONFIG_SETTINGS)) {
+		err = settings_load();
+		zassert_equal(err, 0, "settings_load returned error: %d", err);
+	}
+
+	return NULL;
+}
+
+ZTEST_SUITE(suite_fmn_adv, NULL, suite_fmn_adv_setup, NULL, NULL, NULL);
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/bluetooth/hci_vs.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "fmna_adv.h"
+
+#define PAIRED_ADV_INTERVAL 0x0C80 /* 2 s */
+
+/* Opcodes of the HCI commands sent by the host since the last reset. */
+static uint16_t hci_cmd_log[32];
+static size_t hci_cmd_cnt;
+
+int __real_bt_hci_cmd_send_sync(uint16_t opcode, struct net_buf *buf, struct net_buf **rsp);
+
+int __wrap_bt_hci_cmd_send_sync(uint16_t opcode, struct net_buf *buf, struct net_buf **rsp)
+{
+	if (hci_cmd_cnt < ARRAY_SIZE(hci_cmd_log)) {
+		hci_cmd_log[hci_cmd_cnt] = opcode;
+	}
+	hci_cmd_cnt++;
+
+	return __real_bt_hci_cmd_send_sync(opcode, buf, rsp);
+}
+
+static void hci_cmd_log_reset(void)
+{
+	hci_cmd_cnt = 0;
+}
+
+static size_t hci_cmd_opcode_cnt(uint16_t opcode)
+{
+	size_t cnt = 0;
+
+	for (size_t i = 0; i < MIN(hci_cmd_cnt, ARRAY_SIZE(hci_cmd_log)); i++) {
+		if (hci_cmd_log[i] == opcode) {
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+/* Consecutive Primary Keys. */
+static const uint8_t PRIMARY_KEYS[][FMNA_PUBLIC_KEY_LEN] = {
+	{
+		0x4d, 0x1a, 0x7e, 0x31, 0x0c, 0x93, 0x5b, 0xe2,
+		0x16, 0xa8, 0x2f, 0x70, 0xc4, 0x09, 0x8b, 0x55,
+		0x3e, 0xd1, 0x62, 0x0f, 0xb7, 0x28, 0x94, 0x4a,
+		0xe5, 0x13, 0x7c, 0xa0
+	},
+	{
+		0x92, 0x6b, 0x04, 0xdf, 0x38, 0x1e, 0xc5, 0x70,
+		0xaa, 0x5d, 0x21, 0x8e, 0x47, 0xf3, 0x0b, 0x69,
+		0xd4, 0x12, 0x87, 0x3c, 0x5a, 0xe0, 0x2d, 0xb1,
+		0x76, 0x08, 0xcf, 0x43
+	},
+	{
+		0x17, 0xc8, 0x3f, 0x62, 0xa1, 0x0d, 0x94, 0xeb,
+		0x50, 0x27, 0x7a, 0xb6, 0x1c, 0xe9, 0x83, 0x05,
+		0x6e, 0xd2, 0x49, 0x30, 0xfa, 0x8b, 0x14, 0x57,
+		0xc3, 0x2e, 0x91, 0x6d
+	},
+};
+
+static void paired_addr_get(bt_addr_le_t *addr, const uint8_t pubkey[FMNA_PUBLIC_KEY_LEN])
+{
+	addr->type = BT_ADDR_LE_RANDOM;
+	sys_memcpy_swap(addr->a.val, pubkey, sizeof(addr->a.val));
+	BT_ADDR_SET_STATIC(&addr->a);
+}
+
+static void nearby_config_get(struct fmna_adv_nearby_config *config, size_t key_index)
+{
+	memset(config, 0, sizeof(*config));
+	memcpy(config->primary_key, PRIMARY_KEYS[key_index], sizeof(config->primary_key));
+}
+
+static void id_addr_check(uint8_t id, size_t key_index)
+{
+	bt_addr_le_t addrs[CONFIG_BT_ID_MAX];
+	size_t count = ARRAY_SIZE(addrs);
+	bt_addr_le_t addr;
+
+	paired_addr_get(&addr, PRIMARY_KEYS[key_index]);
+
+	bt_id_get(addrs, &count);
+	zassert_true(id < count, "FMN identity is missing");
+	zassert_true(bt_addr_le_eq(&addrs[id], &addr),
+		     "Identity address does not follow the Primary Key");
+}
+
+static int legacy_adv_start(uint8_t id, struct bt_le_ext_adv **adv)
+{
+	int err;
+	uint8_t adv_handle;
+	struct net_buf *buf;
+	struct net_buf *rsp = NULL;
+	struct bt_hci_cp_vs_write_tx_power_level *cp;
+	static const uint8_t mfg_data[] = {0x4c, 0x00, 0x12, 0x02, 0x00, 0x00};
+	const struct bt_data ad[] = {
+		BT_DATA(BT_DATA_MANUFACTURER_DATA, mfg_data, sizeof(mfg_data)),
+	};
+	const struct bt_le_adv_param param = {
+		.id = id,
+		.options = BT_LE_ADV_OPT_CONNECTABLE | BT_LE_ADV_OPT_USE_IDENTITY,
+		.interval_min = PAIRED_ADV_INTERVAL,
+		.interval_max = PAIRED_ADV_INTERVAL,
+	};
+
+	err = bt_le_ext_adv_create(&param, NULL, adv);
+	if (err) {
+		return err;
+	}
+
+	err = bt_le_ext_adv_set_data(*adv, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (err) {
+		return err;
+	}
+
+	err = bt_hci_get_adv_handle(*adv, &adv_handle);
+	if (err) {
+		return err;
+	}
+
+	buf = bt_hci_cmd_create(BT_HCI_OP_VS_WRITE_TX_POWER_LEVEL, sizeof(*cp));
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->handle = sys_cpu_to_le16(adv_handle);
+	cp->handle_type = BT_HCI_VS_LL_HANDLE_TYPE_ADV;
+	cp->tx_power_level = CONFIG_FMNA_TX_POWER;
+
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_VS_WRITE_TX_POWER_LEVEL, buf, &rsp);
+	if (err) {
+		return err;
+	}
+
+	net_buf_unref(rsp);
+
+	return bt_le_ext_adv_start(*adv, BT_LE_EXT_ADV_START_DEFAULT);
+}
+
+static int legacy_adv_stop(struct bt_le_ext_adv *adv)
+{
+	int err;
+
+	err = bt_le_ext_adv_stop(adv);
+	if (err) {
+		return err;
+	}
+
+	return bt_le_ext_adv_delete(adv);
+}
+
+/* Number of HCI commands that the key rotation took when the advertising set
+ * was deleted and created again with bt_id_reset in between.
+ */
+static size_t legacy_rotation_hci_cmd_cnt(uint8_t id)
+{
+	int err;
+	size_t cnt;
+	bt_addr_le_t addr;
+	struct bt_le_ext_adv *adv;
+
+	paired_addr_get(&addr, PRIMARY_KEYS[0]);
+	err = bt_id_reset(id, &addr, NULL);
+	zassert_equal(err, id, "bt_id_reset returned error: %d", err);
+
+	err = legacy_adv_start(id, &adv);
+	zassert_equal(err, 0, "legacy_adv_start returned error: %d", err);
+
+	hci_cmd_log_reset();
+
+	err = legacy_adv_stop(adv);
+	zassert_equal(err, 0, "legacy_adv_stop returned error: %d", err);
+
+	paired_addr_get(&addr, PRIMARY_KEYS[1]);
+	err = bt_id_reset(id, &addr, NULL);
+	zassert_equal(err, id, "bt_id_reset returned error: %d", err);
+
+	err = legacy_adv_start(id, &adv);
+	zassert_equal(err, 0, "legacy_adv_start returned error: %d", err);
+
+	cnt = hci_cmd_cnt;
+
+	err = legacy_adv_stop(adv);
+	zassert_equal(err, 0, "legacy_adv_stop returned error: %d", err);
+
+	return cnt;
+}
+
+ZTEST(suite_fmn_adv, test_rotation_hci_cmd_count)
+{
+	int err;
+	int id;
+	size_t legacy_cnt;
+	size_t rotation_cnt;
+	struct fmna_adv_nearby_config config;
+
+	id = bt_id_create(NULL, NULL);
+	zassert_true(id > 0, "bt_id_create returned error: %d", id);
+
+	legacy_cnt = legacy_rotation_hci_cmd_cnt(id);
+
+	err = fmna_adv_init(id);
+	zassert_equal(err, 0, "fmna_adv_init returned error: %d", err);
+
+	nearby_config_get(&config, 0);
+	err = fmna_adv_start_nearby(&config);
+	zassert_equal(err, 0, "fmna_adv_start_nearby returned error: %d", err);
+	id_addr_check(id, 0);
+
+	/* Key rotation: new payload and new address on the same advertising set. */
+	hci_cmd_log_reset();
+	nearby_config_get(&config, 1);
+	err = fmna_adv_start_nearby(&config);
+	zassert_equal(err, 0, "fmna_adv_start_nearby returned error: %d", err);
+	rotation_cnt = hci_cmd_cnt;
+
+	TC_PRINT("HCI commands per key rotation: %zu (legacy: %zu)\n",
+		 rotation_cnt, legacy_cnt);
+
+	zassert_true(rotation_cnt < legacy_cnt, "Key rotation did not reduce HCI commands");
+	zassert_equal(hci_cmd_opcode_cnt(BT_HCI_OP_LE_REMOVE_ADV_SET), 0,
+		      "Advertising set was deleted");
+	zassert_equal(hci_cmd_opcode_cnt(BT_HCI_OP_VS_WRITE_TX_POWER_LEVEL), 0,
+		      "TX power was written again");
+	id_addr_check(id, 1);
+
+	/* Restart with the same key: the parameters and the address are kept. */
+	hci_cmd_log_reset();
+	err = fmna_adv_start_nearby(&config);
+	zassert_equal(err, 0, "fmna_adv_start_nearby returned error: %d", err);
+
+	TC_PRINT("HCI commands per restart without key change: %zu\n", hci_cmd_cnt);
+
+	zassert_equal(hci_cmd_opcode_cnt(BT_HCI_OP_LE_SET_EXT_ADV_PARAM), 0,
+		      "Advertising parameters were written again");
+	zassert_equal(hci_cmd_opcode_cnt(BT_HCI_OP_LE_SET_ADV_SET_RANDOM_ADDR), 0,
+		      "Advertising address was written again");
+
+	/* Key rotation with the payload prepared ahead of time. */
+	nearby_config_get(&config, 2);
+	err = fmna_adv_prepare_nearby(&config);
+	zassert_equal(err, 0, "fmna_adv_prepare_nearby returned error: %d", err);
+
+	hci_cmd_log_reset();
+	err = fmna_adv_start_nearby(&config);
+	zassert_equal(err, 0, "fmna_adv_start_nearby returned error: %d", err);
+
+	zassert_equal(hci_cmd_cnt, rotation_cnt,
+		      "Prepared key rotation sent a different number of HCI commands");
+	id_addr_check(id, 2);
+
+	err = fmna_adv_uninit();
+	zassert_equal(err, 0, "fmna_adv_uninit returned error: %d", err);
+}
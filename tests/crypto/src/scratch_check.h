@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef SCRATCH_CHECK_H_
+#define SCRATCH_CHECK_H_
+
+#include <zephyr/ztest.h>
+
+#include "fm_crypto.h"
+
+/* Run one fm_crypto operation and check that its scratch arena usage fits in
+ * the arena size computed at build time. Operations that only run primitives
+ * of the PSA backend may not use the arena at all.
+ */
+#define SCRATCH_CHECK(_op) do {							\
+	word32 _hwm;								\
+										\
+	fm_crypto_scratch_hwm_reset();						\
+	zassert_equal((_op), 0, #_op " failed");				\
+	_hwm = fm_crypto_scratch_hwm_get();					\
+	zassert_true(_hwm <= fm_crypto_scratch_size_get(),			\
+		     #_op " used %u scratch bytes out of %u", _hwm,		\
+		     fm_crypto_scratch_size_get());				\
+} while (0)
+
+#endif /* SCRATCH_CHECK_H_ */
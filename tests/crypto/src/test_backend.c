@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fm_crypto.h"
+#include "fm_crypto_backend.h"
+
+static const struct fm_crypto_backend *const backends[] = {
+	&fm_crypto_backend_oberon,
+#if defined(CONFIG_FMNA_CRYPTO_PSA)
+	&fm_crypto_backend_psa,
+#endif
+	&fm_crypto_backend,
+};
+
+/* FIPS 180-2, B.1: SHA-256("abc"). */
+static const byte SHA256_ABC[32] = {
+	0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+	0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+	0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+	0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+
+/*
+ * <https://tools.ietf.org/html/rfc6979#appendix-A.2.5>
+ *
+ * Private key d, public key Q = d * G (x || y) and the signature (r || s)
+ * of SHA-256("sample").
+ */
+static const byte d[32] = {
+	0xc9, 0xaf, 0xa9, 0xd8, 0x45, 0xba, 0x75, 0x16,
+	0x6b, 0x5c, 0x21, 0x57, 0x67, 0xb1, 0xd6, 0x93,
+	0x4e, 0x50, 0xc3, 0xdb, 0x36, 0xe8, 0x9b, 0x12,
+	0x7b, 0x8a, 0x62, 0x2b, 0x12, 0x0f, 0x67, 0x21
+};
+
+static const byte Q[64] = {
+	0x60, 0xfe, 0xd4, 0xba, 0x25, 0x5a, 0x9d, 0x31,
+	0xc9, 0x61, 0xeb, 0x74, 0xc6, 0x35, 0x6d, 0x68,
+	0xc0, 0x49, 0xb8, 0x92, 0x3b, 0x61, 0xfa, 0x6c,
+	0xe6, 0x69, 0x62, 0x2e, 0x60, 0xf2, 0x9f, 0xb6,
+	0x79, 0x03, 0xfe, 0x10, 0x08, 0xb8, 0xbc, 0x99,
+	0xa4, 0x1a, 0xe9, 0xe9, 0x56, 0x28, 0xbc, 0x64,
+	0xf2, 0xf1, 0xb2, 0x0c, 0x2d, 0x7e, 0x9f, 0x51,
+	0x77, 0xa3, 0xc2, 0x94, 0xd4, 0x46, 0x22, 0x99
+};
+
+static const byte SHA256_SAMPLE[32] = {
+	0xaf, 0x2b, 0xdb, 0xe1, 0xaa, 0x9b, 0x6e, 0xc1,
+	0xe2, 0xad, 0xe1, 0xd6, 0x94, 0xf4, 0x1f, 0xc7,
+	0x1a, 0x83, 0x1d, 0x02, 0x68, 0xe9, 0x89, 0x15,
+	0x62, 0x11, 0x3d, 0x8a, 0x62, 0xad, 0xd1, 0xbf
+};
+
+static const byte sig[64] = {
+	0xef, 0xd4, 0x8b, 0x2a, 0xac, 0xb6, 0xa8, 0xfd,
+	0x11, 0x40, 0xdd, 0x9c, 0xd4, 0x5e, 0x81, 0xd6,
+	0x9d, 0x2c, 0x87, 0x7b, 0x56, 0xaa, 0xf9, 0x91,
+	0xc3, 0x4d, 0x0e, 0xa8, 0x4e, 0xaf, 0x37, 0x16,
+	0xf7, 0xcb, 0x1c, 0x94, 0x2d, 0x65, 0x7c, 0x41,
+	0xd4, 0x36, 0xc7, 0xa1, 0xb6, 0xe2, 0x9f, 0x65,
+	0xf3, 0xe9, 0x00, 0xdb, 0xb9, 0xaf, 0xf4, 0x06,
+	0x4d, 0xc4, 0xab, 0x2f, 0x84, 0x3a, 0xcd, 0xa8
+};
+
+/* P-256 base point G (x || y). The ECDH of d with G is x(Q). */
+static const byte G[64] = {
+	0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47,
+	0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+	0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+	0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+	0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b,
+	0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+	0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce,
+	0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5
+};
+
+/* AES-128-GCM of "sample", see test_decrypt.c. */
+static const byte K1[16] = {
+	0x1a, 0xfa, 0x48, 0x1a, 0xf1, 0x9b, 0x6b, 0x80,
+	0x08, 0xa7, 0xb8, 0xbb, 0xba, 0xe6, 0x9c, 0x0d
+};
+
+static const byte IV1[16] = {
+	0x66, 0x74, 0xbb, 0xf4, 0x73, 0x8e, 0xc8, 0x41,
+	0x74, 0x90, 0x30, 0x81, 0xb1, 0x16, 0xd8, 0x85
+};
+
+static const byte CT[6] = {
+	0xcf, 0xb3, 0x96, 0xab, 0x6e, 0xb7
+};
+
+static const byte TAG[16] = {
+	0x42, 0xa9, 0xf4, 0x0c, 0x7e, 0xf5, 0xd5, 0x7a,
+	0x4f, 0xf6, 0x0f, 0x7e, 0xfa, 0x52, 0xde, 0x54
+};
+
+static const byte msg[] = "sample";
+
+static void backend_sha256_check(const struct fm_crypto_backend *backend)
+{
+	const byte abc[] = "abc";
+	const struct fm_crypto_iovec abc_iov[] = {
+		{ .data = abc, .nbytes = 1 },
+		{ .data = abc + 1, .nbytes = 0 },
+		{ .data = abc + 1, .nbytes = 2 },
+	};
+	byte out[32];
+
+	zassert_equal(backend->sha256_v(out, abc_iov, ARRAY_SIZE(abc_iov)), 0, "%s",
+		      backend->name);
+	zassert_equal(memcmp(out, SHA256_ABC, sizeof(out)), 0, "%s", backend->name);
+}
+
+static void backend_p256_check(const struct fm_crypto_backend *backend)
+{
+	byte secret[32];
+	byte sig_invalid[64];
+
+	zassert_equal(backend->p256_ecdh(secret, d, G), 0, "%s", backend->name);
+	zassert_equal(memcmp(secret, Q, sizeof(secret)), 0, "%s", backend->name);
+
+	zassert_equal(backend->p256_ecdsa_verify_hash(sig, SHA256_SAMPLE, Q), 0, "%s",
+		      backend->name);
+
+	memcpy(sig_invalid, sig, sizeof(sig_invalid));
+	sig_invalid[63] ^= 0x01;
+	zassert_not_equal(backend->p256_ecdsa_verify_hash(sig_invalid, SHA256_SAMPLE, Q), 0,
+			  "%s", backend->name);
+}
+
+static void backend_aes_gcm_check(const struct fm_crypto_backend *backend)
+{
+	const struct fm_crypto_iovec msg_iov[] = {
+		{ .data = msg, .nbytes = 3 },
+		{ .data = msg + 3, .nbytes = 3 },
+	};
+	byte ct[sizeof(CT)];
+	byte tag[sizeof(TAG)];
+
+	zassert_equal(backend->aes128gcm_encrypt_v(K1, IV1, msg_iov, ARRAY_SIZE(msg_iov),
+						   ct, tag), 0, "%s", backend->name);
+	zassert_equal(memcmp(ct, CT, sizeof(ct)), 0, "%s", backend->name);
+	zassert_equal(memcmp(tag, TAG, sizeof(tag)), 0, "%s", backend->name);
+
+	/* Decrypt in place. */
+	zassert_equal(backend->aes128gcm_decrypt(K1, IV1, sizeof(ct), ct, TAG, ct), 0, "%s",
+		      backend->name);
+	zassert_equal(memcmp(ct, msg, sizeof(ct)), 0, "%s", backend->name);
+
+	tag[15] ^= 0x01;
+	zassert_not_equal(backend->aes128gcm_decrypt(K1, IV1, sizeof(CT), CT, tag, ct), 0, "%s",
+			  backend->name);
+}
+
+ZTEST(suite_fmn_crypto, test_backend)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(backends); i++) {
+		const struct fm_crypto_backend *backend = backends[i];
+
+		if (backend->sha256_v) {
+			backend_sha256_check(backend);
+		}
+
+		if (backend->p256_ecdh && backend->p256_ecdsa_verify_hash) {
+			backend_p256_check(backend);
+		}
+
+		if (backend->aes128gcm_encrypt_v && backend->aes128gcm_decrypt) {
+			backend_aes_gcm_check(backend);
+		}
+	}
+
+	/* Every primitive is selected from one of the backends. */
+	zassert_not_null(fm_crypto_backend.sha256_v, "");
+	zassert_not_null(fm_crypto_backend.p224_twin_mult, "");
+	zassert_not_null(fm_crypto_backend.p224_twin_mult_batch, "");
+	zassert_not_null(fm_crypto_backend.p256_ecdh, "");
+	zassert_not_null(fm_crypto_backend.p256_ecdsa_verify_hash, "");
+	zassert_not_null(fm_crypto_backend.aes128gcm_encrypt_v, "");
+	zassert_not_null(fm_crypto_backend.aes128gcm_decrypt, "");
+}
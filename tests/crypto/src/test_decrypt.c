@@ -7,6 +7,7 @@
 #include <zephyr/ztest.h>
 
 #include "fm_crypto.h"
+#include "scratch_check.h"
 
 /* Random ServerSharedSecret. */
 static const byte SERVER_SS[32] = {
@@ -64,3 +65,29 @@ ZTEST(suite_fmn_crypto, test_decrypt)
 	zassert_not_equal(fm_crypto_decrypt_e3(SERVER_SS_invalid, sizeof(E3), E3, &pt_len, pt), 0, "");
 	zassert_not_equal(fm_crypto_decrypt_e3(SERVER_SS, sizeof(E3_invalid), E3_invalid, &pt_len, pt), 0, "");
 }
+
+ZTEST(suite_fmn_crypto, test_decrypt_in_place)
+{
+	byte e3[sizeof(E3)];
+	const byte zero[sizeof(msg) - 1] = {0};
+	word32 pt_len;
+
+	/* The plaintext replaces the ciphertext. */
+	memcpy(e3, E3, sizeof(e3));
+	zassert_equal(fm_crypto_decrypt_e3_in_place(SERVER_SS, sizeof(e3), e3, &pt_len), 0, "");
+	zassert_equal(pt_len, sizeof(msg) - 1, "");
+	zassert_equal(memcmp(e3, msg, pt_len), 0, "");
+
+	/* No plaintext is left behind on failure. */
+	memcpy(e3, E3_invalid, sizeof(e3));
+	zassert_not_equal(fm_crypto_decrypt_e3_in_place(SERVER_SS, sizeof(e3), e3, &pt_len), 0, "");
+	zassert_equal(memcmp(e3, zero, sizeof(zero)), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_decrypt_scratch)
+{
+	byte pt[sizeof(msg) - 1];
+	word32 pt_len = sizeof(pt);
+
+	SCRATCH_CHECK(fm_crypto_decrypt_e3(SERVER_SS, sizeof(E3), E3, &pt_len, pt));
+}
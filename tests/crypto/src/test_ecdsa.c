@@ -7,6 +7,7 @@
 #include <zephyr/ztest.h>
 
 #include "fm_crypto.h"
+#include "scratch_check.h"
 
 /*
  * <https://tools.ietf.org/html/rfc6979#appendix-A.2.5>
@@ -93,3 +94,32 @@ ZTEST(suite_fmn_crypto, test_ecdsa)
 	zassert_not_equal(fm_crypto_verify_s2(Q, sizeof(sig_short), sig_short, sizeof(msg) - 1, msg), 0, "");
 	zassert_not_equal(fm_crypto_verify_s2(Q, sizeof(sig), sig, sizeof(msg) - 2, msg), 0, "");
 }
+
+ZTEST(suite_fmn_crypto, test_ecdsa_with_table)
+{
+	static fm_crypto_p256_comb_table q_table;
+
+	fm_crypto_p256_comb_table_init(&q_table, Q + 1);
+
+	zassert_equal(fm_crypto_verify_s2_with_table(&q_table, sizeof(sig), sig,
+						     sizeof(msg) - 1, msg), 0, "");
+
+	/* Negative test vectors. */
+	zassert_not_equal(fm_crypto_verify_s2_with_table(&q_table, sizeof(sig_invalid), sig_invalid,
+							 sizeof(msg) - 1, msg), 0, "");
+	zassert_not_equal(fm_crypto_verify_s2_with_table(&q_table, sizeof(sig_short), sig_short,
+							 sizeof(msg) - 1, msg), 0, "");
+	zassert_not_equal(fm_crypto_verify_s2_with_table(&q_table, sizeof(sig), sig,
+							 sizeof(msg) - 2, msg), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_ecdsa_scratch)
+{
+	static fm_crypto_p256_comb_table q_table;
+
+	fm_crypto_p256_comb_table_init(&q_table, Q + 1);
+
+	SCRATCH_CHECK(fm_crypto_verify_s2(Q, sizeof(sig), sig, sizeof(msg) - 1, msg));
+	SCRATCH_CHECK(fm_crypto_verify_s2_with_table(&q_table, sizeof(sig), sig,
+						     sizeof(msg) - 1, msg));
+}
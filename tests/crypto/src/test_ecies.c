@@ -11,6 +11,7 @@
 
 #include "fm_crypto.h"
 #include "crypto_helper.h"
+#include "scratch_check.h"
 
 #define LOG_MODULE_NAME fmna_crypto_test_ecies
 #include "crypto_log.h"
@@ -184,3 +185,81 @@ ZTEST(suite_fmn_crypto, test_ecies)
 	zassert_equal(pt_len, sizeof(msg) - 1, "");
 	zassert_equal(memcmp(pt, msg, sizeof(msg) - 1), 0, "");
 }
+
+ZTEST(suite_fmn_crypto, test_ecies_with_key)
+{
+	struct fm_crypto_ephemeral_key key;
+	const struct fm_crypto_ephemeral_key zero_key = {0};
+	byte ct[65 + sizeof(msg) - 1 + 16];
+	word32 ct_len = sizeof(ct);
+
+	zassert_equal(fm_crypto_ephemeral_key_generate(&key), 0, "");
+	zassert_equal(fm_crypto_encrypt_to_server_with_key(&key, Q, sizeof(msg) - 1, msg,
+							   &ct_len, ct), 0, "");
+	zassert_equal(ct_len, sizeof(ct), "");
+
+	/* The ephemeral key must not be usable twice. */
+	zassert_equal(memcmp(&key, &zero_key, sizeof(key)), 0, "");
+
+	byte pt[sizeof(msg) - 1];
+	word32 pt_len = sizeof(pt);
+	zassert_equal(_fm_server_decrypt(sizeof(ct), ct, &pt_len, pt), 0, "");
+	zassert_equal(pt_len, sizeof(msg) - 1, "");
+	zassert_equal(memcmp(pt, msg, sizeof(msg) - 1), 0, "");
+
+	/* The key is consumed on error as well. */
+	zassert_equal(fm_crypto_ephemeral_key_generate(&key), 0, "");
+	zassert_not_equal(fm_crypto_encrypt_to_server_with_key(&key, Q_invalid, sizeof(msg) - 1,
+							       msg, &ct_len, ct), 0, "");
+	zassert_equal(memcmp(&key, &zero_key, sizeof(key)), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_ecies_v)
+{
+	byte long_msg[100];
+	byte ct[65 + sizeof(long_msg) + 16];
+	word32 ct_len = sizeof(ct);
+
+	for (size_t i = 0; i < sizeof(long_msg); i++) {
+		long_msg[i] = (byte) i;
+	}
+
+	/* The second fragment is placed at the position of its ciphertext
+	 * and is encrypted in place. The others are not block aligned.
+	 */
+	memcpy(ct + 65 + 7, long_msg + 7, 40);
+
+	const struct fm_crypto_iovec msg_iov[] = {
+		{ .data = long_msg,          .nbytes = 7 },
+		{ .data = ct + 65 + 7,       .nbytes = 40 },
+		{ .data = long_msg + 47,     .nbytes = 0 },
+		{ .data = long_msg + 47,     .nbytes = 3 },
+		{ .data = long_msg + 50,     .nbytes = 50 },
+	};
+
+	zassert_equal(fm_crypto_encrypt_to_server_v(Q, msg_iov, ARRAY_SIZE(msg_iov),
+						    &ct_len, ct), 0, "");
+	zassert_equal(ct_len, sizeof(ct), "");
+
+	byte pt[sizeof(long_msg)];
+	word32 pt_len = sizeof(pt);
+	zassert_equal(_fm_server_decrypt(sizeof(ct), ct, &pt_len, pt), 0, "");
+	zassert_equal(pt_len, sizeof(long_msg), "");
+	zassert_equal(memcmp(pt, long_msg, sizeof(long_msg)), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_ecies_scratch)
+{
+	struct fm_crypto_ephemeral_key key;
+	byte ct[65 + sizeof(msg) - 1 + 16];
+	word32 ct_len = sizeof(ct);
+
+	SCRATCH_CHECK(fm_crypto_encrypt_to_server(Q, sizeof(msg) - 1, msg, &ct_len, ct));
+
+	/* The ECIES temporaries are borrowed from the scratch arena. */
+	zassert_true(fm_crypto_scratch_hwm_get() > 0, "");
+
+	zassert_equal(fm_crypto_ephemeral_key_generate(&key), 0, "");
+	SCRATCH_CHECK(fm_crypto_encrypt_to_server_with_key(&key, Q, sizeof(msg) - 1, msg,
+							   &ct_len, ct));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fm_crypto.h"
+#include "crypto_helper.h"
+
+/* Python: os.urandom(32) */
+static const byte Z[32] = {
+	0xb9, 0xc6, 0xa6, 0xd7, 0x9a, 0x5f, 0x60, 0xce,
+	0x9c, 0x3a, 0x0a, 0xf3, 0x8c, 0x80, 0x74, 0xdd,
+	0x4f, 0x57, 0x8e, 0xca, 0xce, 0x6d, 0xd7, 0xc5,
+	0xff, 0x92, 0x13, 0xb8, 0x35, 0x34, 0x6a, 0x73
+};
+
+/* Python: SHA-256(Z || 00000001 || "connect")[:16] */
+static const byte KDF_CONNECT[16] = {
+	0xb6, 0x7e, 0x5a, 0xba, 0x9e, 0x75, 0xcd, 0xd1,
+	0x0b, 0xf3, 0x03, 0x02, 0x1b, 0xb8, 0xdd, 0x61
+};
+
+/* Python: (SHA-256(Z || 00000001 || "diversify") ||
+ *          SHA-256(Z || 00000002 || "diversify") ||
+ *          SHA-256(Z || 00000003 || "diversify"))[:72]
+ */
+static const byte KDF_DIVERSIFY[72] = {
+	0x39, 0x58, 0x52, 0x6c, 0x97, 0xb3, 0x17, 0x9c,
+	0x52, 0x94, 0x27, 0xea, 0xee, 0x41, 0x8a, 0xa5,
+	0xd1, 0xf1, 0x6e, 0xb0, 0x3b, 0xfb, 0xe4, 0x3e,
+	0xe3, 0xb5, 0x77, 0x3f, 0x48, 0x59, 0xe5, 0xc6,
+	0x47, 0xdf, 0x28, 0x1c, 0xc9, 0xb4, 0x8b, 0x7e,
+	0x45, 0x8d, 0x9f, 0x27, 0x02, 0xd9, 0x80, 0x7e,
+	0x99, 0x0d, 0x7f, 0xc0, 0x9a, 0x2e, 0x6f, 0x84,
+	0x0d, 0xc2, 0xf6, 0xb4, 0x51, 0x51, 0xdd, 0xa7,
+	0x39, 0xda, 0x2a, 0xf9, 0xf8, 0x04, 0xed, 0x71
+};
+
+ZTEST(suite_fmn_crypto, test_kdf)
+{
+	static const char label_connect[] = "connect";
+	static const char label_diversify[] = "diversify";
+	byte out[72];
+
+	zassert_equal(ansi_x963_kdf(out, sizeof(KDF_CONNECT), Z, sizeof(Z),
+				    (const byte *) label_connect, strlen(label_connect)), 0, "");
+	zassert_equal(memcmp(out, KDF_CONNECT, sizeof(KDF_CONNECT)), 0, "");
+
+	/* Output that spans three digests, the last one truncated. */
+	zassert_equal(ansi_x963_kdf(out, sizeof(KDF_DIVERSIFY), Z, sizeof(Z),
+				    (const byte *) label_diversify, strlen(label_diversify)),
+		      0, "");
+	zassert_equal(memcmp(out, KDF_DIVERSIFY, sizeof(KDF_DIVERSIFY)), 0, "");
+}
@@ -7,6 +7,11 @@
 #include <zephyr/ztest.h>
 
 #include "fm_crypto.h"
+#include "fm_crypto_p224.h"
+#include "scratch_check.h"
+
+#include <ocrypto_curve_p224.h>
+#include <ocrypto_sc_p224.h>
 
 /*
 // A P-224 scalar. (Not known to the accessory.)
@@ -190,6 +195,85 @@ static const uint8_t LTK_2[16] = {
 	0xb2, 0x36, 0x97, 0x2f, 0x29, 0x27, 0x99, 0x07
 };
 
+/*
+ * Pre-scalar values (u_1, v_1) = ANSI-X9.63-KDF(SKN_1, "diversify").
+ *
+ * [Python]
+ * >>> import hashlib
+ * >>> skn = "41c86f894c53a546d0f8f7f31bb4f91968f5102b6d8e74994fca9e042744bc3b".decode("hex")
+ * >>> at = "".join(hashlib.sha256(skn + c.decode("hex") + b"diversify").digest()
+ * ...              for c in ("00000001", "00000002", "00000003"))[:72]
+ */
+static const uint8_t AT_1[72] = {
+	0x37, 0xc6, 0x13, 0x99, 0xea, 0x18, 0xa8, 0xbb,
+	0x2a, 0x34, 0xe2, 0x90, 0xa8, 0xc1, 0x96, 0x7d,
+	0x4e, 0x1e, 0x8f, 0x00, 0x2e, 0xb8, 0x7f, 0xbd,
+	0xac, 0x30, 0xdb, 0xeb, 0xa8, 0x69, 0x90, 0xfd,
+	0xdc, 0xa2, 0x87, 0xc8, 0x6b, 0xb6, 0x02, 0x6a,
+	0xca, 0x21, 0x7c, 0x4e, 0x17, 0x12, 0xdf, 0xfe,
+	0x4f, 0xd9, 0xa3, 0x8c, 0xcb, 0xb7, 0x08, 0x1a,
+	0xd5, 0xc2, 0xa5, 0xf9, 0xce, 0x3e, 0x4d, 0x09,
+	0x60, 0x23, 0xfa, 0x3a, 0x73, 0x19, 0x60, 0xda
+};
+
+/*
+ * Pre-scalar values (u_2, v_2) = ANSI-X9.63-KDF(SKN_2, "diversify").
+ *
+ * [Python]
+ * >>> import hashlib
+ * >>> skn = "2baa4520b786833621a7f9e806e0af2ee69370c3660188c1157e5203161b4067".decode("hex")
+ * >>> at = "".join(hashlib.sha256(skn + c.decode("hex") + b"diversify").digest()
+ * ...              for c in ("00000001", "00000002", "00000003"))[:72]
+ */
+static const uint8_t AT_2[72] = {
+	0x76, 0xec, 0xd3, 0x36, 0x67, 0x38, 0x5b, 0x87,
+	0x45, 0x65, 0x14, 0x18, 0x94, 0x65, 0x88, 0x70,
+	0x43, 0xea, 0x6e, 0x0a, 0x6c, 0xe3, 0xb7, 0x7f,
+	0xce, 0x0e, 0xfd, 0xa6, 0x6b, 0x4b, 0x12, 0xa1,
+	0x88, 0x9f, 0x73, 0x25, 0xfb, 0x9e, 0x69, 0xfd,
+	0x9c, 0xc7, 0x7a, 0x34, 0x59, 0x71, 0x7b, 0x3b,
+	0xe3, 0xe7, 0x40, 0x9d, 0x1f, 0x7a, 0xcc, 0x37,
+	0x45, 0x45, 0x49, 0x3b, 0x65, 0xbf, 0x26, 0xe4,
+	0x62, 0xbe, 0x44, 0xb9, 0x1d, 0xb9, 0x66, 0x22
+};
+
+/* Computes u * P + v * G with two scalar multiplications and a point addition. */
+static void twin_mult_two_step(uint8_t r[56], const uint8_t at[72], const uint8_t p[57])
+{
+	ocrypto_sc_p224 u;
+	ocrypto_sc_p224 v;
+	ocrypto_cp_p224 pt;
+	ocrypto_cp_p224 r1;
+	ocrypto_cp_p224 r2;
+	ocrypto_cp_p224 res;
+
+	ocrypto_sc_p224_from36bytes(&u, at);
+	ocrypto_sc_p224_from36bytes(&v, at + 36);
+
+	zassert_equal(ocrypto_curve_p224_from56bytes(&pt, p + 1), 0, "");
+	zassert_equal(ocrypto_curve_p224_scalarmult(&r1, &pt, &u), 0, "");
+	zassert_equal(ocrypto_curve_p224_scalarmult_base(&r2, &v), 0, "");
+	zassert_equal(ocrypto_curve_p224_add(&res, &r1, &r2), 0, "");
+
+	ocrypto_curve_p224_to56bytes(r, &res);
+}
+
+/* Computes u * P + v * G with the joint ladder. */
+static void twin_mult_joint(uint8_t r[56], const uint8_t at[72],
+			    const fm_crypto_p224_table *p_table)
+{
+	ocrypto_sc_p224 sc;
+	uint8_t u[28];
+	uint8_t v[28];
+
+	ocrypto_sc_p224_from36bytes(&sc, at);
+	ocrypto_sc_p224_to28bytes(u, &sc);
+	ocrypto_sc_p224_from36bytes(&sc, at + 36);
+	ocrypto_sc_p224_to28bytes(v, &sc);
+
+	zassert_equal(fm_crypto_p224_twin_mult(r, u, p_table, v), 0, "");
+}
+
 ZTEST(suite_fmn_crypto, test_keyroll)
 {
 	byte skn1[32];
@@ -216,6 +300,100 @@ ZTEST(suite_fmn_crypto, test_keyroll)
 	zassert_equal(fm_crypto_derive_ltk(skn2, ltk2), 0, "");
 	zassert_equal(memcmp(ltk2, LTK_2, sizeof(LTK_2)), 0, "");
 
+	/* Derivation with the imported master public key. */
+	static struct fm_crypto_master_pk master_pk;
+	zassert_equal(fm_crypto_master_pk_import(&master_pk, P), 0, "");
+
+	zassert_equal(fm_crypto_derive_primary_or_secondary_x_from_master(skn1, &master_pk, p1x),
+		      0, "");
+	zassert_equal(memcmp(p1x, x_P_1, sizeof(x_P_1)), 0, "");
+
+	zassert_equal(fm_crypto_derive_primary_or_secondary_x_from_master(skn2, &master_pk, p2x),
+		      0, "");
+	zassert_equal(memcmp(p2x, x_P_2, sizeof(x_P_2)), 0, "");
+
+	fm_crypto_master_pk_free(&master_pk);
+
 	/* Negative test vectors. */
 	zassert_not_equal(fm_crypto_derive_primary_or_secondary_x(skn1, P_invalid, p1x), 0, "");
+	zassert_not_equal(fm_crypto_master_pk_import(&master_pk, P_invalid), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_keyroll_twin_mult)
+{
+	static fm_crypto_p224_table p_table;
+	uint8_t expected[56];
+	uint8_t actual[56];
+
+	fm_crypto_p224_table_init(&p_table, P + 1);
+
+	twin_mult_two_step(expected, AT_1, P);
+	twin_mult_joint(actual, AT_1, &p_table);
+	zassert_equal(memcmp(actual, expected, sizeof(expected)), 0, "");
+	zassert_equal(memcmp(actual, x_P_1, sizeof(x_P_1)), 0, "");
+
+	twin_mult_two_step(expected, AT_2, P);
+	twin_mult_joint(actual, AT_2, &p_table);
+	zassert_equal(memcmp(actual, expected, sizeof(expected)), 0, "");
+	zassert_equal(memcmp(actual, x_P_2, sizeof(x_P_2)), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_keyroll_batch)
+{
+	/* Spans more than one chunk of the shared affine conversion. */
+	static struct fm_crypto_master_pk master_pk;
+	byte batch[FM_CRYPTO_P224_BATCH_MAX + 2][28];
+	byte batch_sk[FM_CRYPTO_P224_BATCH_MAX + 2][32];
+	byte expected[28];
+	byte sk[32];
+
+	zassert_equal(fm_crypto_derive_primary_keys_batch(SKN_0, P, 2, batch, NULL), 0, "");
+	zassert_equal(memcmp(batch[0], x_P_1, sizeof(x_P_1)), 0, "");
+	zassert_equal(memcmp(batch[1], x_P_2, sizeof(x_P_2)), 0, "");
+
+	zassert_equal(fm_crypto_master_pk_import(&master_pk, P), 0, "");
+	zassert_equal(fm_crypto_derive_primary_keys_batch_from_master(SKN_0, &master_pk,
+								      ARRAY_SIZE(batch), batch,
+								      batch_sk),
+		      0, "");
+	zassert_equal(memcmp(batch_sk[0], SKN_1, sizeof(SKN_1)), 0, "");
+
+	memcpy(sk, SKN_0, sizeof(sk));
+	for (size_t i = 0; i < ARRAY_SIZE(batch); i++) {
+		zassert_equal(fm_crypto_roll_sk(sk, sk), 0, "");
+		zassert_equal(memcmp(batch_sk[i], sk, sizeof(sk)), 0,
+			      "SK mismatch at index %zu", i + 1);
+		zassert_equal(fm_crypto_derive_primary_or_secondary_x_from_master(sk, &master_pk,
+										   expected),
+			      0, "");
+		zassert_equal(memcmp(batch[i], expected, sizeof(expected)), 0,
+			      "Mismatch at index %zu", i + 1);
+	}
+
+	fm_crypto_master_pk_free(&master_pk);
+
+	zassert_not_equal(fm_crypto_derive_primary_keys_batch(SKN_0, P_invalid, 2, batch,
+								  NULL), 0, "");
+}
+
+ZTEST(suite_fmn_crypto, test_keyroll_scratch)
+{
+	static struct fm_crypto_master_pk master_pk;
+	byte batch[FM_CRYPTO_P224_BATCH_MAX][28];
+	byte sk[32];
+	byte x[28];
+	byte ltk[16];
+
+	SCRATCH_CHECK(fm_crypto_roll_sk(SKN_0, sk));
+	SCRATCH_CHECK(fm_crypto_derive_ltk(SKN_1, ltk));
+	SCRATCH_CHECK(fm_crypto_derive_primary_or_secondary_x(SKN_1, P, x));
+	SCRATCH_CHECK(fm_crypto_derive_primary_keys_batch(SKN_0, P, ARRAY_SIZE(batch), batch,
+							  NULL));
+
+	zassert_equal(fm_crypto_master_pk_import(&master_pk, P), 0, "");
+	SCRATCH_CHECK(fm_crypto_derive_primary_or_secondary_x_from_master(SKN_1, &master_pk, x));
+	SCRATCH_CHECK(fm_crypto_derive_primary_keys_batch_from_master(SKN_0, &master_pk,
+								      ARRAY_SIZE(batch), batch,
+								      NULL));
+	fm_crypto_master_pk_free(&master_pk);
 }
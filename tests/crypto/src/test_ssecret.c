@@ -70,6 +70,17 @@ ZTEST(suite_fmn_crypto, test_ssecret)
 	zassert_equal(fm_crypto_authenticate_with_ksn(serverss, sizeof(msg) - 1, msg, mac), 0, "");
 	zassert_equal(memcmp(mac, MAC, sizeof(MAC)), 0, "");
 
+	/* The prepared KSN state must be reusable for several messages. */
+	struct fm_crypto_ksn_hmac ksn_hmac;
+	zassert_equal(fm_crypto_ksn_hmac_init(&ksn_hmac, serverss), 0, "");
+	for (int i = 0; i < 2; i++) {
+		memset(mac, 0, sizeof(mac));
+		zassert_equal(fm_crypto_authenticate_with_ksn_hmac(&ksn_hmac, sizeof(msg) - 1,
+								   msg, mac), 0, "");
+		zassert_equal(memcmp(mac, MAC, sizeof(MAC)), 0, "");
+	}
+	fm_crypto_ksn_hmac_free(&ksn_hmac);
+
 	/* Test SeedK1 generation. */
 	byte seedk1[32] = { 0 };
 	zassert_equal(fm_crypto_generate_seedk1(seedk1), 0, "");
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+/* Benchmark of the fm_crypto operations on the hot paths of the accessory.
+ *
+ * Each operation is run once to check its result and to measure its scratch
+ * arena usage, and then timed over a fixed number of iterations. The fm_crypto
+ * functions do not use the heap, so the scratch arena bytes are the memory
+ * borrowed by one call besides the caller stack.
+ *
+ * The primitives of every crypto backend built into the image are timed as
+ * well, and the fm_crypto operations run with every combination of the
+ * backends for SHA-256, P-256 and AES-GCM. Build with overlay-psa.conf to
+ * add PSA Crypto to the combinations.
+ *
+ * The results are printed as one JSON object per line, prefixed with
+ * "BENCH: " so that they can be extracted from the console log and compared
+ * between runs.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+
+#include <ocrypto_aes_gcm.h>
+
+#include "fm_crypto.h"
+#include "fm_crypto_backend.h"
+#include "crypto_helper.h"
+
+#define BENCH_MSG_LEN 1024
+
+#define KDF_LABEL_PAIRINGSESS "PairingSession"
+
+/* P-224 public key P = d * G with d = 0x000102...1b. */
+static const byte P[57] = {
+	0x04,
+	0x0b, 0x75, 0x43, 0x51, 0x20, 0xc3, 0x61, 0x42,
+	0x8b, 0xa8, 0xb6, 0xfa, 0x21, 0x9d, 0x65, 0xb7,
+	0xdc, 0xd9, 0xb5, 0x13, 0x02, 0xd4, 0x00, 0x09,
+	0xca, 0x7c, 0x6b, 0xba,
+	0x15, 0x24, 0x09, 0x0e, 0xc8, 0x34, 0x48, 0xb4,
+	0x1a, 0x21, 0x3e, 0x93, 0xd0, 0xee, 0x7b, 0x94,
+	0xba, 0x15, 0xfa, 0x49, 0xaf, 0xf3, 0xf6, 0x88,
+	0x63, 0xb1, 0xff, 0x4b
+};
+
+/* A random SKN as generated by the Collaborative Key Generation protocol. */
+static const byte SKN[32] = {
+	0xb9, 0xc6, 0xa6, 0xd7, 0x9a, 0x5f, 0x60, 0xce,
+	0x9c, 0x3a, 0x0a, 0xf3, 0x8c, 0x80, 0x74, 0xdd,
+	0x4f, 0x57, 0x8e, 0xca, 0xce, 0x6d, 0xd7, 0xc5,
+	0xff, 0x92, 0x13, 0xb8, 0x35, 0x34, 0x6a, 0x73
+};
+
+/* P-256 public key and signature of "sample" from RFC 6979, A.2.5. */
+static const byte Q[65] = {
+	0x04,
+	0x60, 0xfe, 0xd4, 0xba, 0x25, 0x5a, 0x9d, 0x31,
+	0xc9, 0x61, 0xeb, 0x74, 0xc6, 0x35, 0x6d, 0x68,
+	0xc0, 0x49, 0xb8, 0x92, 0x3b, 0x61, 0xfa, 0x6c,
+	0xe6, 0x69, 0x62, 0x2e, 0x60, 0xf2, 0x9f, 0xb6,
+	0x79, 0x03, 0xfe, 0x10, 0x08, 0xb8, 0xbc, 0x99,
+	0xa4, 0x1a, 0xe9, 0xe9, 0x56, 0x28, 0xbc, 0x64,
+	0xf2, 0xf1, 0xb2, 0x0c, 0x2d, 0x7e, 0x9f, 0x51,
+	0x77, 0xa3, 0xc2, 0x94, 0xd4, 0x46, 0x22, 0x99
+};
+
+static const byte sig[] = {
+	0x30, 0x44, 0x02, 0x20,
+	0xef, 0xd4, 0x8b, 0x2a, 0xac, 0xb6, 0xa8, 0xfd,
+	0x11, 0x40, 0xdd, 0x9c, 0xd4, 0x5e, 0x81, 0xd6,
+	0x9d, 0x2c, 0x87, 0x7b, 0x56, 0xaa, 0xf9, 0x91,
+	0xc3, 0x4d, 0x0e, 0xa8, 0x4e, 0xaf, 0x37, 0x16,
+	0x02, 0x20,
+	0xf7, 0xcb, 0x1c, 0x94, 0x2d, 0x65, 0x7c, 0x41,
+	0xd4, 0x36, 0xc7, 0xa1, 0xb6, 0xe2, 0x9f, 0x65,
+	0xf3, 0xe9, 0x00, 0xdb, 0xb9, 0xaf, 0xf4, 0x06,
+	0x4d, 0xc4, 0xab, 0x2f, 0x84, 0x3a, 0xcd, 0xa8
+};
+
+static const byte sig_msg[] = "sample";
+
+/* SHA-256 of sig_msg and the private key of Q. */
+static const byte sig_hash[32] = {
+	0xaf, 0x2b, 0xdb, 0xe1, 0xaa, 0x9b, 0x6e, 0xc1,
+	0xe2, 0xad, 0xe1, 0xd6, 0x94, 0xf4, 0x1f, 0xc7,
+	0x1a, 0x83, 0x1d, 0x02, 0x68, 0xe9, 0x89, 0x15,
+	0x62, 0x11, 0x3d, 0x8a, 0x62, 0xad, 0xd1, 0xbf
+};
+
+static const byte Q_sk[32] = {
+	0xc9, 0xaf, 0xa9, 0xd8, 0x45, 0xba, 0x75, 0x16,
+	0x6b, 0x5c, 0x21, 0x57, 0x67, 0xb1, 0xd6, 0x93,
+	0x4e, 0x50, 0xc3, 0xdb, 0x36, 0xe8, 0x9b, 0x12,
+	0x7b, 0x8a, 0x62, 0x2b, 0x12, 0x0f, 0x67, 0x21
+};
+
+/* Random ServerSharedSecret. */
+static const byte SERVER_SS[32] = {
+	0x18, 0xfb, 0xa2, 0xc2, 0x5c, 0xb5, 0xea, 0x27,
+	0x5d, 0x4b, 0xb0, 0x93, 0xea, 0x43, 0xe2, 0x26,
+	0xe7, 0x31, 0x25, 0x03, 0x02, 0x9b, 0x8e, 0x93,
+	0xc0, 0x56, 0x45, 0x6b, 0xfd, 0x0a, 0x14, 0xd8
+};
+
+static struct fm_crypto_master_pk master_pk;
+static fm_crypto_p256_comb_table q_table;
+
+static byte msg[BENCH_MSG_LEN];
+static byte ct[65 + BENCH_MSG_LEN + 16];
+static byte e3[BENCH_MSG_LEN + 16];
+static byte pt[BENCH_MSG_LEN];
+
+struct bench_case {
+	const char *name;
+	uint32_t iterations;
+	int (*run)(void);
+};
+
+static int bench_roll_sk(void)
+{
+	byte out[32];
+
+	return fm_crypto_roll_sk(SKN, out);
+}
+
+static int bench_derive_ltk(void)
+{
+	byte out[16];
+
+	return fm_crypto_derive_ltk(SKN, out);
+}
+
+static int bench_derive_x(void)
+{
+	byte out[28];
+
+	return fm_crypto_derive_primary_or_secondary_x(SKN, P, out);
+}
+
+static int bench_derive_x_from_master(void)
+{
+	byte out[28];
+
+	return fm_crypto_derive_primary_or_secondary_x_from_master(SKN, &master_pk, out);
+}
+
+static int bench_encrypt_to_server(void)
+{
+	word32 ct_len = sizeof(ct);
+
+	return fm_crypto_encrypt_to_server(Q, sizeof(msg), msg, &ct_len, ct);
+}
+
+static int bench_decrypt_e3(void)
+{
+	word32 pt_len = sizeof(pt);
+
+	return fm_crypto_decrypt_e3(SERVER_SS, sizeof(e3), e3, &pt_len, pt);
+}
+
+static int bench_verify_s2(void)
+{
+	return fm_crypto_verify_s2(Q, sizeof(sig), sig, sizeof(sig_msg) - 1, sig_msg);
+}
+
+static int bench_verify_s2_with_table(void)
+{
+	return fm_crypto_verify_s2_with_table(&q_table, sizeof(sig), sig,
+					      sizeof(sig_msg) - 1, sig_msg);
+}
+
+/* Backend whose primitives are timed by the backend cases. */
+static const struct fm_crypto_backend *backend;
+
+static int bench_backend_sha256(void)
+{
+	byte out[32];
+	const struct fm_crypto_iovec msg_iov = { .data = msg, .nbytes = sizeof(msg) };
+
+	return backend->sha256_v(out, &msg_iov, 1);
+}
+
+static int bench_backend_p256_ecdh(void)
+{
+	byte secret[32];
+
+	return backend->p256_ecdh(secret, Q_sk, Q + 1);
+}
+
+static int bench_backend_p256_ecdsa_verify_hash(void)
+{
+	byte sig_raw[64];
+
+	/* Strip the DER encoding, both integers are 32 bytes long. */
+	memcpy(sig_raw, sig + 4, 32);
+	memcpy(sig_raw + 32, sig + 38, 32);
+
+	return backend->p256_ecdsa_verify_hash(sig_raw, sig_hash, Q + 1);
+}
+
+static int bench_backend_aes128gcm_encrypt(void)
+{
+	byte tag[16];
+	const struct fm_crypto_iovec msg_iov = { .data = msg, .nbytes = sizeof(msg) };
+
+	return backend->aes128gcm_encrypt_v(SERVER_SS, SERVER_SS + 16, &msg_iov, 1, pt, tag);
+}
+
+static const struct bench_case backend_cases[] = {
+	{ "sha256", 1000, bench_backend_sha256 },
+	{ "p256_ecdh", 20, bench_backend_p256_ecdh },
+	{ "p256_ecdsa_verify_hash", 20, bench_backend_p256_ecdsa_verify_hash },
+	{ "aes128gcm_encrypt", 200, bench_backend_aes128gcm_encrypt },
+};
+
+static const struct fm_crypto_backend *const backends[] = {
+	&fm_crypto_backend_oberon,
+#if defined(CONFIG_FMNA_CRYPTO_PSA)
+	&fm_crypto_backend_psa,
+#endif
+};
+
+static const struct bench_case bench_cases[] = {
+	{ "roll_sk", 1000, bench_roll_sk },
+	{ "derive_ltk", 1000, bench_derive_ltk },
+	{ "derive_primary_or_secondary_x", 20, bench_derive_x },
+	{ "derive_primary_or_secondary_x_from_master", 20, bench_derive_x_from_master },
+	{ "encrypt_to_server", 20, bench_encrypt_to_server },
+	{ "decrypt_e3", 200, bench_decrypt_e3 },
+	{ "verify_s2", 20, bench_verify_s2 },
+	{ "verify_s2_with_table", 20, bench_verify_s2_with_table },
+};
+
+/* Encrypt the message as the server does for E3. */
+static int e3_generate(void)
+{
+	int err;
+	ocrypto_aes_gcm_ctx ctx;
+	struct {
+		uint8_t k1[16];
+		uint8_t iv1[16];
+	} k_iv;
+
+	err = ansi_x963_kdf((uint8_t *) &k_iv, sizeof(k_iv),
+			    SERVER_SS, sizeof(SERVER_SS),
+			    (const uint8_t *) KDF_LABEL_PAIRINGSESS,
+			    sizeof(KDF_LABEL_PAIRINGSESS) - 1);
+	if (err) {
+		return err;
+	}
+
+	ocrypto_aes_gcm_init(&ctx, k_iv.k1, sizeof(k_iv.k1), k_iv.iv1);
+	ocrypto_aes_gcm_init_iv(&ctx, k_iv.iv1, sizeof(k_iv.iv1));
+	ocrypto_aes_gcm_update_enc(&ctx, e3, msg, sizeof(msg));
+	ocrypto_aes_gcm_final_enc(&ctx, e3 + sizeof(msg), 16);
+
+	return 0;
+}
+
+static void bench_run(const char *backend_name, const struct bench_case *bench)
+{
+	int err;
+	timing_t start;
+	timing_t end;
+	uint64_t ns;
+	uint64_t ns_total = 0;
+	uint64_t ns_min = UINT64_MAX;
+	word32 scratch_bytes;
+
+	/* Check the result and measure the arena usage of a single call. */
+	fm_crypto_scratch_hwm_reset();
+	err = bench->run();
+	scratch_bytes = fm_crypto_scratch_hwm_get();
+	if (err) {
+		printk("BENCH: {\"backend\": \"%s\", \"op\": \"%s\", \"err\": %d}\n",
+		       backend_name, bench->name, err);
+		return;
+	}
+
+	for (uint32_t i = 0; i < bench->iterations; i++) {
+		start = timing_counter_get();
+		(void) bench->run();
+		end = timing_counter_get();
+
+		ns = timing_cycles_to_ns(timing_cycles_get(&start, &end));
+		ns_total += ns;
+		if (ns < ns_min) {
+			ns_min = ns;
+		}
+	}
+
+	printk("BENCH: {\"backend\": \"%s\", \"op\": \"%s\", \"iterations\": %u, "
+	       "\"ns_per_op\": %llu, \"ns_min\": %llu, \"scratch_bytes\": %u}\n",
+	       backend_name, bench->name, bench->iterations,
+	       (unsigned long long) (ns_total / bench->iterations),
+	       (unsigned long long) ns_min, scratch_bytes);
+}
+
+static void bench_combination_run(const struct fm_crypto_backend *sha256,
+				  const struct fm_crypto_backend *p256,
+				  const struct fm_crypto_backend *aes_gcm)
+{
+	static char name[48];
+
+	snprintk(name, sizeof(name), "sha256=%s,p256=%s,aes_gcm=%s",
+		 sha256->name, p256->name, aes_gcm->name);
+
+	fm_crypto_backend.name = name;
+	fm_crypto_backend.sha256_v = sha256->sha256_v;
+	fm_crypto_backend.p256_ecdh = p256->p256_ecdh;
+	fm_crypto_backend.p256_ecdsa_verify_hash = p256->p256_ecdsa_verify_hash;
+	fm_crypto_backend.aes128gcm_encrypt_v = aes_gcm->aes128gcm_encrypt_v;
+	fm_crypto_backend.aes128gcm_decrypt = aes_gcm->aes128gcm_decrypt;
+
+	for (size_t i = 0; i < ARRAY_SIZE(bench_cases); i++) {
+		bench_run(fm_crypto_backend.name, &bench_cases[i]);
+	}
+}
+
+void main(void)
+{
+	int err;
+	const struct fm_crypto_backend selected_backend = fm_crypto_backend;
+
+	for (size_t i = 0; i < sizeof(msg); i++) {
+		msg[i] = (byte) i;
+	}
+
+	err = e3_generate();
+	if (err) {
+		printk("BENCH: E3 generation failed: %d\n", err);
+		return;
+	}
+
+	err = fm_crypto_master_pk_import(&master_pk, P);
+	if (err) {
+		printk("BENCH: master public key import failed: %d\n", err);
+		return;
+	}
+
+	/* Comb table of Q used by the server signature verification, see
+	 * FMNA_SERVER_SIG_VERIFICATION_TABLE.
+	 */
+	fm_crypto_p256_comb_table_init(&q_table, Q + 1);
+
+	timing_init();
+	timing_start();
+
+	printk("BENCH: {\"board\": \"%s\", \"scratch_size\": %u, \"sha256\": \"%s\", "
+	       "\"p256\": \"%s\", \"aes_gcm\": \"%s\"}\n",
+	       CONFIG_BOARD, fm_crypto_scratch_size_get(),
+	       IS_ENABLED(CONFIG_FMNA_CRYPTO_SHA256_BACKEND_PSA) ? "psa" : "oberon",
+	       IS_ENABLED(CONFIG_FMNA_CRYPTO_P256_BACKEND_PSA) ? "psa" : "oberon",
+	       IS_ENABLED(CONFIG_FMNA_CRYPTO_AES_GCM_BACKEND_PSA) ? "psa" : "oberon");
+
+	for (size_t i = 0; i < ARRAY_SIZE(backends); i++) {
+		backend = backends[i];
+
+		for (size_t j = 0; j < ARRAY_SIZE(backend_cases); j++) {
+			bench_run(backend->name, &backend_cases[j]);
+		}
+	}
+
+	/* Run the fm_crypto operations with every combination of the backends
+	 * that provide each primitive. P-224 is only provided by nrf_oberon.
+	 */
+	for (size_t i = 0; i < ARRAY_SIZE(backends); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(backends); j++) {
+			for (size_t k = 0; k < ARRAY_SIZE(backends); k++) {
+				bench_combination_run(backends[i], backends[j], backends[k]);
+			}
+		}
+	}
+
+	fm_crypto_backend = selected_backend;
+
+	timing_stop();
+
+	fm_crypto_master_pk_free(&master_pk);
+
+	printk("BENCH: done\n");
+}
@@ -0,0 +1,9 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+ZTEST_SUITE(suite_fmn_gatt, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "peer_fake.h"
+
+#define PEER_FAKE_MTU 247
+#define PEER_FAKE_LOG_SIZE 32
+
+/* Fragment header, opcode and the message tag. */
+#define PEER_FAKE_IND_LEN 4
+
+struct peer_fake {
+	struct bt_gatt_indicate_params *in_flight;
+	struct peer_fake_ind log[PEER_FAKE_LOG_SIZE];
+	size_t log_cnt;
+};
+
+/* The FMN code only uses the connection pointers as handles. */
+static uint8_t conn_handles[PEER_FAKE_CNT];
+static struct peer_fake peers[PEER_FAKE_CNT];
+
+struct bt_conn *peer_fake_conn(uint8_t index)
+{
+	return (struct bt_conn *) &conn_handles[index];
+}
+
+static uint8_t peer_fake_index(const struct bt_conn *conn)
+{
+	uint8_t index = (const uint8_t *) conn - conn_handles;
+
+	zassert_true(index < PEER_FAKE_CNT, "Unknown connection");
+
+	return index;
+}
+
+uint8_t __wrap_bt_conn_index(const struct bt_conn *conn)
+{
+	return peer_fake_index(conn);
+}
+
+uint16_t __wrap_bt_gatt_get_mtu(struct bt_conn *conn)
+{
+	return PEER_FAKE_MTU;
+}
+
+int __wrap_bt_gatt_indicate(struct bt_conn *conn, struct bt_gatt_indicate_params *params)
+{
+	const uint8_t *data = params->data;
+	struct peer_fake *peer = &peers[peer_fake_index(conn)];
+	struct peer_fake_ind *ind;
+
+	/* Without Enhanced ATT the host sends one indication at a time. */
+	zassert_is_null(peer->in_flight, "Indication sent before the confirmation");
+	zassert_equal(params->len, PEER_FAKE_IND_LEN, "");
+	zassert_true(peer->log_cnt < ARRAY_SIZE(peer->log), "");
+
+	ind = &peer->log[peer->log_cnt++];
+	ind->opcode = sys_get_le16(&data[1]);
+	ind->tag = data[3];
+
+	peer->in_flight = params;
+
+	return 0;
+}
+
+void peer_fake_reset(void)
+{
+	/* Drain what the previous test left in the queues. */
+	for (uint8_t i = 0; i < PEER_FAKE_CNT; i++) {
+		while (peer_fake_in_flight(i)) {
+			peer_fake_confirm(i);
+		}
+	}
+
+	memset(peers, 0, sizeof(peers));
+}
+
+size_t peer_fake_ind_cnt(uint8_t index)
+{
+	return peers[index].log_cnt;
+}
+
+const struct peer_fake_ind *peer_fake_ind_get(uint8_t index, size_t i)
+{
+	zassert_true(i < peers[index].log_cnt, "Indication %zu was not received", i);
+
+	return &peers[index].log[i];
+}
+
+int peer_fake_confirm(uint8_t index)
+{
+	struct bt_gatt_indicate_params *params = peers[index].in_flight;
+
+	if (!params) {
+		return -ENOENT;
+	}
+
+	/* The callback may send the next queued indication. */
+	peers[index].in_flight = NULL;
+	params->func(peer_fake_conn(index), params, 0);
+
+	return 0;
+}
+
+bool peer_fake_in_flight(uint8_t index)
+{
+	return peers[index].in_flight != NULL;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#ifndef PEER_FAKE_H_
+#define PEER_FAKE_H_
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/net/buf.h>
+
+#define PEER_FAKE_CNT CONFIG_BT_MAX_CONN
+
+/* Indication as seen by the peer. */
+struct peer_fake_ind {
+	uint16_t opcode;
+	uint8_t tag;
+};
+
+struct bt_conn *peer_fake_conn(uint8_t index);
+
+void peer_fake_reset(void);
+
+/* Number of indications received by the peer so far. */
+size_t peer_fake_ind_cnt(uint8_t index);
+
+const struct peer_fake_ind *peer_fake_ind_get(uint8_t index, size_t i);
+
+/* Confirm the indication in flight, the queued one may then be sent. */
+int peer_fake_confirm(uint8_t index);
+
+bool peer_fake_in_flight(uint8_t index);
+
+/* Control point message of one byte that identifies it in the log. */
+#define PEER_FAKE_MSG_DEFINE(_name, _tag)	\
+	NET_BUF_SIMPLE_DEFINE(_name, 1);	\
+	net_buf_simple_add_u8(&_name, _tag)
+
+#endif /* PEER_FAKE_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fmna_gatt_fmns.h"
+#include "peer_fake.h"
+
+static int config_send(uint8_t index, uint8_t tag)
+{
+	PEER_FAKE_MSG_DEFINE(msg, tag);
+
+	return fmna_gatt_config_cp_indicate(peer_fake_conn(index),
+					    FMNA_GATT_CONFIG_COMMAND_RESPONSE_IND, &msg);
+}
+
+ZTEST(suite_fmn_gatt, test_ind_pool_full)
+{
+	struct fmna_gatt_ind_pool_stats before;
+	struct fmna_gatt_ind_pool_stats stats;
+	uint8_t last = PEER_FAKE_CNT - 1;
+
+	peer_fake_reset();
+	fmna_gatt_ind_pool_stats_get(&before);
+	zassert_equal(before.used, 0, "");
+
+	/* The message in flight is not stored in the pool. */
+	zassert_equal(config_send(0, 0), 0, "");
+	for (uint8_t i = 1; i <= CONFIG_FMNA_GATT_IND_QUEUE_SIZE; i++) {
+		zassert_equal(config_send(0, i), 0, "Message %u was not queued", i);
+	}
+
+	fmna_gatt_ind_pool_stats_get(&stats);
+	zassert_equal(stats.used, CONFIG_FMNA_GATT_IND_QUEUE_SIZE, "");
+	zassert_equal(stats.used_max, CONFIG_FMNA_GATT_IND_QUEUE_SIZE, "");
+	zassert_equal(stats.alloc_failures, before.alloc_failures, "");
+
+	/* The pool is full, the message is rejected and the failure counted. */
+	zassert_equal(config_send(0, 0xFF), -ENOMEM, "");
+
+	fmna_gatt_ind_pool_stats_get(&stats);
+	zassert_equal(stats.used, CONFIG_FMNA_GATT_IND_QUEUE_SIZE, "");
+	zassert_equal(stats.alloc_failures, before.alloc_failures + 1, "");
+
+	/* The pool is shared by the connections. Another peer can still get a
+	 * message in flight, but it cannot queue the next one.
+	 */
+	if (last > 0) {
+		zassert_equal(config_send(last, 0), 0, "");
+		zassert_equal(config_send(last, 0xFF), -ENOMEM, "");
+
+		fmna_gatt_ind_pool_stats_get(&stats);
+		zassert_equal(stats.alloc_failures, before.alloc_failures + 2, "");
+
+		zassert_equal(peer_fake_confirm(last), 0, "");
+		zassert_false(peer_fake_in_flight(last), "");
+	}
+
+	/* The rejected message was not sent and the queued ones are released. */
+	for (uint8_t i = 0; i <= CONFIG_FMNA_GATT_IND_QUEUE_SIZE; i++) {
+		zassert_equal(peer_fake_ind_get(0, i)->tag, i, "");
+		zassert_equal(peer_fake_confirm(0), 0, "");
+	}
+
+	zassert_false(peer_fake_in_flight(0), "");
+	zassert_equal(peer_fake_ind_cnt(0), CONFIG_FMNA_GATT_IND_QUEUE_SIZE + 1, "");
+
+	fmna_gatt_ind_pool_stats_get(&stats);
+	zassert_equal(stats.used, 0, "");
+	zassert_equal(stats.used_max, CONFIG_FMNA_GATT_IND_QUEUE_SIZE, "");
+
+	/* The pool is usable again. */
+	zassert_equal(config_send(0, 1), 0, "");
+	zassert_equal(config_send(0, 2), 0, "");
+
+	fmna_gatt_ind_pool_stats_get(&stats);
+	zassert_equal(stats.used, 1, "");
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fmna_gatt_fmns.h"
+#include "peer_fake.h"
+
+/* Opcodes of the indications as defined by the Find My Network service. */
+#define PAIRING_DATA_OPCODE 0x0101
+#define CONFIG_COMMAND_RESPONSE_OPCODE 0x020B
+#define OWNER_COMMAND_RESPONSE_OPCODE 0x0406
+
+static int pairing_send(uint8_t index, uint8_t tag)
+{
+	PEER_FAKE_MSG_DEFINE(msg, tag);
+
+	return fmna_gatt_pairing_cp_indicate(peer_fake_conn(index), FMNA_GATT_PAIRING_DATA_IND,
+					     &msg);
+}
+
+static int config_send(uint8_t index, uint8_t tag)
+{
+	PEER_FAKE_MSG_DEFINE(msg, tag);
+
+	return fmna_gatt_config_cp_indicate(peer_fake_conn(index),
+					    FMNA_GATT_CONFIG_COMMAND_RESPONSE_IND, &msg);
+}
+
+static int owner_send(uint8_t index, uint8_t tag)
+{
+	PEER_FAKE_MSG_DEFINE(msg, tag);
+
+	return fmna_gatt_owner_cp_indicate(peer_fake_conn(index),
+					   FMNA_GATT_OWNER_COMMAND_RESPONSE_IND, &msg);
+}
+
+static void ind_check(uint8_t index, size_t i, uint16_t opcode, uint8_t tag)
+{
+	const struct peer_fake_ind *ind = peer_fake_ind_get(index, i);
+
+	zassert_equal(ind->opcode, opcode, "Indication %zu of peer %u has opcode 0x%04X",
+		      i, index, ind->opcode);
+	zassert_equal(ind->tag, tag, "Indication %zu of peer %u is message %u",
+		      i, index, ind->tag);
+}
+
+ZTEST(suite_fmn_gatt, test_ind_queue_order)
+{
+	struct fmna_gatt_ind_stats stats;
+
+	peer_fake_reset();
+
+	/* The first message is sent, the others wait for its confirmation. */
+	zassert_equal(pairing_send(0, 1), 0, "");
+	zassert_equal(config_send(0, 2), 0, "");
+	zassert_equal(owner_send(0, 3), 0, "");
+	zassert_equal(pairing_send(0, 4), 0, "");
+
+	zassert_equal(peer_fake_ind_cnt(0), 1, "");
+	zassert_equal(fmna_gatt_ind_stats_get(peer_fake_conn(0), &stats), 0, "");
+	zassert_equal(stats.queue_depth, 3, "");
+	zassert_true(stats.queue_depth_max >= 3, "");
+
+	/* The peer receives the messages in the order they were requested. */
+	for (size_t i = 1; i < 4; i++) {
+		zassert_equal(peer_fake_confirm(0), 0, "");
+		zassert_equal(peer_fake_ind_cnt(0), i + 1, "Message %zu was not sent", i + 1);
+	}
+
+	zassert_equal(peer_fake_confirm(0), 0, "");
+	zassert_false(peer_fake_in_flight(0), "");
+
+	ind_check(0, 0, PAIRING_DATA_OPCODE, 1);
+	ind_check(0, 1, CONFIG_COMMAND_RESPONSE_OPCODE, 2);
+	ind_check(0, 2, OWNER_COMMAND_RESPONSE_OPCODE, 3);
+	ind_check(0, 3, PAIRING_DATA_OPCODE, 4);
+
+	zassert_equal(fmna_gatt_ind_stats_get(peer_fake_conn(0), &stats), 0, "");
+	zassert_equal(stats.queue_depth, 0, "");
+	zassert_equal(stats.in_flight_max, 1, "");
+}
+
+ZTEST(suite_fmn_gatt, test_ind_queue_per_conn)
+{
+	if (PEER_FAKE_CNT < 2) {
+		ztest_test_skip();
+	}
+
+	peer_fake_reset();
+
+	zassert_equal(pairing_send(0, 1), 0, "");
+	zassert_equal(config_send(0, 2), 0, "");
+
+	/* A peer that did not confirm yet does not hold back the other one. */
+	zassert_equal(config_send(1, 10), 0, "");
+	zassert_equal(peer_fake_ind_cnt(1), 1, "");
+	zassert_equal(owner_send(1, 11), 0, "");
+
+	zassert_equal(peer_fake_confirm(1), 0, "");
+	zassert_equal(peer_fake_ind_cnt(1), 2, "");
+	zassert_equal(peer_fake_confirm(1), 0, "");
+	zassert_false(peer_fake_in_flight(1), "");
+
+	ind_check(1, 0, CONFIG_COMMAND_RESPONSE_OPCODE, 10);
+	ind_check(1, 1, OWNER_COMMAND_RESPONSE_OPCODE, 11);
+
+	/* The first peer still waits for its own confirmation. */
+	zassert_equal(peer_fake_ind_cnt(0), 1, "");
+
+	zassert_equal(peer_fake_confirm(0), 0, "");
+	ind_check(0, 1, CONFIG_COMMAND_RESPONSE_OPCODE, 2);
+	zassert_equal(peer_fake_confirm(0), 0, "");
+	zassert_false(peer_fake_in_flight(0), "");
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+/* Throughput benchmark of the FMN control point indications.
+ *
+ * The accessory advertises as a connectable peripheral. Connect with a GATT
+ * client that subscribes to the indications of the Pairing, Configuration
+ * and Owner control points of the Find My Network service. Once the settle
+ * time has passed, one message is sent on each of the three control points
+ * in every round, and the next round starts when all of them are confirmed.
+ *
+ * Build with overlay-eatt.conf to send the messages in parallel on Enhanced
+ * ATT bearers. The default configuration sends one message at a time on the
+ * unenhanced bearer. The peer must support Enhanced ATT for the bearers to be
+ * opened, otherwise both builds give the same result.
+ *
+ * The results are printed as one JSON object per line, prefixed with
+ * "BENCH: " so that they can be extracted from the console log and compared
+ * between runs.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/att.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/settings/settings.h>
+
+#include "fmna_gatt_fmns.h"
+
+#define BENCH_MSG_LEN 512
+#define BENCH_ROUNDS 20
+#define BENCH_MSGS_PER_ROUND 3
+#define BENCH_SETTLE_TIME K_SECONDS(10)
+#define BENCH_ROUND_TIMEOUT_MS 10000
+
+static struct bt_conn *bench_conn;
+static K_SEM_DEFINE(bench_conn_sem, 0, 1);
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME,
+		(sizeof(CONFIG_BT_DEVICE_NAME) - 1)),
+};
+
+static void connected(struct bt_conn *conn, uint8_t conn_err)
+{
+	if (conn_err || bench_conn) {
+		return;
+	}
+
+	bench_conn = bt_conn_ref(conn);
+	k_sem_give(&bench_conn_sem);
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	if (conn != bench_conn) {
+		return;
+	}
+
+	printk("BENCH: disconnected, reason: 0x%02X\n", reason);
+}
+
+BT_CONN_CB_DEFINE(bench_conn_callbacks) = {
+	.connected = connected,
+	.disconnected = disconnected,
+};
+
+static int bench_round_send(struct bt_conn *conn)
+{
+	int err;
+
+	NET_BUF_SIMPLE_DEFINE(msg, BENCH_MSG_LEN);
+
+	for (size_t i = 0; i < BENCH_MSG_LEN; i++) {
+		net_buf_simple_add_u8(&msg, (uint8_t) i);
+	}
+
+	err = fmna_gatt_pairing_cp_indicate(conn, FMNA_GATT_PAIRING_DATA_IND, &msg);
+	if (err) {
+		return err;
+	}
+
+	err = fmna_gatt_config_cp_indicate(conn, FMNA_GATT_CONFIG_COMMAND_RESPONSE_IND, &msg);
+	if (err) {
+		return err;
+	}
+
+	return fmna_gatt_owner_cp_indicate(conn, FMNA_GATT_OWNER_COMMAND_RESPONSE_IND, &msg);
+}
+
+static int bench_round_wait(struct bt_conn *conn, uint32_t sent)
+{
+	int err;
+	int64_t start = k_uptime_get();
+	struct fmna_gatt_ind_stats stats;
+
+	do {
+		err = fmna_gatt_ind_stats_get(conn, &stats);
+		if (err) {
+			return err;
+		}
+
+		if (stats.sent >= sent) {
+			return 0;
+		}
+
+		k_sleep(K_MSEC(1));
+	} while (k_uptime_get() - start < BENCH_ROUND_TIMEOUT_MS);
+
+	return -ETIMEDOUT;
+}
+
+static void bench_run(struct bt_conn *conn)
+{
+	int err;
+	int64_t start;
+	uint32_t time_ms;
+	uint32_t bytes;
+	size_t bearers = 1;
+	struct fmna_gatt_ind_stats stats;
+	struct fmna_gatt_ind_pool_stats pool_stats;
+
+	err = fmna_gatt_ind_stats_get(conn, &stats);
+	if (err) {
+		printk("BENCH: fmna_gatt_ind_stats_get returned error: %d\n", err);
+		return;
+	}
+
+#if CONFIG_BT_EATT
+	bearers += bt_eatt_count(conn);
+#endif
+
+	start = k_uptime_get();
+
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		err = bench_round_send(conn);
+		if (err) {
+			printk("BENCH: {\"round\": %u, \"err\": %d}\n", i, err);
+			return;
+		}
+
+		err = bench_round_wait(conn, stats.sent + (i + 1) * BENCH_MSGS_PER_ROUND);
+		if (err) {
+			printk("BENCH: {\"round\": %u, \"err\": %d}\n", i, err);
+			return;
+		}
+	}
+
+	time_ms = (uint32_t) (k_uptime_get() - start);
+	bytes = BENCH_ROUNDS * BENCH_MSGS_PER_ROUND * BENCH_MSG_LEN;
+
+	err = fmna_gatt_ind_stats_get(conn, &stats);
+	if (err) {
+		printk("BENCH: fmna_gatt_ind_stats_get returned error: %d\n", err);
+		return;
+	}
+
+	fmna_gatt_ind_pool_stats_get(&pool_stats);
+
+	printk("BENCH: {\"board\": \"%s\", \"eatt\": %s, \"bearers\": %u, \"mtu\": %u, "
+	       "\"messages\": %u, \"bytes\": %u, \"time_ms\": %u, \"bytes_per_s\": %u, "
+	       "\"in_flight_max\": %u, \"latency_max_ms\": %u, \"queue_depth_max\": %u, "
+	       "\"pool_used_max\": %u, \"pool_alloc_failures\": %u}\n",
+	       CONFIG_BOARD, IS_ENABLED(CONFIG_FMNA_GATT_EATT) ? "true" : "false",
+	       bearers, bt_gatt_get_mtu(conn), BENCH_ROUNDS * BENCH_MSGS_PER_ROUND,
+	       bytes, time_ms, time_ms ? (uint32_t) ((uint64_t) bytes * 1000 / time_ms) : 0,
+	       stats.in_flight_max, stats.latency_max_ms, stats.queue_depth_max,
+	       pool_stats.used_max, pool_stats.alloc_failures);
+}
+
+void main(void)
+{
+	int err;
+
+	err = bt_enable(NULL);
+	if (err) {
+		printk("BENCH: bt_enable returned error: %d\n", err);
+		return;
+	}
+
+	if (IS_ENABLED(CONFIG_SETTINGS)) {
+		err = settings_load();
+		if (err) {
+			printk("BENCH: settings_load returned error: %d\n", err);
+			return;
+		}
+	}
+
+	err = bt_le_adv_start(BT_LE_ADV_CONN, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (err) {
+		printk("BENCH: bt_le_adv_start returned error: %d\n", err);
+		return;
+	}
+
+	printk("BENCH: waiting for a connection\n");
+	k_sem_take(&bench_conn_sem, K_FOREVER);
+
+	/* Enhanced ATT bearers can only be opened on an encrypted link. */
+	if (IS_ENABLED(CONFIG_FMNA_GATT_EATT)) {
+		err = bt_conn_set_security(bench_conn, BT_SECURITY_L2);
+		if (err) {
+			printk("BENCH: bt_conn_set_security returned error: %d\n", err);
+		}
+	}
+
+	/* Let the peer subscribe to the control points and open the bearers. */
+	k_sleep(BENCH_SETTLE_TIME);
+
+	bench_run(bench_conn);
+
+	printk("BENCH: done\n");
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fmna_keys_lookahead.h"
+
+#define LOOKAHEAD_WAIT_TIMEOUT_MS 5000
+
+/* Same key schedule as in tests/crypto/src/test_keyroll.c. */
+static const uint8_t P[57] = {
+	0x04,
+	0x0b, 0x75, 0x43, 0x51, 0x20, 0xc3, 0x61, 0x42,
+	0x8b, 0xa8, 0xb6, 0xfa, 0x21, 0x9d, 0x65, 0xb7,
+	0xdc, 0xd9, 0xb5, 0x13, 0x02, 0xd4, 0x00, 0x09,
+	0xca, 0x7c, 0x6b, 0xba,
+	0x15, 0x24, 0x09, 0x0e, 0xc8, 0x34, 0x48, 0xb4,
+	0x1a, 0x21, 0x3e, 0x93, 0xd0, 0xee, 0x7b, 0x94,
+	0xba, 0x15, 0xfa, 0x49, 0xaf, 0xf3, 0xf6, 0x88,
+	0x63, 0xb1, 0xff, 0x4b
+};
+
+static const uint8_t SKN_0[32] = {
+	0xb9, 0xc6, 0xa6, 0xd7, 0x9a, 0x5f, 0x60, 0xce,
+	0x9c, 0x3a, 0x0a, 0xf3, 0x8c, 0x80, 0x74, 0xdd,
+	0x4f, 0x57, 0x8e, 0xca, 0xce, 0x6d, 0xd7, 0xc5,
+	0xff, 0x92, 0x13, 0xb8, 0x35, 0x34, 0x6a, 0x73
+};
+
+static const uint8_t SKN_1[32] = {
+	0x41, 0xc8, 0x6f, 0x89, 0x4c, 0x53, 0xa5, 0x46,
+	0xd0, 0xf8, 0xf7, 0xf3, 0x1b, 0xb4, 0xf9, 0x19,
+	0x68, 0xf5, 0x10, 0x2b, 0x6d, 0x8e, 0x74, 0x99,
+	0x4f, 0xca, 0x9e, 0x04, 0x27, 0x44, 0xbc, 0x3b
+};
+
+static const uint8_t x_P_1[28] = {
+	0x3a, 0xcd, 0x35, 0x31, 0x34, 0x74, 0xf5, 0xbc,
+	0x85, 0x17, 0x6e, 0x38, 0x52, 0x03, 0x30, 0x13,
+	0xe1, 0x4c, 0x88, 0xc8, 0x8c, 0xe7, 0x3d, 0xcb,
+	0xc9, 0xfb, 0x98, 0xf0
+};
+
+static const uint8_t LTK_1[16] = {
+	0x15, 0x36, 0x3e, 0xe2, 0x35, 0xec, 0x43, 0xac,
+	0x21, 0x80, 0xc3, 0x0f, 0xf6, 0xb5, 0x03, 0xce
+};
+
+static const uint8_t SKN_2[32] = {
+	0x2b, 0xaa, 0x45, 0x20, 0xb7, 0x86, 0x83, 0x36,
+	0x21, 0xa7, 0xf9, 0xe8, 0x06, 0xe0, 0xaf, 0x2e,
+	0xe6, 0x93, 0x70, 0xc3, 0x66, 0x01, 0x88, 0xc1,
+	0x15, 0x7e, 0x52, 0x03, 0x16, 0x1b, 0x40, 0x67
+};
+
+static const uint8_t x_P_2[28] = {
+	0x51, 0x2d, 0xf1, 0x20, 0xc4, 0xc6, 0x0b, 0xc2,
+	0xe2, 0x10, 0x0e, 0xbf, 0xc1, 0x87, 0x13, 0x89,
+	0xa4, 0x2b, 0x2d, 0x6e, 0xc3, 0xab, 0x14, 0xab,
+	0x16, 0xf4, 0xf9, 0x7c
+};
+
+static const uint8_t LTK_2[16] = {
+	0xeb, 0xcf, 0x5b, 0xd3, 0xed, 0x96, 0xa4, 0x4e,
+	0xb2, 0x36, 0x97, 0x2f, 0x29, 0x27, 0x99, 0x07
+};
+
+static struct fm_crypto_master_pk master_pk;
+
+static void lookahead_start(const uint8_t primary_sk[FMNA_SYMMETRIC_KEY_LEN],
+			    uint32_t primary_index)
+{
+	zassert_equal(fm_crypto_master_pk_import(&master_pk, P), 0, "");
+	zassert_equal(fmna_keys_lookahead_start(primary_sk, SKN_0, primary_index, &master_pk),
+		      0, "");
+}
+
+static void lookahead_stop(void)
+{
+	fmna_keys_lookahead_stop();
+	fm_crypto_master_pk_free(&master_pk);
+}
+
+/* The producer runs at the lowest priority, so let it fill the cache. */
+static int lookahead_wait(uint32_t primary_index, struct fmna_keys_lookahead_entry *entry)
+{
+	int err;
+	int64_t start = k_uptime_get();
+
+	do {
+		err = fmna_keys_lookahead_peek(primary_index, entry);
+		if (!err) {
+			return 0;
+		}
+
+		k_sleep(K_MSEC(10));
+	} while (k_uptime_get() - start < LOOKAHEAD_WAIT_TIMEOUT_MS);
+
+	return err;
+}
+
+static void entry_check(const struct fmna_keys_lookahead_entry *entry, uint32_t primary_index,
+			const uint8_t sk[32], const uint8_t x_p[28], const uint8_t ltk[16])
+{
+	zassert_equal(entry->primary_index, primary_index, "");
+	zassert_equal(memcmp(entry->primary_sk, sk, sizeof(entry->primary_sk)), 0, "");
+	zassert_equal(memcmp(entry->primary_pk, x_p, sizeof(entry->primary_pk)), 0, "");
+	zassert_equal(memcmp(entry->ltk, ltk, sizeof(entry->ltk)), 0, "");
+	zassert_false(entry->secondary_rolled, "");
+	zassert_equal(memcmp(entry->secondary_sk, SKN_0, sizeof(entry->secondary_sk)), 0, "");
+}
+
+ZTEST(suite_fmn_keys, test_lookahead_entries)
+{
+	struct fmna_keys_lookahead_entry entry;
+
+	lookahead_start(SKN_0, 0);
+
+	zassert_equal(lookahead_wait(1, &entry), 0, "Entry for index 1 is not ready");
+	zassert_equal(fmna_keys_lookahead_get(1, &entry), 0, "");
+	entry_check(&entry, 1, SKN_1, x_P_1, LTK_1);
+
+	zassert_equal(lookahead_wait(2, &entry), 0, "Entry for index 2 is not ready");
+	zassert_equal(fmna_keys_lookahead_get(2, &entry), 0, "");
+	entry_check(&entry, 2, SKN_2, x_P_2, LTK_2);
+
+	lookahead_stop();
+}
+
+ZTEST(suite_fmn_keys, test_lookahead_secondary_roll)
+{
+	uint8_t secondary_sk[FMNA_SYMMETRIC_KEY_LEN];
+	uint8_t secondary_pk[FMNA_PUBLIC_KEY_LEN];
+	struct fmna_keys_lookahead_entry entry;
+	const uint32_t index = FMNA_PRIMARY_KEYS_PER_SECONDARY_KEY;
+
+	zassert_equal(fm_crypto_roll_sk(SKN_0, secondary_sk), 0, "");
+	zassert_equal(fm_crypto_derive_primary_or_secondary_x(secondary_sk, P, secondary_pk),
+		      0, "");
+
+	/* The Secondary Key rolls at every multiple of the Secondary Key period. */
+	lookahead_start(SKN_0, index - 1);
+
+	zassert_equal(lookahead_wait(index, &entry), 0, "Entry for index %u is not ready",
+		      index);
+	zassert_equal(fmna_keys_lookahead_get(index, &entry), 0, "");
+	zassert_equal(memcmp(entry.primary_sk, SKN_1, sizeof(entry.primary_sk)), 0, "");
+	zassert_true(entry.secondary_rolled, "");
+	zassert_equal(memcmp(entry.secondary_sk, secondary_sk, sizeof(entry.secondary_sk)), 0, "");
+	zassert_equal(memcmp(entry.secondary_pk, secondary_pk, sizeof(entry.secondary_pk)), 0, "");
+
+	lookahead_stop();
+}
+
+ZTEST(suite_fmn_keys, test_lookahead_index_mismatch)
+{
+	struct fmna_keys_lookahead_entry entry;
+
+	lookahead_start(SKN_0, 0);
+	zassert_equal(lookahead_wait(1, &entry), 0, "Entry for index 1 is not ready");
+
+	/* The rotation skipped ahead of the cache. */
+	zassert_equal(fmna_keys_lookahead_get(3, &entry), -ENOENT, "");
+
+	/* The cache is dropped and stays empty until it is restarted. */
+	k_sleep(K_MSEC(100));
+	zassert_equal(fmna_keys_lookahead_peek(1, &entry), -ENOENT, "");
+	zassert_equal(fmna_keys_lookahead_get(1, &entry), -ENOENT, "");
+
+	lookahead_stop();
+
+	/* Restart from the state that the caller derived itself. */
+	lookahead_start(SKN_1, 1);
+
+	zassert_equal(lookahead_wait(2, &entry), 0, "Entry for index 2 is not ready");
+	zassert_equal(fmna_keys_lookahead_get(2, &entry), 0, "");
+	entry_check(&entry, 2, SKN_2, x_P_2, LTK_2);
+
+	lookahead_stop();
+}
+
+ZTEST(suite_fmn_keys, test_lookahead_stop)
+{
+	struct fmna_keys_lookahead_entry entry;
+
+	lookahead_start(SKN_0, 0);
+	zassert_equal(lookahead_wait(1, &entry), 0, "Entry for index 1 is not ready");
+
+	lookahead_stop();
+
+	zassert_equal(fmna_keys_lookahead_peek(1, &entry), -ENOENT, "");
+	zassert_equal(fmna_keys_lookahead_get(1, &entry), -ENOENT, "");
+}
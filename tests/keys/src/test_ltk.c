@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "fmna_keys_ltk.h"
+
+static struct fmna_keys_ltk_candidates candidates;
+
+/* LTK of the Primary Key index i, distinct for every index. */
+static void ltk_fill(uint8_t ltk[FMNA_KEYS_LTK_LEN], uint8_t i)
+{
+	memset(ltk, i + 1, FMNA_KEYS_LTK_LEN);
+}
+
+static void candidate_check(uint8_t candidate, uint8_t i)
+{
+	uint8_t expected[FMNA_KEYS_LTK_LEN];
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+
+	ltk_fill(expected, i);
+
+	zassert_equal(fmna_keys_ltk_candidate_get(&candidates, candidate, ltk), 0,
+		      "Candidate %u is missing", candidate);
+	zassert_equal(memcmp(ltk, expected, sizeof(ltk)), 0,
+		      "Candidate %u is not the LTK of index %u", candidate, i);
+}
+
+ZTEST(suite_fmn_keys, test_ltk_candidate_order)
+{
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	uint8_t candidate;
+
+	if (FMNA_KEYS_LTK_RING_SIZE < 2) {
+		ztest_test_skip();
+	}
+
+	fmna_keys_ltk_candidates_clear(&candidates);
+
+	/* Nothing to keep for the first index after the service start. */
+	ltk_fill(ltk, 0);
+	zassert_false(fmna_keys_ltk_current_update(&candidates, ltk), "");
+
+	ltk_fill(ltk, 1);
+	zassert_true(fmna_keys_ltk_current_update(&candidates, ltk), "");
+
+	/* The next LTK is derived after the switch to the new index. */
+	zassert_equal(fmna_keys_ltk_candidate_get(&candidates, FMNA_KEYS_LTK_CANDIDATE_NEXT,
+						  ltk), -ENOENT, "");
+	ltk_fill(ltk, 2);
+	fmna_keys_ltk_next_update(&candidates, ltk);
+
+	/* Current index, previous index, then the next index. The second ring slot
+	 * is still empty and is skipped.
+	 */
+	candidate = FMNA_KEYS_LTK_CANDIDATE_CURRENT;
+	zassert_equal(fmna_keys_ltk_candidate_find(&candidates, &candidate, ltk), 0, "");
+	zassert_equal(candidate, FMNA_KEYS_LTK_CANDIDATE_CURRENT, "");
+	candidate_check(candidate, 1);
+
+	candidate++;
+	zassert_equal(fmna_keys_ltk_candidate_find(&candidates, &candidate, ltk), 0, "");
+	zassert_equal(candidate, 1, "");
+	candidate_check(candidate, 0);
+
+	candidate++;
+	zassert_equal(fmna_keys_ltk_candidate_find(&candidates, &candidate, ltk), 0, "");
+	zassert_equal(candidate, FMNA_KEYS_LTK_CANDIDATE_NEXT, "");
+	candidate_check(candidate, 2);
+
+	candidate++;
+	zassert_equal(fmna_keys_ltk_candidate_find(&candidates, &candidate, ltk), -ENOENT, "");
+
+	/* A failed derivation of the next LTK leaves only the ring. */
+	fmna_keys_ltk_next_update(&candidates, NULL);
+	candidate = 2;
+	zassert_equal(fmna_keys_ltk_candidate_find(&candidates, &candidate, ltk), -ENOENT, "");
+}
+
+ZTEST(suite_fmn_keys, test_ltk_ring_wrap)
+{
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	const uint8_t last = 2 * FMNA_KEYS_LTK_RING_SIZE + 1;
+
+	if (FMNA_KEYS_LTK_RING_SIZE == 0) {
+		ztest_test_skip();
+	}
+
+	fmna_keys_ltk_candidates_clear(&candidates);
+
+	for (uint8_t i = 0; i <= last; i++) {
+		ltk_fill(ltk, i);
+		fmna_keys_ltk_current_update(&candidates, ltk);
+	}
+
+	/* The ring keeps the newest indices, the older ones are overwritten. */
+	candidate_check(FMNA_KEYS_LTK_CANDIDATE_CURRENT, last);
+	for (uint8_t candidate = 1; candidate <= FMNA_KEYS_LTK_RING_SIZE; candidate++) {
+		candidate_check(candidate, last - candidate);
+	}
+
+	zassert_equal(fmna_keys_ltk_candidate_get(&candidates, FMNA_KEYS_LTK_CANDIDATE_NEXT,
+						  ltk), -ENOENT, "");
+	zassert_equal(fmna_keys_ltk_candidate_get(&candidates, FMNA_KEYS_LTK_CANDIDATE_NEXT + 1,
+						  ltk), -ENOENT, "");
+}
+
+ZTEST(suite_fmn_keys, test_ltk_clear)
+{
+	uint8_t ltk[FMNA_KEYS_LTK_LEN];
+	const uint8_t zero[FMNA_KEYS_LTK_LEN] = { 0 };
+
+	fmna_keys_ltk_candidates_clear(&candidates);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		ltk_fill(ltk, i);
+		fmna_keys_ltk_current_update(&candidates, ltk);
+	}
+	fmna_keys_ltk_next_update(&candidates, ltk);
+
+	fmna_keys_ltk_candidates_clear(&candidates);
+
+	for (uint8_t candidate = 1; candidate <= FMNA_KEYS_LTK_CANDIDATE_NEXT; candidate++) {
+		zassert_equal(fmna_keys_ltk_candidate_get(&candidates, candidate, ltk), -ENOENT,
+			      "Candidate %u is still set", candidate);
+	}
+
+	zassert_equal(fmna_keys_ltk_candidate_get(&candidates, FMNA_KEYS_LTK_CANDIDATE_CURRENT,
+						  ltk), 0, "");
+	zassert_equal(memcmp(ltk, zero, sizeof(ltk)), 0, "");
+}
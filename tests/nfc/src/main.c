@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+#include <app_event_manager.h>
+
+static void *suite_fmn_nfc_setup(void)
+{
+	int err;
+
+	err = app_event_manager_init();
+	zassert_equal(err, 0, "app_event_manager_init returned error: %d", err);
+
+	return NULL;
+}
+
+ZTEST_SUITE(suite_fmn_nfc, NULL, suite_fmn_nfc_setup, NULL, NULL, NULL);
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+/* The NFC library is provided only for the nRF SoCs with the NFCT peripheral,
+ * so this test is built for one of them, for example nrf52840dk_nrf52840. The
+ * tag, the paired state and the stored serial number counter are emulated.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include <nfc_t2t_lib.h>
+
+#include "events/fmna_event.h"
+#include "fmna_nfc.h"
+#include "fmna_serial_number.h"
+
+#define WAIT_TIMEOUT_MS 5000
+
+static nfc_t2t_callback_t nfc_cb;
+static bool is_paired;
+
+static K_MUTEX_DEFINE(log_mutex);
+
+/* Serial number query counter as stored in the pairing data. */
+static uint64_t sn_counter;
+
+/* Counter values encrypted so far, by any thread. */
+static uint64_t enc_log[16];
+static size_t enc_cnt;
+
+/* Counter values exposed in the NDEF payloads, in order. */
+static uint64_t payload_log[16];
+static size_t payload_cnt;
+
+int __wrap_nfc_t2t_setup(nfc_t2t_callback_t callback, void *context)
+{
+	nfc_cb = callback;
+	return 0;
+}
+
+int __wrap_nfc_t2t_payload_set(const uint8_t *payload, size_t payload_length)
+{
+	static const char tag[] = "&e=";
+	uint8_t counter[sizeof(uint64_t)];
+	const char *enc;
+
+	/* The encrypted serial number is the only hex string after the tag. */
+	enc = strstr((const char *) payload, tag);
+	if (!enc) {
+		return 0;
+	}
+	enc += strlen(tag);
+
+	if (hex2bin(enc, 2 * sizeof(counter), counter, sizeof(counter)) != sizeof(counter)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&log_mutex, K_FOREVER);
+	if (payload_cnt < ARRAY_SIZE(payload_log)) {
+		payload_log[payload_cnt] = sys_get_le64(counter);
+	}
+	payload_cnt++;
+	k_mutex_unlock(&log_mutex);
+
+	return 0;
+}
+
+int __wrap_nfc_t2t_emulation_start(void)
+{
+	return 0;
+}
+
+int __wrap_nfc_t2t_emulation_stop(void)
+{
+	return 0;
+}
+
+int __wrap_nfc_t2t_done(void)
+{
+	return 0;
+}
+
+bool __wrap_fmna_state_is_paired(void)
+{
+	return is_paired;
+}
+
+int __wrap_fmna_serial_number_enc_counter_get(uint64_t *counter)
+{
+	k_mutex_lock(&log_mutex, K_FOREVER);
+	*counter = sn_counter;
+	k_mutex_unlock(&log_mutex);
+
+	return 0;
+}
+
+int __wrap_fmna_serial_number_enc_counter_increase(uint32_t increment)
+{
+	k_mutex_lock(&log_mutex, K_FOREVER);
+	sn_counter += increment;
+	k_mutex_unlock(&log_mutex);
+
+	FMNA_EVENT_CREATE(event, FMNA_EVENT_SERIAL_NUMBER_CNT_CHANGED, NULL);
+	APP_EVENT_SUBMIT(event);
+
+	return 0;
+}
+
+/* The payload starts with the counter, so that it can be found in the URL. */
+int __wrap_fmna_serial_number_enc_with_counter_get(
+	enum fmna_serial_number_enc_query_type query_type,
+	uint64_t counter,
+	uint8_t serial_number_enc[FMNA_SERIAL_NUMBER_ENC_BLEN])
+{
+	memset(serial_number_enc, 0xAA, FMNA_SERIAL_NUMBER_ENC_BLEN);
+	sys_put_le64(counter, serial_number_enc);
+
+	k_mutex_lock(&log_mutex, K_FOREVER);
+	if (enc_cnt < ARRAY_SIZE(enc_log)) {
+		enc_log[enc_cnt] = counter;
+	}
+	enc_cnt++;
+	k_mutex_unlock(&log_mutex);
+
+	return 0;
+}
+
+static size_t enc_counter_cnt(uint64_t counter)
+{
+	size_t cnt = 0;
+
+	k_mutex_lock(&log_mutex, K_FOREVER);
+	for (size_t i = 0; i < MIN(enc_cnt, ARRAY_SIZE(enc_log)); i++) {
+		if (enc_log[i] == counter) {
+			cnt++;
+		}
+	}
+	k_mutex_unlock(&log_mutex);
+
+	return cnt;
+}
+
+/* The prefetch thread runs at the lowest priority, so let it encrypt. */
+static bool enc_wait(uint64_t counter)
+{
+	int64_t start = k_uptime_get();
+
+	do {
+		if (enc_counter_cnt(counter) > 0) {
+			return true;
+		}
+
+		k_sleep(K_MSEC(10));
+	} while (k_uptime_get() - start < WAIT_TIMEOUT_MS);
+
+	return false;
+}
+
+static bool payload_wait(size_t cnt)
+{
+	int64_t start = k_uptime_get();
+
+	do {
+		if (payload_cnt >= cnt) {
+			return true;
+		}
+
+		k_sleep(K_MSEC(10));
+	} while (k_uptime_get() - start < WAIT_TIMEOUT_MS);
+
+	return false;
+}
+
+static void payload_check(size_t i, uint64_t counter)
+{
+	zassert_true(payload_wait(i + 1), "NDEF payload %zu was not set", i);
+	zassert_equal(payload_log[i], counter, "NDEF payload %zu exposes counter %llu",
+		      i, payload_log[i]);
+}
+
+static void nfc_tap(void)
+{
+	nfc_cb(NULL, NFC_T2T_EVENT_DATA_READ, NULL, 0);
+}
+
+ZTEST(suite_fmn_nfc, test_sn_prefetch_monotonic)
+{
+	sn_counter = 10;
+	is_paired = true;
+
+	zassert_equal(fmna_nfc_init(0), 0, "");
+	zassert_not_null(nfc_cb, "");
+
+	/* The first payload is encrypted inline, the next one in the background. */
+	payload_check(0, 10);
+	zassert_true(enc_wait(11), "Counter 11 was not prefetched");
+
+	/* The tap increases the counter and exposes the prefetched payload. */
+	nfc_tap();
+	payload_check(1, 11);
+	zassert_equal(enc_counter_cnt(11), 1, "Counter 11 was encrypted again");
+	zassert_true(enc_wait(12), "Counter 12 was not prefetched");
+
+	/* The counter moves past the prefetched value, for example after the
+	 * serial number is read over Bluetooth. The stale payload is not used.
+	 */
+	zassert_equal(fmna_serial_number_enc_counter_increase(5), 0, "");
+	payload_check(2, 15);
+	zassert_equal(enc_counter_cnt(15), 1, "");
+	zassert_true(enc_wait(16), "Counter 16 was not prefetched");
+
+	nfc_tap();
+	payload_check(3, 16);
+
+	for (size_t i = 1; i < MIN(payload_cnt, ARRAY_SIZE(payload_log)); i++) {
+		zassert_true(payload_log[i] > payload_log[i - 1],
+			     "Counter went back in NDEF payload %zu", i);
+	}
+
+	zassert_equal(fmna_nfc_uninit(), 0, "");
+}
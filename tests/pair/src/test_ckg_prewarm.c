@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-4-Clause
+ */
+
+#include <zephyr/ztest.h>
+
+#include "crypto/fm_crypto.h"
+#include "fmna_pair.h"
+
+#define CKG_WAIT_TIMEOUT K_SECONDS(5)
+#define CKG_SETTLE_TIME K_MSEC(100)
+
+static K_SEM_DEFINE(ckg_init_entered_sem, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(ckg_init_gate_sem, 0, 1);
+
+static atomic_t ckg_init_cnt;
+static bool ckg_init_gated;
+
+/* The context content does not matter, only when it is generated. */
+int __wrap_fm_crypto_ckg_init(fm_crypto_ckg_context_t ctx)
+{
+	memset(ctx, 0, sizeof(*ctx));
+
+	atomic_inc(&ckg_init_cnt);
+	k_sem_give(&ckg_init_entered_sem);
+
+	if (ckg_init_gated) {
+		k_sem_take(&ckg_init_gate_sem, K_FOREVER);
+	}
+
+	return 0;
+}
+
+static void ckg_reset(void)
+{
+	fmna_pair_ckg_discard();
+
+	/* Let the prewarm thread finish the work of the previous test. */
+	k_sleep(CKG_SETTLE_TIME);
+
+	ckg_init_gated = false;
+	atomic_clear(&ckg_init_cnt);
+	k_sem_reset(&ckg_init_entered_sem);
+	k_sem_reset(&ckg_init_gate_sem);
+}
+
+ZTEST(suite_fmn_pair, test_ckg_prewarm_reuse)
+{
+	ckg_reset();
+
+	fmna_pair_ckg_prewarm();
+	zassert_equal(k_sem_take(&ckg_init_entered_sem, CKG_WAIT_TIMEOUT), 0,
+		      "CKG context was not generated");
+	k_sleep(CKG_SETTLE_TIME);
+
+	/* The ready context is kept until it is used or discarded. */
+	fmna_pair_ckg_prewarm();
+	k_sleep(CKG_SETTLE_TIME);
+	zassert_equal(atomic_get(&ckg_init_cnt), 1, "Ready CKG context was generated again");
+
+	fmna_pair_ckg_discard();
+	fmna_pair_ckg_prewarm();
+	zassert_equal(k_sem_take(&ckg_init_entered_sem, CKG_WAIT_TIMEOUT), 0,
+		      "Discarded CKG context was not generated again");
+	zassert_equal(atomic_get(&ckg_init_cnt), 2, "");
+
+	fmna_pair_ckg_discard();
+}
+
+ZTEST(suite_fmn_pair, test_ckg_prewarm_discard_in_flight)
+{
+	ckg_reset();
+
+	ckg_init_gated = true;
+
+	fmna_pair_ckg_prewarm();
+	zassert_equal(k_sem_take(&ckg_init_entered_sem, CKG_WAIT_TIMEOUT), 0,
+		      "CKG context generation did not start");
+
+	/* The pairing mode ends and starts again while the context is generated.
+	 * The context of the previous pairing mode must not be stored.
+	 */
+	fmna_pair_ckg_discard();
+	fmna_pair_ckg_prewarm();
+
+	ckg_init_gated = false;
+	k_sem_give(&ckg_init_gate_sem);
+
+	zassert_equal(k_sem_take(&ckg_init_entered_sem, CKG_WAIT_TIMEOUT), 0,
+		      "Stale CKG context was stored instead of a new one");
+	zassert_equal(atomic_get(&ckg_init_cnt), 2, "");
+
+	/* The new context is stored and kept. */
+	k_sleep(CKG_SETTLE_TIME);
+	fmna_pair_ckg_prewarm();
+	k_sleep(CKG_SETTLE_TIME);
+	zassert_equal(atomic_get(&ckg_init_cnt), 2, "");
+
+	fmna_pair_ckg_discard();
+}
+
+ZTEST(suite_fmn_pair, test_ckg_prewarm_discard_idle)
+{
+	ckg_reset();
+
+	/* Without a request the thread does not generate anything. */
+	fmna_pair_ckg_prewarm();
+	fmna_pair_ckg_discard();
+	k_sleep(CKG_SETTLE_TIME);
+	zassert_equal(atomic_get(&ckg_init_cnt), 0, "Discarded request was served");
+}